@@ -0,0 +1,32 @@
+# QBENCHMARK suite for the conversion and formatting hot paths.
+# Run: latlon_bench [-json <file>] [QTest options]
+
+QT += widgets testlib
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = latlon_bench
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/.. $$PWD/../latloncore
+DEPENDPATH += $$PWD/.. $$PWD/../latloncore
+LIBS += -L$$OUT_PWD/../latloncore -llatloncore
+PRE_TARGETDEPS += $$OUT_PWD/../latloncore/$${QMAKE_PREFIX_STATICLIB}latloncore.$${QMAKE_EXTENSION_STATICLIB}
+
+HEADERS += \
+    ../latlonitemdelegate.h \
+    ../latlonprofiler.h \
+    ../latlonwidget.h \
+    ../latlonwidget_p.h \
+    ../latlonwidgetpool.h \
+    ../nmeapositionsource.h \
+    ../positionmodel.h
+
+SOURCES += \
+    ../latlonitemdelegate.cpp \
+    ../latlonprofiler.cpp \
+    ../latlonwidget.cpp \
+    ../latlonwidgetpool.cpp \
+    ../nmeapositionsource.cpp \
+    ../positionmodel.cpp \
+    latlonbench.cpp
@@ -0,0 +1,1840 @@
+#include <QtTest>
+#include <QAbstractTableModel>
+#include <QApplication>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QPixmap>
+#include <QTableView>
+#include <QTemporaryFile>
+#include <QVBoxLayout>
+#include <QXmlStreamReader>
+
+#include "datum.h"
+#include "floattype.h"
+#include "geodesic.h"
+#include "latlonformat.h"
+#include "latlonitemdelegate.h"
+#include "latlonparser.h"
+#include "latlonprofiler.h"
+#include "latlonwidget.h"
+#include "latlonwidgetpool.h"
+#include "nmeaparser.h"
+#include "nmeapositionsource.h"
+#include "positionarray.h"
+#include "positionindex.h"
+#include "positionmodel.h"
+#include "positionslot.h"
+#include "utm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Points per dataset; every benchmark iteration walks the whole dataset.
+const int kDatasetSize = 1024;
+
+struct Position
+{
+    double latitude;
+    double longitude;
+};
+
+///
+/// \brief Fixed, seeded input positions for one region.
+///
+struct Dataset
+{
+    const char *name;
+    double minLat, maxLat;
+    double minLon, maxLon;
+    unsigned seed;
+};
+
+// Regions where the conversions take special paths
+const Dataset kDatasets[] = {
+    { "global",       -80.0,  84.0, -180.0, 180.0, 1u },
+    { "poles",        -90.0, -80.0, -180.0, 180.0, 2u },    // south of the UTM limit
+    { "north-pole",    84.0,  90.0, -180.0, 180.0, 3u },    // north of the UTM limit
+    { "norway",        56.0,  64.0,    3.0,  12.0, 4u },    // zone 32V exception
+    { "svalbard",      72.0,  84.0,    0.0,  42.0, 5u },    // zones 31X-37X
+    { "antimeridian", -80.0,  84.0,  179.0, 180.0, 6u },    // both sides of +-180
+};
+
+std::vector<Position> makePositions(const Dataset &d)
+{
+    std::mt19937 gen(d.seed);
+    std::uniform_real_distribution<double> lat(d.minLat, d.maxLat);
+    std::uniform_real_distribution<double> lon(d.minLon, d.maxLon);
+
+    std::vector<Position> positions(kDatasetSize);
+    for( int i = 0; i < kDatasetSize; ++i ) {
+        positions[i].latitude = lat(gen);
+        positions[i].longitude = lon(gen);
+        // antimeridian points alternate between east and west
+        if( d.minLon == 179.0 && (i & 1) )
+            positions[i].longitude -= 360.0;
+    }
+    // the exact corners of the region
+    positions[0] = { d.minLat, d.minLon };
+    positions[1] = { d.maxLat, d.maxLon };
+    return positions;
+}
+
+struct UTMPositions
+{
+    std::vector<double> northing, easting;
+    std::vector<int> zoneNumber;
+    std::vector<char> zoneLetter;
+    std::vector<QByteArray> zone;
+};
+
+UTMPositions toUTM(const std::vector<Position> &positions)
+{
+    UTMPositions utm;
+    for( const Position &p : positions ) {
+        double northing, easting;
+        UTM::UtmZone zone;
+        UTM::LLtoUTM(p.latitude, p.longitude, northing, easting, zone);
+        char text[4];
+        utm.northing.push_back(northing);
+        utm.easting.push_back(easting);
+        utm.zone.push_back(QByteArray(text, int(UTM::FormatUTMZone(text, zone) - text)));
+        utm.zoneNumber.push_back(zone.number);
+        utm.zoneLetter.push_back(zone.band);
+    }
+    return utm;
+}
+
+// Accuracy figures gathered while benchmarking, written next to the timings
+QJsonArray accuracyResults;
+
+// Heap use per widget, by display mode, and allocations per formatted text
+QJsonArray memoryResults;
+
+// Bytes allocated on the heap and not yet freed, 0 where unknown
+std::size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// Points per iteration of the benchmarks that do not walk one dataset,
+// by "function/tag"
+QHash<QString, int> pointsPerIteration;
+
+void setPointsPerIteration(int points)
+{
+    pointsPerIteration.insert(QString::fromLatin1(QTest::currentTestFunction()) + QLatin1Char('/')
+                              + QString::fromLatin1(QTest::currentDataTag()), points);
+}
+
+///
+/// \brief Uniformly distributed positions for the spatial index, shared
+/// between the rows of one size.
+///
+struct IndexData
+{
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    PositionIndex index;
+};
+
+const IndexData &indexData(int count)
+{
+    static std::map<int, IndexData> cache;
+    auto it = cache.find(count);
+    if( it != cache.end() )
+        return it->second;
+
+    IndexData &d = cache[count];
+    std::mt19937 gen(8u);
+    std::uniform_real_distribution<double> lat(-90.0, 90.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    d.latitude.resize(std::size_t(count));
+    d.longitude.resize(std::size_t(count));
+    for( int i = 0; i < count; ++i ) {
+        d.latitude[i] = lat(gen);
+        d.longitude[i] = lon(gen);
+    }
+    d.index.build(d.latitude.data(), d.longitude.data(), d.latitude.size());
+    return d;
+}
+
+// Rows of the item view benchmarks
+const int kTableRows = 100000;
+
+///
+/// \brief Read-only table of positions, latitude and longitude under
+/// Qt::UserRole and Qt::UserRole + 1 as LatLonItemDelegate expects.
+///
+class PositionTableModel : public QAbstractTableModel
+{
+public:
+    explicit PositionTableModel(std::vector<Position> positions) :
+        m_positions(std::move(positions))
+    {
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(m_positions.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : 2;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        const Position &p = m_positions[std::size_t(index.row())];
+        if( role == Qt::UserRole )
+            return p.latitude;
+        if( role == Qt::UserRole + 1 )
+            return p.longitude;
+        return QVariant();
+    }
+
+private:
+    std::vector<Position> m_positions;
+};
+
+// Epochs of the NMEA stream benchmarks, 10 Hz
+const int kNmeaEpochMs = 100;
+
+///
+/// \brief A GGA and an RMC sentence per position of the global dataset,
+/// as a receiver sends them at 10 Hz.
+///
+QByteArray makeNmea()
+{
+    QByteArray nmea;
+    char body[NmeaParser::kMaxSentenceLength + 16];
+    char sentence[NmeaParser::kMaxSentenceLength + 16];
+    int timeMs = 0;
+
+    auto append = [&]() {
+        const int n = std::snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n",
+                                    body, unsigned(NmeaParser::checksum(body)));
+        nmea.append(sentence, n);
+    };
+
+    for( const Position &p : makePositions(kDatasets[0]) ) {
+        const double lat = std::fabs(p.latitude);
+        const double lon = std::fabs(p.longitude);
+        const char ns = p.latitude < 0 ? 'S' : 'N';
+        const char ew = p.longitude < 0 ? 'W' : 'E';
+        const int hours = timeMs / 3600000, minutes = timeMs / 60000 % 60;
+        const int seconds = timeMs / 1000 % 60, centiseconds = timeMs % 1000 / 10;
+
+        std::snprintf(body, sizeof(body), "GPGGA,%02d%02d%02d.%02d,%02d%010.7f,%c,%03d%010.7f,%c,1,08,0.9,545.4,M,46.9,M,,",
+                      hours, minutes, seconds, centiseconds, int(lat), (lat - int(lat)) * 60, ns,
+                      int(lon), (lon - int(lon)) * 60, ew);
+        append();
+        std::snprintf(body, sizeof(body), "GPRMC,%02d%02d%02d.%02d,A,%02d%010.7f,%c,%03d%010.7f,%c,022.4,084.4,230394,003.1,W",
+                      hours, minutes, seconds, centiseconds, int(lat), (lat - int(lat)) * 60, ns,
+                      int(lon), (lon - int(lon)) * 60, ew);
+        append();
+        timeMs += kNmeaEpochMs;
+    }
+    return nmea;
+}
+
+std::vector<Position> makeTablePositions()
+{
+    // the global dataset, repeated
+    const std::vector<Position> positions = makePositions(kDatasets[0]);
+    std::vector<Position> rows(kTableRows);
+    for( int i = 0; i < kTableRows; ++i )
+        rows[std::size_t(i)] = positions[std::size_t(i % kDatasetSize)];
+    return rows;
+}
+
+} // namespace
+
+///
+/// \brief Benchmarks for the conversion and formatting hot paths.
+///
+class LatLonBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void llToUtm_data() { addDatasetRows(); }
+    void llToUtm();
+    void llToUtmBatch_data() { addDatasetRows(); }
+    void llToUtmBatch();
+    void utmToLl_data() { addDatasetRows(); }
+    void utmToLl();
+    void utmToLlBatch_data() { addDatasetRows(); }
+    void utmToLlBatch();
+    void letterDesignator_data() { addDatasetRows(); }
+    void letterDesignator();
+    void zoneOf_data() { addDatasetRows(); }
+    void zoneOf();
+    void engine_data();
+    void engine();
+    void engineTable_data();
+    void engineTable();
+
+    void floatSetValueDouble_data() { addDatasetRows(); }
+    void floatSetValueDouble();
+    void floatSetValueInt_data() { addDatasetRows(); }
+    void floatSetValueInt();
+
+    void format_data();
+    void format();
+    void formatText_data() { format_data(); }
+    void formatText();
+    void formatUTM_data() { addDatasetRows(); }
+    void formatUTM();
+    void parse_data();
+    void parse();
+    void setPosition_data();
+    void setPosition();
+    void setPositionProfiled_data();
+    void setPositionProfiled();
+    void coalescedFlood_data();
+    void coalescedFlood();
+    void broadcast_data();
+    void broadcast();
+
+    void displayUpdate_data();
+    void displayUpdate();
+    void displayMemory_data();
+    void displayMemory();
+
+    void formStartup_data();
+    void formStartup();
+
+    void delegateText_data() { addFormatRows(); }
+    void delegateText();
+    void delegatePaint_data() { addFormatRows(); }
+    void delegatePaint();
+
+    void indexEncode_data() { addIndexSizeRows(); }
+    void indexEncode();
+    void indexBuild_data() { addIndexSizeRows(); }
+    void indexBuild();
+    void indexNearest_data();
+    void indexNearest();
+    void indexRadius_data() { addIndexSizeRows(); }
+    void indexRadius();
+    void linearNearest_data() { addIndexSizeRows(); }
+    void linearNearest();
+
+    void arrayAppend_data() { addIndexSizeRows(); }
+    void arrayAppend();
+    void arrayValidate_data() { addIndexSizeRows(); }
+    void arrayValidate();
+    void floatValidate_data() { addIndexSizeRows(); }
+    void floatValidate();
+
+    void nmeaParse();
+    void nmeaStream_data();
+    void nmeaStream();
+    void slotStress_data();
+    void slotStress();
+
+    void geodesicScalar_data();
+    void geodesicScalar();
+    void geodesicBatch_data();
+    void geodesicBatch();
+    void geodesicMatrix_data();
+    void geodesicMatrix();
+
+    void datumTransform_data();
+    void datumTransform();
+    void datumTyping_data();
+    void datumTyping();
+
+private:
+    void addDatasetRows();
+    void addIndexSizeRows();
+    void addFormatRows();
+};
+
+void LatLonBench::addDatasetRows()
+{
+    QTest::addColumn<int>("dataset");
+    for( int i = 0; i < int(sizeof(kDatasets) / sizeof(kDatasets[0])); ++i )
+        QTest::newRow(kDatasets[i].name) << i;
+}
+
+void LatLonBench::addIndexSizeRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1M") << 1000000;
+    QTest::newRow("10M") << 10000000;
+}
+
+void LatLonBench::addFormatRows()
+{
+    QTest::addColumn<int>("posFormat");
+    QTest::newRow("dd") << int(LatLonWidget::eDECIMAL_DEG);
+    QTest::newRow("dms") << int(LatLonWidget::eDMS);
+    QTest::newRow("utm") << int(LatLonWidget::eUTM);
+}
+
+void LatLonBench::llToUtm()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    double northing, easting;
+    char zone[5];
+
+    QBENCHMARK {
+        for( const Position &p : positions )
+            UTM::LLtoUTM(p.latitude, p.longitude, northing, easting, zone);
+    }
+}
+
+void LatLonBench::llToUtmBatch()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    std::vector<double> lat, lon;
+    for( const Position &p : positions ) {
+        lat.push_back(p.latitude);
+        lon.push_back(p.longitude);
+    }
+    std::vector<double> northing(lat.size()), easting(lat.size());
+    std::vector<int> zoneNumber(lat.size());
+    std::vector<char> zoneLetter(lat.size());
+
+    QBENCHMARK {
+        UTM::LLtoUTM(lat.data(), lon.data(), lat.size(), northing.data(), easting.data(),
+                     zoneNumber.data(), zoneLetter.data());
+    }
+}
+
+void LatLonBench::utmToLl()
+{
+    QFETCH(int, dataset);
+    const UTMPositions utm = toUTM(makePositions(kDatasets[dataset]));
+    double lat, lon;
+
+    QBENCHMARK {
+        for( size_t i = 0; i < utm.zone.size(); ++i )
+            UTM::UTMtoLL(utm.northing[i], utm.easting[i], utm.zone[i].constData(), lat, lon);
+    }
+}
+
+void LatLonBench::utmToLlBatch()
+{
+    QFETCH(int, dataset);
+    const UTMPositions utm = toUTM(makePositions(kDatasets[dataset]));
+    std::vector<double> lat(utm.northing.size()), lon(utm.northing.size());
+
+    QBENCHMARK {
+        UTM::UTMtoLL(utm.northing.data(), utm.easting.data(), utm.zoneNumber.data(),
+                     utm.zoneLetter.data(), lat.size(), lat.data(), lon.data());
+    }
+}
+
+void LatLonBench::letterDesignator()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    volatile char letter = 0;
+
+    QBENCHMARK {
+        for( const Position &p : positions )
+            letter = UTM::UTMLetterDesignator(p.latitude);
+    }
+    Q_UNUSED(letter);
+}
+
+void LatLonBench::zoneOf()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    volatile uint8_t number = 0;
+
+    QBENCHMARK {
+        for( const Position &p : positions )
+            number = UTM::UTMZoneOf(p.latitude, p.longitude).number;
+    }
+    Q_UNUSED(number);
+}
+
+void LatLonBench::engine_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::addColumn<double>("halfWidth");
+
+    // the standard zone, the widest exception zone (Svalbard 33X/35X) and
+    // the 3900 km the Krueger series is specified for at the equator
+    const double widths[] = { 3.0, 6.0, 35.0 };
+    for( double w : widths ) {
+        QTest::newRow(QByteArray("fast/") + QByteArray::number(w)) << int(UTM::ENGINE_FAST) << w;
+        QTest::newRow(QByteArray("precise/") + QByteArray::number(w)) << int(UTM::ENGINE_PRECISE) << w;
+    }
+}
+
+///
+/// Forward plus reverse projection relative to the central meridian, for
+/// positions spread over +-halfWidth degrees of longitude.
+///
+/// The maximum error is recorded in the JSON results: forwardError is the
+/// distance to the precise engine's northing/easting (0 for the precise
+/// engine itself), roundTripError is how far the reverse projection lands
+/// from the input, both in metres.
+///
+void LatLonBench::engine()
+{
+    QFETCH(int, engine);
+    QFETCH(double, halfWidth);
+
+    typedef UTM::TransverseMercator<UTM::WGS84> Fast;
+    typedef UTM::KrugerTransverseMercator<UTM::WGS84> Precise;
+
+    std::mt19937 gen(7u);
+    std::uniform_real_distribution<double> lat(-80.0, 84.0);
+    std::uniform_real_distribution<double> lon(-halfWidth, halfWidth);
+    std::vector<Position> positions(kDatasetSize);
+    for( Position &p : positions ) {
+        p.latitude = lat(gen);
+        p.longitude = lon(gen);
+    }
+
+    // 1 degree of latitude is about 111 km, good enough to express the
+    // round trip error in metres
+    const double metresPerDegree = 111320.0;
+    double forwardError = 0, roundTripError = 0;
+    for( const Position &p : positions ) {
+        double x, y, xRef, yRef, la, lo;
+        Precise::Forward(p.latitude, p.longitude, xRef, yRef);
+        if( engine == UTM::ENGINE_PRECISE ) {
+            x = xRef;
+            y = yRef;
+            Precise::Reverse(x, y, la, lo);
+        } else {
+            Fast::Forward(p.latitude, p.longitude, x, y);
+            Fast::Reverse(x, y, la, lo);
+        }
+        forwardError = std::max(forwardError, std::hypot(x - xRef, y - yRef));
+        roundTripError = std::max(roundTripError,
+                                  std::hypot(la - p.latitude,
+                                             (lo - p.longitude) * std::cos(p.latitude * DEG_TO_RAD))
+                                  * metresPerDegree);
+    }
+
+    double x, y, la, lo;
+    QBENCHMARK {
+        for( const Position &p : positions ) {
+            if( engine == UTM::ENGINE_PRECISE ) {
+                Precise::Forward(p.latitude, p.longitude, x, y);
+                Precise::Reverse(x, y, la, lo);
+            } else {
+                Fast::Forward(p.latitude, p.longitude, x, y);
+                Fast::Reverse(x, y, la, lo);
+            }
+        }
+    }
+
+    qInfo("%s: max forward error %.3g m, max round trip error %.3g m",
+          QTest::currentDataTag(), forwardError, roundTripError);
+    QJsonObject r;
+    r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+    r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+    r.insert(QStringLiteral("forwardError"), forwardError);
+    r.insert(QStringLiteral("roundTripError"), roundTripError);
+    accuracyResults.append(r);
+}
+
+void LatLonBench::engineTable_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::addColumn<bool>("batch");
+
+    QTest::newRow("series/single") << int(UTM::ENGINE_FAST) << false;
+    QTest::newRow("table/single") << int(UTM::ENGINE_TABLE) << false;
+    QTest::newRow("series/batch") << int(UTM::ENGINE_FAST) << true;
+    QTest::newRow("table/batch") << int(UTM::ENGINE_TABLE) << true;
+}
+
+///
+/// LLtoUTM() plus UTMtoLL() with the Bulletin 1532 series evaluated
+/// directly or from the lookup tables of ENGINE_TABLE, one point at a time
+/// or through the batch kernels, over the whole UTM latitude range.
+///
+/// The table rows record the maximum distance to the direct series in the
+/// JSON results (tableError for northing/easting, tableRoundTripError for
+/// the reverse projection), in millimetres.
+///
+void LatLonBench::engineTable()
+{
+    QFETCH(int, engine);
+    QFETCH(bool, batch);
+    const UTM::Engine utmEngine = UTM::Engine(engine);
+
+    std::mt19937 gen(11u);
+    std::uniform_real_distribution<double> latDist(-80.0, 84.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+    // enough points to hit every table interval many times over
+    const std::size_t count = 65536;
+    std::vector<double> lat(count), lon(count);
+    for( std::size_t i = 0; i < count; ++i ) {
+        lat[i] = latDist(gen);
+        lon[i] = lonDist(gen);
+    }
+    std::vector<double> northing(count), easting(count), la(count), lo(count);
+    std::vector<int> zoneNumber(count);
+    std::vector<char> zoneLetter(count);
+
+    if( utmEngine == UTM::ENGINE_TABLE ) {
+        const double metresPerDegree = 111320.0;
+        double tableError = 0, tableRoundTripError = 0;
+        for( std::size_t i = 0; i < count; ++i ) {
+            double n, e, nRef, eRef, la1, lo1, laRef, loRef;
+            UTM::UtmZone zone;
+            UTM::LLtoUTM(lat[i], lon[i], nRef, eRef, zone, UTM::ENGINE_FAST);
+            UTM::LLtoUTM(lat[i], lon[i], n, e, zone, UTM::ENGINE_TABLE);
+            UTM::UTMtoLL(nRef, eRef, zone, laRef, loRef, UTM::ENGINE_FAST);
+            UTM::UTMtoLL(nRef, eRef, zone, la1, lo1, UTM::ENGINE_TABLE);
+            tableError = std::max(tableError, std::hypot(n - nRef, e - eRef));
+            tableRoundTripError = std::max(tableRoundTripError,
+                                           std::hypot(la1 - laRef,
+                                                      (lo1 - loRef) * std::cos(laRef * DEG_TO_RAD))
+                                           * metresPerDegree);
+        }
+
+        qInfo("%s: max deviation from the series %.3g mm, reverse %.3g mm",
+              QTest::currentDataTag(), tableError * 1000.0, tableRoundTripError * 1000.0);
+        QJsonObject r;
+        r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+        r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+        r.insert(QStringLiteral("tableError"), tableError * 1000.0);
+        r.insert(QStringLiteral("tableRoundTripError"), tableRoundTripError * 1000.0);
+        accuracyResults.append(r);
+    }
+
+    QBENCHMARK {
+        if( batch ) {
+            UTM::LLtoUTM(lat.data(), lon.data(), count, northing.data(), easting.data(),
+                         zoneNumber.data(), zoneLetter.data(), utmEngine);
+            UTM::UTMtoLL(northing.data(), easting.data(), zoneNumber.data(), zoneLetter.data(),
+                         count, la.data(), lo.data(), utmEngine);
+        } else {
+            for( std::size_t i = 0; i < count; ++i ) {
+                UTM::UtmZone zone;
+                UTM::LLtoUTM(lat[i], lon[i], northing[i], easting[i], zone, utmEngine);
+                UTM::UTMtoLL(northing[i], easting[i], zone, la[i], lo[i], utmEngine);
+            }
+        }
+    }
+}
+
+void LatLonBench::floatSetValueDouble()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    FloatType value(0, 0);
+
+    QBENCHMARK {
+        for( const Position &p : positions ) {
+            value.setValue(p.latitude);
+            value.setValue(p.longitude);
+        }
+    }
+}
+
+void LatLonBench::floatSetValueInt()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    std::vector<FloatType> split;
+    for( const Position &p : positions )
+        split.push_back(FloatType(p.latitude));
+    FloatType value(0, 0);
+
+    QBENCHMARK {
+        for( const FloatType &f : split ) {
+            int32_t whole, fraction;
+            f.getValue(whole, fraction);
+            value.setValue(whole, fraction);
+        }
+    }
+}
+
+void LatLonBench::format_data()
+{
+    QTest::addColumn<int>("dataset");
+    QTest::addColumn<int>("posFormat");
+    QTest::addColumn<int>("notation");
+
+    const struct {
+        const char *name;
+        LatLonWidget::PositionFormatType posFormat;
+        LatLonWidget::NotationType notation;
+    } combinations[] = {
+        { "dd-sign",       LatLonWidget::eDECIMAL_DEG, LatLonWidget::NotationType::eSIGN },
+        { "dd-direction",  LatLonWidget::eDECIMAL_DEG, LatLonWidget::NotationType::eDIRECTION },
+        { "dms-sign",      LatLonWidget::eDMS,         LatLonWidget::NotationType::eSIGN },
+        { "dms-direction", LatLonWidget::eDMS,         LatLonWidget::NotationType::eDIRECTION },
+    };
+
+    for( int i = 0; i < int(sizeof(kDatasets) / sizeof(kDatasets[0])); ++i ) {
+        for( const auto &c : combinations ) {
+            QTest::newRow(QByteArray(kDatasets[i].name) + '/' + c.name)
+                    << i << int(c.posFormat) << int(c.notation);
+        }
+    }
+}
+
+void LatLonBench::format()
+{
+    QFETCH(int, dataset);
+    QFETCH(int, posFormat);
+    QFETCH(int, notation);
+
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    std::vector<FloatType> lat, lon;
+    for( const Position &p : positions ) {
+        lat.push_back(FloatType(p.latitude));
+        lon.push_back(FloatType(p.longitude));
+    }
+
+    LatLonWidget w;
+    w.setNotation(static_cast<LatLonWidget::NotationType>(notation));
+    const auto f = static_cast<LatLonWidget::PositionFormatType>(posFormat);
+
+    QBENCHMARK {
+        for( size_t i = 0; i < lat.size(); ++i ) {
+            w.format(f, LatLonWidget::eLATITUDE, &lat[i]);
+            w.format(f, LatLonWidget::eLONGITUDE, &lon[i]);
+        }
+    }
+}
+
+///
+/// The formatter behind format(), without the QString: UTF-16 straight into
+/// a stack buffer. Also counts the allocations of both per call, when the
+/// build counts them (LATLONWIDGET_COUNT_ALLOCATIONS).
+///
+void LatLonBench::formatText()
+{
+    QFETCH(int, dataset);
+    QFETCH(int, posFormat);
+    QFETCH(int, notation);
+
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+    std::vector<FloatType> lat, lon;
+    for( const Position &p : positions ) {
+        lat.push_back(FloatType(p.latitude));
+        lon.push_back(FloatType(p.longitude));
+    }
+
+    const auto f = static_cast<LatLonFormat::PositionFormatType>(posFormat);
+    const auto n = static_cast<LatLonFormat::NotationType>(notation);
+    char16_t text[LatLonFormat::kMaxTextSize];
+    std::size_t length = 0;
+
+    QBENCHMARK {
+        for( size_t i = 0; i < lat.size(); ++i ) {
+            length += std::size_t(LatLonFormat::format(text, f, LatLonFormat::eLATITUDE, n, lat[i]) - text);
+            length += std::size_t(LatLonFormat::format(text, f, LatLonFormat::eLONGITUDE, n, lon[i]) - text);
+        }
+    }
+    QVERIFY(length > 0);
+
+    if( !LatLonProfiler::countsAllocations() )
+        return;
+
+    const uint64_t before = LatLonProfiler::threadAllocations();
+    for( size_t i = 0; i < lat.size(); ++i )
+        LatLonFormat::format(text, f, LatLonFormat::eLATITUDE, n, lat[i]);
+    const uint64_t textAllocations = LatLonProfiler::threadAllocations() - before;
+
+    LatLonWidget w;
+    w.setNotation(static_cast<LatLonWidget::NotationType>(notation));
+    const uint64_t widgetBefore = LatLonProfiler::threadAllocations();
+    for( size_t i = 0; i < lat.size(); ++i )
+        w.format(static_cast<LatLonWidget::PositionFormatType>(posFormat), LatLonWidget::eLATITUDE, &lat[i]);
+    const uint64_t widgetAllocations = LatLonProfiler::threadAllocations() - widgetBefore;
+
+    const double perCall = double(widgetAllocations) / double(lat.size());
+    qInfo("%s: %llu allocations in %d formatter calls, %.2f per LatLonWidget::format()",
+          QTest::currentDataTag(), (unsigned long long)textAllocations, int(lat.size()), perCall);
+    QJsonObject r;
+    r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+    r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+    r.insert(QStringLiteral("allocationsPerText"), double(textAllocations) / double(lat.size()));
+    r.insert(QStringLiteral("allocationsPerFormat"), perCall);
+    memoryResults.append(r);
+    QCOMPARE(textAllocations, uint64_t(0));
+}
+
+void LatLonBench::formatUTM()
+{
+    QFETCH(int, dataset);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+
+    LatLonWidget w;
+    w.setPositionFormat(LatLonWidget::eUTM);
+
+    // In coalesced mode setPosition only stores the value (the timer never
+    // fires here), so this measures formatUTM
+    w.setUpdateMode(LatLonWidget::UpdateMode::eCOALESCED);
+
+    QBENCHMARK {
+        for( const Position &p : positions ) {
+            w.setPosition(p.latitude, p.longitude);
+            w.formatUTM();
+        }
+    }
+}
+
+void LatLonBench::parse_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("posFormat");
+
+    QTest::newRow("dd-sign") << QString::fromUtf8("-123.456789°") << int(LatLonWidget::eDECIMAL_DEG);
+    QTest::newRow("dd-direction") << QString::fromUtf8("W 123.456789°") << int(LatLonWidget::eDECIMAL_DEG);
+    QTest::newRow("dms") << QString::fromUtf8("W 123° 27' 24.44\"") << int(LatLonWidget::eDMS);
+    QTest::newRow("utm") << QString::fromUtf8("33U 5000000 m") << int(LatLonWidget::eUTM);
+}
+
+void LatLonBench::parse()
+{
+    QFETCH(QString, text);
+    QFETCH(int, posFormat);
+
+    const std::u16string_view view(reinterpret_cast<const char16_t *>(text.utf16()),
+                                   std::size_t(text.size()));
+    int errors = 0;
+
+    // one keystroke's worth of parsing, repeated over a dataset
+    QBENCHMARK {
+        for( int i = 0; i < kDatasetSize; ++i ) {
+            if( posFormat == LatLonWidget::eDECIMAL_DEG )
+                errors += LatLonParser::parseDecimalDeg(view).error;
+            else if( posFormat == LatLonWidget::eDMS )
+                errors += LatLonParser::parseDMS(view).error;
+            else
+                errors += LatLonParser::parseUTMNorthing(view).error;
+        }
+    }
+    QCOMPARE(errors, 0);
+}
+
+void LatLonBench::setPosition_data()
+{
+    QTest::addColumn<int>("dataset");
+    QTest::addColumn<int>("posFormat");
+
+    const char *formats[] = { "dd", "dms", "utm" };
+    for( int i = 0; i < int(sizeof(kDatasets) / sizeof(kDatasets[0])); ++i ) {
+        for( int f = LatLonWidget::eDECIMAL_DEG; f <= LatLonWidget::eUTM; ++f )
+            QTest::newRow(QByteArray(kDatasets[i].name) + '/' + formats[f]) << i << f;
+    }
+}
+
+void LatLonBench::setPosition()
+{
+    QFETCH(int, dataset);
+    QFETCH(int, posFormat);
+    const std::vector<Position> positions = makePositions(kDatasets[dataset]);
+
+    LatLonWidget w;
+    w.setPositionFormat(posFormat);
+
+    QBENCHMARK {
+        for( const Position &p : positions )
+            w.setPosition(p.latitude, p.longitude);
+    }
+}
+
+void LatLonBench::setPositionProfiled_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("off") << 0;
+    QTest::newRow("counting") << 1;
+    QTest::newRow("tracing") << 2;
+}
+
+// setPosition() with the profiler off, counting, and recording a trace;
+// "off" against setPosition/global is the cost of the disabled probes
+void LatLonBench::setPositionProfiled()
+{
+    QFETCH(int, mode);
+    const std::vector<Position> positions = makePositions(kDatasets[0]);
+    QTemporaryFile traceFile;
+    QVERIFY(traceFile.open());
+
+    LatLonWidget w;
+    LatLonProfiler::reset();
+    LatLonProfiler::setEnabled(mode >= 1);
+    if( mode == 2 )
+        QVERIFY(LatLonProfiler::startTrace(traceFile.fileName()));
+
+    QBENCHMARK {
+        for( const Position &p : positions )
+            w.setPosition(p.latitude, p.longitude);
+    }
+
+    if( mode == 2 )
+        QVERIFY(LatLonProfiler::stopTrace());
+    LatLonProfiler::setEnabled(false);
+    QCOMPARE(LatLonProfiler::stats(LatLonProfiler::eSET_POSITION).calls == 0, mode == 0);
+}
+
+void LatLonBench::coalescedFlood_data()
+{
+    QTest::addColumn<int>("updateMode");
+    QTest::newRow("immediate") << int(LatLonWidget::UpdateMode::eIMMEDIATE);
+    QTest::newRow("coalesced") << int(LatLonWidget::UpdateMode::eCOALESCED);
+}
+
+///
+/// A shown editor widget fed a whole dataset within one frame, then the
+/// event loop until the display shows the last position. The interval is
+/// 0 so the time is the work done, not the wait for the timer.
+///
+void LatLonBench::coalescedFlood()
+{
+    QFETCH(int, updateMode);
+    const std::vector<Position> positions = makePositions(kDatasets[0]);
+
+    LatLonWidget w;
+    w.setUpdateMode(static_cast<LatLonWidget::UpdateMode>(updateMode), 0);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+    QLineEdit *edit = w.findChild<QLineEdit *>(QStringLiteral("Latitude"));
+    QVERIFY(edit);
+
+    // what the display has to end up with; the dataset is walked forwards
+    // and backwards in turn, so every iteration ends on a new text
+    auto shown = [](const Position &p) {
+        LatLonWidget reference;
+        reference.setPosition(p.latitude, p.longitude);
+        return reference.findChild<QLineEdit *>(QStringLiteral("Latitude"))->text();
+    };
+    const QString lastText[2] = { shown(positions.back()), shown(positions.front()) };
+    QVERIFY(lastText[0] != lastText[1]);
+    int iteration = 0;
+
+    QBENCHMARK {
+        const bool backwards = (iteration++ % 2) != 0;
+        for( std::size_t i = 0; i < positions.size(); ++i ) {
+            const Position &p = positions[backwards ? positions.size() - 1 - i : i];
+            w.setPosition(p.latitude, p.longitude);
+        }
+        QCoreApplication::processEvents();
+        QTRY_VERIFY(edit->text() == lastText[backwards ? 1 : 0]);
+    }
+}
+
+void LatLonBench::broadcast_data()
+{
+    QTest::addColumn<int>("widgets");
+    QTest::addColumn<bool>("useModel");
+    for( int n : { 1, 10, 100 } ) {
+        QTest::newRow(QByteArray("setPosition/") + QByteArray::number(n)) << n << false;
+        QTest::newRow(QByteArray("model/") + QByteArray::number(n)) << n << true;
+    }
+}
+
+// One position pushed to N painted widgets showing DD, DMS and UTM in
+// turn, by a setPosition() call per widget or through a PositionModel
+void LatLonBench::broadcast()
+{
+    QFETCH(int, widgets);
+    QFETCH(bool, useModel);
+    const std::vector<Position> positions = makePositions(kDatasets[0]);
+
+    std::vector<std::unique_ptr<LatLonWidget>> all;
+    PositionModel model;
+    for( int i = 0; i < widgets; ++i ) {
+        all.emplace_back(new LatLonWidget(LatLonWidget::DisplayMode::ePAINTED));
+        all.back()->setPositionFormat(i % 3);
+        if( useModel )
+            all.back()->setPositionModel(&model);
+    }
+
+    QBENCHMARK {
+        for( const Position &p : positions ) {
+            if( useModel ) {
+                model.setPosition(p.latitude, p.longitude);
+            } else {
+                for( const std::unique_ptr<LatLonWidget> &w : all )
+                    w->setPosition(p.latitude, p.longitude);
+            }
+        }
+    }
+}
+
+void LatLonBench::displayUpdate_data()
+{
+    QTest::addColumn<int>("displayMode");
+    QTest::addColumn<int>("posFormat");
+
+    const char *formats[] = { "dd", "dms", "utm" };
+    for( int f = LatLonWidget::eDECIMAL_DEG; f <= LatLonWidget::eUTM; ++f ) {
+        QTest::newRow(QByteArray("editor/") + formats[f]) << int(LatLonWidget::DisplayMode::eEDITOR) << f;
+        QTest::newRow(QByteArray("painted/") + formats[f]) << int(LatLonWidget::DisplayMode::ePAINTED) << f;
+    }
+}
+
+///
+/// A shown read-only widget following a moving position: setPosition() and
+/// the repaint it causes, per update.
+///
+void LatLonBench::displayUpdate()
+{
+    QFETCH(int, displayMode);
+    QFETCH(int, posFormat);
+
+    // a slow track, so most updates only change the last digits
+    std::vector<Position> track(kDatasetSize);
+    for( int i = 0; i < kDatasetSize; ++i )
+        track[std::size_t(i)] = { 48.858370 + i * 1e-6, 2.294481 + i * 2e-6 };
+
+    LatLonWidget w;
+    w.setReadOnly(true);
+    w.setDisplayMode(static_cast<LatLonWidget::DisplayMode>(displayMode));
+    w.setPositionFormat(posFormat);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    QBENCHMARK {
+        for( const Position &p : track ) {
+            w.setPosition(p.latitude, p.longitude);
+            QCoreApplication::processEvents();
+        }
+    }
+}
+
+void LatLonBench::displayMemory_data()
+{
+    QTest::addColumn<int>("displayMode");
+    QTest::newRow("editor") << int(LatLonWidget::DisplayMode::eEDITOR);
+    QTest::newRow("painted") << int(LatLonWidget::DisplayMode::ePAINTED);
+}
+
+///
+/// Heap per widget of a shown form of 500 read-only positions. Not a
+/// QBENCHMARK; the figures go to the "memory" array of the JSON output.
+///
+void LatLonBench::displayMemory()
+{
+    QFETCH(int, displayMode);
+    const int count = 500;
+
+    if( heapInUse() == 0 )
+        QSKIP("heap statistics need glibc 2.33");
+
+    // the first widget also fills the shared caches (fonts, style sheet, glyphs)
+    const auto mode = static_cast<LatLonWidget::DisplayMode>(displayMode);
+    LatLonWidget warmUp(mode);
+    warmUp.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&warmUp));
+
+    const std::size_t before = heapInUse();
+    {
+        std::unique_ptr<QWidget> form(new QWidget);
+        QVBoxLayout *layout = new QVBoxLayout(form.get());
+        for( int i = 0; i < count; ++i ) {
+            LatLonWidget *w = new LatLonWidget(mode);
+            w->setReadOnly(true);
+            w->setPosition(48.858370, 2.294481);
+            layout->addWidget(w);
+        }
+        form->show();
+        QVERIFY(QTest::qWaitForWindowExposed(form.get()));
+
+        const std::size_t after = heapInUse();
+        QJsonObject r;
+        r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+        r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+        r.insert(QStringLiteral("widgets"), count);
+        r.insert(QStringLiteral("bytesPerWidget"), double(after - before) / count);
+        memoryResults.append(r);
+        qDebug("%s: %.0f bytes per widget", QTest::currentDataTag(), double(after - before) / count);
+    }
+}
+
+void LatLonBench::formStartup_data()
+{
+    QTest::addColumn<int>("variant");
+    QTest::newRow("editor") << 0;
+    QTest::newRow("editor-readonly") << 1;
+    QTest::newRow("painted") << 2;
+    QTest::newRow("editor-pooled") << 3;
+}
+
+///
+/// Opening and closing a form of 500 positions: create the widgets, lay
+/// them out and show the form, then tear it down again. The pooled row
+/// takes the widgets from a LatLonWidgetPool and returns them on close.
+///
+void LatLonBench::formStartup()
+{
+    QFETCH(int, variant);
+    const int count = 500;
+
+    LatLonWidgetPool pool(count);
+    if( variant == 3 )
+        pool.reserve(count);
+
+    setPointsPerIteration(count);
+    QBENCHMARK {
+        QWidget form;
+        QVBoxLayout *layout = new QVBoxLayout(&form);
+        std::vector<LatLonWidget *> widgets;
+        widgets.reserve(count);
+        for( int i = 0; i < count; ++i ) {
+            LatLonWidget *w;
+            if( variant == 2 ) {
+                w = new LatLonWidget(LatLonWidget::DisplayMode::ePAINTED, &form);
+            } else if( variant == 3 ) {
+                w = pool.acquire(&form);
+            } else {
+                w = new LatLonWidget(&form);
+                w->setReadOnly(variant == 1);
+            }
+            w->setPosition(48.858370 + i * 1e-3, 2.294481);
+            layout->addWidget(w);
+            widgets.push_back(w);
+        }
+        form.show();
+        QCoreApplication::processEvents();
+        // recycled widgets must show up like new ones
+        for( LatLonWidget *w : widgets )
+            QVERIFY(w->isVisible());
+
+        if( variant == 3 ) {
+            for( LatLonWidget *w : widgets )
+                pool.release(w);
+        }
+    }
+}
+
+///
+/// The text the delegate paints, for every cell of a 100k row table.
+///
+void LatLonBench::delegateText()
+{
+    QFETCH(int, posFormat);
+    PositionTableModel model(makeTablePositions());
+
+    LatLonItemDelegate latitude(LatLonWidget::eLATITUDE);
+    LatLonItemDelegate longitude(LatLonWidget::eLONGITUDE);
+    latitude.setPositionFormat(posFormat);
+    longitude.setPositionFormat(posFormat);
+
+    setPointsPerIteration(kTableRows);
+    QBENCHMARK {
+        for( int row = 0; row < kTableRows; ++row ) {
+            latitude.text(model.index(row, 0));
+            longitude.text(model.index(row, 1));
+        }
+    }
+}
+
+///
+/// One repaint of a table view over 100k rows; only the visible rows are
+/// painted, and no widget exists per row.
+///
+void LatLonBench::delegatePaint()
+{
+    QFETCH(int, posFormat);
+    PositionTableModel model(makeTablePositions());
+
+    QTableView view;
+    view.resize(640, 480);
+    view.setModel(&model);
+    LatLonItemDelegate latitude(LatLonWidget::eLATITUDE);
+    LatLonItemDelegate longitude(LatLonWidget::eLONGITUDE);
+    latitude.setPositionFormat(posFormat);
+    longitude.setPositionFormat(posFormat);
+    view.setItemDelegateForColumn(0, &latitude);
+    view.setItemDelegateForColumn(1, &longitude);
+    view.scrollTo(model.index(kTableRows / 2, 0));
+
+    QPixmap pixmap(view.size());
+    view.render(&pixmap);
+
+    int visible = view.rowAt(view.viewport()->height() - 1) - view.rowAt(0) + 1;
+    setPointsPerIteration(std::max(visible, 1));
+
+    QBENCHMARK {
+        view.render(&pixmap);
+    }
+}
+
+void LatLonBench::indexEncode()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    std::vector<uint64_t> codes(d.latitude.size());
+    setPointsPerIteration(count);
+
+    QBENCHMARK {
+        PositionIndex::encode(d.latitude.data(), d.longitude.data(), codes.size(), codes.data());
+    }
+}
+
+void LatLonBench::indexBuild()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    setPointsPerIteration(count);
+
+    QBENCHMARK {
+        PositionIndex index;
+        index.build(d.latitude.data(), d.longitude.data(), d.latitude.size());
+    }
+}
+
+void LatLonBench::indexNearest_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("k");
+    QTest::newRow("1M/k1") << 1000000 << 1;
+    QTest::newRow("1M/k10") << 1000000 << 10;
+    QTest::newRow("10M/k1") << 10000000 << 1;
+    QTest::newRow("10M/k10") << 10000000 << 10;
+}
+
+void LatLonBench::indexNearest()
+{
+    QFETCH(int, count);
+    QFETCH(int, k);
+    const IndexData &d = indexData(count);
+    const std::vector<Position> queries = makePositions(kDatasets[0]);
+
+    // one query per dataset position
+    QBENCHMARK {
+        for( const Position &q : queries )
+            d.index.nearest(q.latitude, q.longitude, std::size_t(k));
+    }
+}
+
+void LatLonBench::indexRadius()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    const std::vector<Position> queries = makePositions(kDatasets[0]);
+
+    QBENCHMARK {
+        for( const Position &q : queries )
+            d.index.withinRadius(q.latitude, q.longitude, 50000.0);
+    }
+}
+
+///
+/// The linear scan the index replaces; one query per iteration.
+///
+void LatLonBench::linearNearest()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    const Position q = makePositions(kDatasets[0])[2];
+    double bestDistance = 0;
+    setPointsPerIteration(1);
+
+    QBENCHMARK {
+        bestDistance = HUGE_VAL;
+        for( std::size_t i = 0; i < d.latitude.size(); ++i ) {
+            const double dist = PositionIndex::distance(q.latitude, q.longitude,
+                                                        d.latitude[i], d.longitude[i]);
+            bestDistance = std::min(bestDistance, dist);
+        }
+    }
+
+    // the index works on micro-degrees, within a metre of the exact scan
+    QVERIFY(std::fabs(d.index.nearest(q.latitude, q.longitude, 1).front().distance
+                      - bestDistance) < 1.0);
+}
+
+void LatLonBench::arrayAppend()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    PositionArray array;
+    array.reserve(d.latitude.size());
+    setPointsPerIteration(count);
+
+    QBENCHMARK {
+        array.clear();
+        array.append(d.latitude.data(), d.longitude.data(), d.latitude.size());
+    }
+}
+
+void LatLonBench::arrayValidate()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    PositionArray array;
+    array.append(d.latitude.data(), d.longitude.data(), d.latitude.size());
+    std::vector<uint8_t> valid(array.size());
+    std::size_t invalid = 0;
+    setPointsPerIteration(count);
+
+    QBENCHMARK {
+        invalid = array.validate(valid.data());
+    }
+    QCOMPARE(invalid, std::size_t(0));
+}
+
+// The same check on FloatType pairs, as the widget does it one value at a time
+void LatLonBench::floatValidate()
+{
+    QFETCH(int, count);
+    const IndexData &d = indexData(count);
+    std::vector<FloatType> latitude, longitude;
+    latitude.reserve(d.latitude.size());
+    longitude.reserve(d.longitude.size());
+    for( std::size_t i = 0; i < d.latitude.size(); ++i ) {
+        latitude.emplace_back(d.latitude[i]);
+        longitude.emplace_back(d.longitude[i]);
+    }
+    std::vector<uint8_t> valid(latitude.size());
+    std::size_t invalid = 0;
+    setPointsPerIteration(count);
+
+    QBENCHMARK {
+        invalid = 0;
+        for( std::size_t i = 0; i < latitude.size(); ++i ) {
+            const double lat = std::fabs(latitude[i].getValue());
+            const double lon = std::fabs(longitude[i].getValue());
+            valid[i] = uint8_t((lat <= 90.0 ? PositionArray::eLATITUDE_VALID : 0)
+                               | (lon <= 180.0 ? PositionArray::eLONGITUDE_VALID : 0));
+            invalid += (valid[i] != PositionArray::ePOSITION_VALID);
+        }
+    }
+    QCOMPARE(invalid, std::size_t(0));
+}
+
+void LatLonBench::nmeaParse()
+{
+    const QByteArray nmea = makeNmea();
+    std::vector<std::string_view> sentences;
+    for( int begin = 0; begin < nmea.size(); ) {
+        const int end = nmea.indexOf('\n', begin) + 1;
+        sentences.emplace_back(nmea.constData() + begin, std::size_t(end - begin));
+        begin = end;
+    }
+    int fixes = 0;
+    setPointsPerIteration(int(sentences.size()));
+
+    QBENCHMARK {
+        fixes = 0;
+        for( std::string_view s : sentences )
+            fixes += NmeaParser::parseSentence(s).hasPosition;
+    }
+    QCOMPARE(fixes, int(sentences.size()));
+}
+
+void LatLonBench::nmeaStream_data()
+{
+    QTest::addColumn<int>("widgets");
+    QTest::addColumn<double>("replaySpeed");
+    QTest::newRow("1-widget") << 1 << 0.0;
+    QTest::newRow("16-widgets") << 16 << 0.0;
+    QTest::newRow("replay-1000x") << 1 << 1000.0;
+}
+
+///
+/// The whole stream from a QBuffer through NmeaPositionSource into painted
+/// widgets, until finished(). Unpaced rows measure the throughput; the
+/// replay row checks that pacing holds the stream to its recorded length.
+///
+void LatLonBench::nmeaStream()
+{
+    QFETCH(int, widgets);
+    QFETCH(double, replaySpeed);
+
+    QByteArray nmea = makeNmea();
+    QBuffer buffer(&nmea);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    std::vector<std::unique_ptr<LatLonWidget>> w;
+    NmeaPositionSource source;
+    source.setDevice(&buffer);
+    source.setReplaySpeed(replaySpeed);
+    for( int i = 0; i < widgets; ++i ) {
+        w.emplace_back(new LatLonWidget(LatLonWidget::DisplayMode::ePAINTED));
+        source.addWidget(w.back().get());
+    }
+
+    QEventLoop loop;
+    QObject::connect(&source, &NmeaPositionSource::finished, &loop, &QEventLoop::quit);
+    QElapsedTimer elapsed;
+    setPointsPerIteration(kDatasetSize * 2);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        elapsed.start();
+        source.start();
+        loop.exec();
+    }
+
+    const NmeaPositionSource::Statistics &s = source.statistics();
+    QCOMPARE(s.checksumErrors + s.invalid, quint64(0));
+    if( replaySpeed > 0 ) {
+        const double recordedMs = double((kDatasetSize - 1) * kNmeaEpochMs) / replaySpeed;
+        QVERIFY(double(elapsed.elapsed()) >= recordedMs - 1);
+    }
+}
+
+void LatLonBench::slotStress_data()
+{
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<int>("consumer");      // 0 take() in a loop, 1 widget, 2 model
+    QTest::newRow("slot-4") << 4 << 0;
+    QTest::newRow("slot-16") << 16 << 0;
+    QTest::newRow("widget-4") << 4 << 1;
+    QTest::newRow("model-4") << 4 << 2;
+}
+
+///
+/// Producer threads publishing kDatasetSize positions each into one
+/// PositionSlot while this thread takes them. Producer i publishes
+/// (v, -v) with v = (k * producers + i) micro-degrees: a torn read breaks
+/// the pair and an old one goes back in k. The widget and model rows take
+/// through the event loop, the widget once per frame, and must end at a
+/// position published after the producers stopped.
+///
+void LatLonBench::slotStress()
+{
+    QFETCH(int, producers);
+    QFETCH(int, consumer);
+
+    std::unique_ptr<PositionSlot> ownSlot;
+    std::unique_ptr<LatLonWidget> widget;
+    std::unique_ptr<PositionModel> model;
+    PositionSlot *slot;
+    if( consumer == 1 ) {
+        widget.reset(new LatLonWidget(LatLonWidget::DisplayMode::ePAINTED));
+        widget->setUpdateMode(LatLonWidget::UpdateMode::eCOALESCED);
+        slot = widget->positionSlot();
+    } else if( consumer == 2 ) {
+        model.reset(new PositionModel);
+        slot = model->positionSlot();
+    } else {
+        ownSlot.reset(new PositionSlot);
+        slot = ownSlot.get();
+    }
+
+    auto shows = [&](double latitude, double longitude) {
+        double la, lo;
+        if( widget )
+            widget->getPosition(la, lo);
+        else
+            model->getPosition(la, lo);
+        return la == latitude && lo == longitude;
+    };
+
+    uint64_t tornReads = 0;
+    uint64_t staleReads = 0;
+    int iteration = 0;
+    setPointsPerIteration(producers * kDatasetSize);
+
+    QBENCHMARK {
+        std::atomic<int> running(producers);
+        std::vector<std::thread> threads;
+        for( int i = 0; i < producers; ++i ) {
+            threads.emplace_back([slot, producers, i, &running] {
+                for( int k = 0; k < kDatasetSize; ++k ) {
+                    const double v = double(k * producers + i) * 1e-6;
+                    slot->publish(v, -v);
+                }
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        std::vector<int> lastK(std::size_t(producers), -1);
+        while( running.load(std::memory_order_acquire) > 0 ) {
+            if( consumer != 0 ) {
+                QCoreApplication::processEvents();
+                continue;
+            }
+            double latitude, longitude;
+            if( !slot->take(latitude, longitude) )
+                continue;
+            if( latitude != -longitude ) {
+                ++tornReads;
+                continue;
+            }
+            const long v = std::lround(latitude * 1e6);
+            int &last = lastK[std::size_t(v % producers)];
+            if( int(v / producers) <= last )
+                ++staleReads;
+            last = int(v / producers);
+        }
+        for( std::thread &t : threads )
+            t.join();
+
+        // the last position wins, also after a burst
+        const double marker = FloatType(12.5 + (++iteration % 1000) * 1e-6).getValue();
+        slot->publish(marker, -45.25);
+        if( consumer == 0 ) {
+            double latitude, longitude;
+            QVERIFY(slot->take(latitude, longitude));
+            QCOMPARE(latitude, marker);
+        } else {
+            QTRY_VERIFY(shows(marker, -45.25));
+        }
+    }
+
+    qInfo("%s: %llu published, %llu taken", QTest::currentDataTag(),
+          static_cast<unsigned long long>(slot->published()),
+          static_cast<unsigned long long>(slot->taken()));
+    QCOMPARE(tornReads, uint64_t(0));
+    QCOMPARE(staleReads, uint64_t(0));
+}
+
+void LatLonBench::geodesicScalar_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("vincenty") << int(Geodesic::Method::eVINCENTY);
+    QTest::newRow("haversine") << int(Geodesic::Method::eHAVERSINE);
+}
+
+///
+/// One pair per call from the first position of the global dataset to the
+/// others, the baseline of geodesicBatch.
+///
+void LatLonBench::geodesicScalar()
+{
+    QFETCH(int, method);
+    const std::vector<Position> positions = makePositions(kDatasets[0]);
+    const Position &from = positions[2];
+    double sum = 0;
+
+    QBENCHMARK {
+        sum = 0;
+        for( const Position &p : positions ) {
+            const Geodesic::Result r = (Geodesic::Method(method) == Geodesic::Method::eVINCENTY)
+                    ? Geodesic::inverse(from.latitude, from.longitude, p.latitude, p.longitude)
+                    : Geodesic::haversine(from.latitude, from.longitude, p.latitude, p.longitude);
+            sum += r.distance;
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void LatLonBench::geodesicBatch_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("threads");
+    QTest::newRow("vincenty") << int(Geodesic::Method::eVINCENTY) << 1;
+    QTest::newRow("vincenty-parallel") << int(Geodesic::Method::eVINCENTY) << 0;
+    QTest::newRow("haversine") << int(Geodesic::Method::eHAVERSINE) << 1;
+    QTest::newRow("haversine-parallel") << int(Geodesic::Method::eHAVERSINE) << 0;
+}
+
+///
+/// One position to the 1M of the spatial index benchmarks. Records the
+/// largest difference to the one pair calls and, for haversine, the error
+/// of the sphere against the ellipsoid.
+///
+void LatLonBench::geodesicBatch()
+{
+    QFETCH(int, method);
+    QFETCH(int, threads);
+    const IndexData &d = indexData(1000000);
+    const Position from = makePositions(kDatasets[0])[2];
+    const std::size_t count = d.latitude.size();
+    std::vector<double> distance(count), bearing(count);
+    Geodesic::Options options;
+    options.method = Geodesic::Method(method);
+    options.threads = unsigned(threads);
+    setPointsPerIteration(int(count));
+
+    QBENCHMARK {
+        Geodesic::distances(from.latitude, from.longitude, d.latitude.data(), d.longitude.data(),
+                            count, distance.data(), bearing.data(), options);
+    }
+
+    double distanceError = 0, bearingError = 0, sphereError = 0;
+    for( std::size_t i = 0; i < count; i += 97 ) {
+        const Geodesic::Result ellipsoid = Geodesic::inverse(from.latitude, from.longitude,
+                                                             d.latitude[i], d.longitude[i]);
+        const Geodesic::Result r = (options.method == Geodesic::Method::eVINCENTY)
+                ? ellipsoid
+                : Geodesic::haversine(from.latitude, from.longitude, d.latitude[i], d.longitude[i]);
+        distanceError = std::max(distanceError, std::fabs(distance[i] - r.distance));
+        bearingError = std::max(bearingError, std::fabs(std::remainder(bearing[i] - r.initialBearing, 360.0)));
+        if( ellipsoid.distance > 1000.0 )
+            sphereError = std::max(sphereError, std::fabs(r.distance - ellipsoid.distance) / ellipsoid.distance);
+    }
+
+    qInfo("%s: max batch error %.3g m, %.3g deg; max error to the ellipsoid %.3g%%",
+          QTest::currentDataTag(), distanceError, bearingError, 100 * sphereError);
+    QJsonObject r;
+    r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+    r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+    r.insert(QStringLiteral("batchDistanceError"), distanceError);
+    r.insert(QStringLiteral("batchBearingError"), bearingError);
+    r.insert(QStringLiteral("relativeEllipsoidError"), sphereError);
+    accuracyResults.append(r);
+    QVERIFY(distanceError < 1e-3);
+}
+
+void LatLonBench::geodesicMatrix_data()
+{
+    QTest::addColumn<int>("origins");
+    QTest::addColumn<int>("method");
+    QTest::newRow("vincenty-1k") << 1000 << int(Geodesic::Method::eVINCENTY);
+    QTest::newRow("haversine-1k") << 1000 << int(Geodesic::Method::eHAVERSINE);
+}
+
+///
+/// From the first `origins` positions of the spatial index data to each
+/// position of the global dataset, on all threads.
+///
+void LatLonBench::geodesicMatrix()
+{
+    QFETCH(int, origins);
+    QFETCH(int, method);
+    const IndexData &d = indexData(1000000);
+    std::vector<double> latitude, longitude;
+    for( const Position &p : makePositions(kDatasets[0]) ) {
+        latitude.push_back(p.latitude);
+        longitude.push_back(p.longitude);
+    }
+    std::vector<double> distance(std::size_t(origins) * latitude.size());
+    Geodesic::Options options;
+    options.method = Geodesic::Method(method);
+    setPointsPerIteration(int(distance.size()));
+
+    QBENCHMARK {
+        Geodesic::distanceMatrix(d.latitude.data(), d.longitude.data(), std::size_t(origins),
+                                 latitude.data(), longitude.data(), latitude.size(),
+                                 distance.data(), nullptr, options);
+    }
+}
+
+void LatLonBench::datumTransform_data()
+{
+    QTest::addColumn<int>("datum");
+    QTest::addColumn<int>("threads");     // -1 for one position per call
+    QTest::newRow("ed50/scalar") << int(Datum::DatumType::eED50) << -1;
+    QTest::newRow("ed50/batch") << int(Datum::DatumType::eED50) << 1;
+    QTest::newRow("ed50/batch-parallel") << int(Datum::DatumType::eED50) << 0;
+    QTest::newRow("osgb36/scalar") << int(Datum::DatumType::eOSGB36) << -1;
+    QTest::newRow("osgb36/batch") << int(Datum::DatumType::eOSGB36) << 1;
+    QTest::newRow("osgb36/batch-parallel") << int(Datum::DatumType::eOSGB36) << 0;
+}
+
+///
+/// The 1M positions of the spatial index benchmarks from a datum to WGS84.
+/// Records the largest difference of the batch to the one position calls
+/// and of a round trip back to the datum, in metres.
+///
+void LatLonBench::datumTransform()
+{
+    QFETCH(int, datum);
+    QFETCH(int, threads);
+    const IndexData &d = indexData(1000000);
+    const std::size_t count = d.latitude.size();
+    std::vector<double> latitude(count), longitude(count);
+    const Datum::Transform &toWGS84 = Datum::transform(Datum::DatumType(datum), Datum::DatumType::eWGS84);
+    Datum::Options options;
+    options.threads = unsigned(std::max(threads, 0));
+    setPointsPerIteration(int(count));
+
+    QBENCHMARK {
+        if( threads < 0 ) {
+            for( std::size_t i = 0; i < count; ++i )
+                toWGS84.apply(d.latitude[i], d.longitude[i], latitude[i], longitude[i]);
+        } else {
+            toWGS84.apply(d.latitude.data(), d.longitude.data(), nullptr, count,
+                          latitude.data(), longitude.data(), nullptr, options);
+        }
+    }
+
+    // metres of a difference in degrees at a latitude
+    auto metres = [](double latitude, double dLatitude, double dLongitude) {
+        const double m = Geodesic::kMeanRadius * DEG_TO_RAD;
+        return std::hypot(dLatitude * m, std::remainder(dLongitude, 360.0) * m * std::cos(latitude * DEG_TO_RAD));
+    };
+    const Datum::Transform &back = Datum::transform(Datum::DatumType::eWGS84, Datum::DatumType(datum));
+    double batchError = 0, roundTripError = 0;
+    for( std::size_t i = 0; i < count; i += 97 ) {
+        double la, lo;
+        toWGS84.apply(d.latitude[i], d.longitude[i], la, lo);
+        batchError = std::max(batchError, metres(la, latitude[i] - la, longitude[i] - lo));
+        double rla, rlo;
+        back.apply(la, lo, rla, rlo);
+        roundTripError = std::max(roundTripError, metres(rla, rla - d.latitude[i], rlo - d.longitude[i]));
+    }
+
+    qInfo("%s: max batch error %.3g m, max round trip error %.3g m",
+          QTest::currentDataTag(), batchError, roundTripError);
+    QJsonObject r;
+    r.insert(QStringLiteral("benchmark"), QString::fromLatin1(QTest::currentTestFunction()));
+    r.insert(QStringLiteral("tag"), QString::fromLatin1(QTest::currentDataTag()));
+    r.insert(QStringLiteral("batchError"), batchError);
+    r.insert(QStringLiteral("roundTripError"), roundTripError);
+    accuracyResults.append(r);
+    QVERIFY(batchError < 1e-3);
+    QVERIFY(roundTripError < 1e-3);
+}
+
+void LatLonBench::datumTyping_data()
+{
+    QTest::addColumn<int>("datum");
+    QTest::addColumn<int>("posFormat");
+    QTest::addColumn<QString>("text1");
+    QTest::addColumn<QString>("text2");
+
+    const QString dd1 = QString::fromUtf8("+48.858370°");
+    const QString dd2 = QString::fromUtf8("+48.858371°");
+    const QString utm1 = QStringLiteral("31U 5411951 m");
+    const QString utm2 = QStringLiteral("31U 5411952 m");
+    QTest::newRow("wgs84/dd") << int(Datum::DatumType::eWGS84) << int(LatLonWidget::eDECIMAL_DEG) << dd1 << dd2;
+    QTest::newRow("ed50/dd") << int(Datum::DatumType::eED50) << int(LatLonWidget::eDECIMAL_DEG) << dd1 << dd2;
+    QTest::newRow("wgs84/utm") << int(Datum::DatumType::eWGS84) << int(LatLonWidget::eUTM) << utm1 << utm2;
+    QTest::newRow("ed50/utm") << int(Datum::DatumType::eED50) << int(LatLonWidget::eUTM) << utm1 << utm2;
+}
+
+///
+/// Keystrokes in the latitude (or northing) field of a widget showing a
+/// datum: the rows of a datum should cost what the WGS84 ones do.
+///
+void LatLonBench::datumTyping()
+{
+    QFETCH(int, datum);
+    QFETCH(int, posFormat);
+    QFETCH(QString, text1);
+    QFETCH(QString, text2);
+
+    LatLonWidget w;
+    w.setPositionFormat(posFormat);
+    w.setPosition(48.858370, 2.294481);
+    w.setDatum(Datum::DatumType(datum));
+    QLineEdit *edit = w.findChild<QLineEdit *>(QStringLiteral("Latitude"));
+    QVERIFY(edit);
+    setPointsPerIteration(kDatasetSize);
+
+    QBENCHMARK {
+        for( int i = 0; i < kDatasetSize; ++i )
+            edit->setText((i & 1) ? text2 : text1);
+    }
+
+    double latitude, longitude;
+    w.getPosition(latitude, longitude);
+    QVERIFY(std::fabs(latitude - 48.858370) < 0.01);
+}
+
+///
+/// \brief Convert the QTest XML log into the JSON kept between releases.
+///
+/// Each result records the benchmark, its data tag, the metric and the value
+/// per iteration, plus the value per point (an iteration walks kDatasetSize
+/// points unless the benchmark said otherwise).
+///
+static bool writeJson(const QString &xmlPath, const QString &jsonPath)
+{
+    QFile xmlFile(xmlPath);
+    if( !xmlFile.open(QIODevice::ReadOnly) )
+        return false;
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while( !xml.atEnd() ) {
+        if( xml.readNext() != QXmlStreamReader::StartElement )
+            continue;
+
+        const QXmlStreamAttributes attr = xml.attributes();
+        if( xml.name() == QLatin1String("TestFunction") ) {
+            function = attr.value(QLatin1String("name")).toString();
+        } else if( xml.name() == QLatin1String("BenchmarkResult") ) {
+            const double value = attr.value(QLatin1String("value")).toDouble();
+            const QString tag = attr.value(QLatin1String("tag")).toString();
+            const int points = pointsPerIteration.value(function + QLatin1Char('/') + tag,
+                                                        kDatasetSize);
+            QJsonObject r;
+            r.insert(QStringLiteral("benchmark"), function);
+            r.insert(QStringLiteral("tag"), tag);
+            r.insert(QStringLiteral("metric"), attr.value(QLatin1String("metric")).toString());
+            r.insert(QStringLiteral("value"), value);
+            r.insert(QStringLiteral("iterations"), attr.value(QLatin1String("iterations")).toInt());
+            r.insert(QStringLiteral("points"), points);
+            r.insert(QStringLiteral("valuePerPoint"), value / points);
+            results.append(r);
+        }
+    }
+    if( xml.hasError() )
+        return false;
+
+    QJsonObject root;
+    root.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("date"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert(QStringLiteral("simdLevel"), int(UTM::DetectSimdLevel()));
+    root.insert(QStringLiteral("results"), results);
+    root.insert(QStringLiteral("accuracy"), accuracyResults);
+    root.insert(QStringLiteral("memory"), memoryResults);
+
+    QFile jsonFile(jsonPath);
+    if( !jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+        return false;
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+///
+/// Usage: latlon_bench [-json <file>] [QTest options]
+///
+/// Runs the benchmarks with the usual QTest text output and writes the
+/// results to latlon_bench.json (or <file>).
+///
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString jsonPath = QStringLiteral("latlon_bench.json");
+    int i = args.indexOf(QStringLiteral("-json"));
+    if( i > 0 && i + 1 < args.size() ) {
+        jsonPath = args.at(i + 1);
+        args.erase(args.begin() + i, args.begin() + i + 2);
+    }
+
+    QTemporaryFile xmlFile;
+    if( !xmlFile.open() )
+        return 1;
+    xmlFile.close();
+    args << QStringLiteral("-o") << xmlFile.fileName() + QStringLiteral(",xml")
+         << QStringLiteral("-o") << QStringLiteral("-,txt");
+
+    LatLonBench bench;
+    int rc = QTest::qExec(&bench, args);
+
+    if( !writeJson(xmlFile.fileName(), jsonPath) ) {
+        qWarning("Could not write %s", qPrintable(jsonPath));
+        return rc ? rc : 1;
+    }
+    return rc;
+}
+
+#include "latlonbench.moc"
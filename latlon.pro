@@ -0,0 +1,47 @@
+QT       += core gui
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = latlon
+TEMPLATE = app
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which has been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+CONFIG += c++17
+
+# LatLonProfiler: remove the probes, or count heap allocations (glibc only)
+#DEFINES += LATLONWIDGET_NO_PROFILING
+#DEFINES += LATLONWIDGET_COUNT_ALLOCATIONS
+
+INCLUDEPATH += $$PWD/latloncore
+DEPENDPATH += $$PWD/latloncore
+LIBS += -L$$OUT_PWD/latloncore -llatloncore
+PRE_TARGETDEPS += $$OUT_PWD/latloncore/$${QMAKE_PREFIX_STATICLIB}latloncore.$${QMAKE_EXTENSION_STATICLIB}
+
+HEADERS += \
+    latlonitemdelegate.h \
+    latlonprofiler.h \
+    latlonwidget.h \
+    latlonwidget_p.h \
+    latlonwidgetpool.h \
+    nmeapositionsource.h \
+    positionmodel.h \
+    widget.h
+
+SOURCES += \
+    latlonitemdelegate.cpp \
+    latlonprofiler.cpp \
+    latlonwidget.cpp \
+    latlonwidgetpool.cpp \
+    nmeapositionsource.cpp \
+    positionmodel.cpp \
+    main.cpp \    
+    widget.cpp
@@ -0,0 +1,482 @@
+#include "datum.h"
+
+#include "utm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Datum::DatumType;
+
+const Datum::Definition kDefinitions[Datum::kDatumCount] = {
+    { "WGS84", { UTM::WGS84::a, UTM::WGS84::f }, { 0, 0, 0, 0, 0, 0, 0 } },
+    // EPSG:1133, ED50 to WGS 84 (1), mean for western Europe
+    { "ED50", { UTM::International1924::a, UTM::International1924::f },
+      { -87, -98, -121, 0, 0, 0, 0 } },
+    // EPSG:1173, NAD27 to WGS 84 (4), mean for the conterminous United States
+    { "NAD27", { UTM::Clarke1866::a, UTM::Clarke1866::f },
+      { -8, 160, 176, 0, 0, 0, 0 } },
+    // EPSG:1314, OSGB36 to WGS 84 (6), Ordnance Survey
+    { "OSGB36", { UTM::Airy1830::a, UTM::Airy1830::f },
+      { 446.448, -125.157, 542.060, 0.1502, 0.2470, 0.8421, -20.4894 } }
+};
+
+const double kArcSecond = 3.14159265358979323846 / (180.0 * 3600.0);
+
+///
+/// \brief Constants of an ellipsoid used by the conversions.
+///
+struct Shape
+{
+    double a;
+    double b;
+    double e2;      ///< first eccentricity squared
+    double ep2;     ///< second eccentricity squared
+};
+
+///
+/// \brief x' = matrix x + translation, from ECEF on source to ECEF on target.
+///
+struct Affine
+{
+    double matrix[9];
+    double translation[3];
+    Shape source;
+    Shape target;
+};
+
+Shape makeShape(const Datum::Ellipsoid &e)
+{
+    Shape s;
+    s.a = e.a;
+    s.b = e.a * (1 - e.f);
+    s.e2 = e.f * (2 - e.f);
+    s.ep2 = s.e2 / (1 - s.e2);
+    return s;
+}
+
+Affine makeAffine(const Datum::Transform::Coefficients &c)
+{
+    Affine t;
+    std::copy(c.matrix, c.matrix + 9, t.matrix);
+    std::copy(c.translation, c.translation + 3, t.translation);
+    t.source = makeShape(c.source);
+    t.target = makeShape(c.target);
+    return t;
+}
+
+void toEcef(const Shape &s, double latitude, double longitude, double height,
+            double &x, double &y, double &z)
+{
+    const double sinLat = std::sin(latitude);
+    const double cosLat = std::cos(latitude);
+    const double n = s.a / std::sqrt(1 - s.e2 * sinLat * sinLat);
+    x = (n + height) * cosLat * std::cos(longitude);
+    y = (n + height) * cosLat * std::sin(longitude);
+    z = (n * (1 - s.e2) + height) * sinLat;
+}
+
+// Bowring's method, one iteration: below a micrometre within 10 km of the ellipsoid
+void fromEcef(const Shape &s, double x, double y, double z,
+              double &latitude, double &longitude, double &height)
+{
+    const double p = std::sqrt(x * x + y * y);
+
+    // reduced latitude of the first guess
+    double r = std::hypot(s.a * z, s.b * p);
+    if( r == 0 )
+        r = 1;      // the centre of the earth
+    const double sinB = s.a * z / r;
+    const double cosB = s.b * p / r;
+
+    const double num = z + s.ep2 * s.b * sinB * sinB * sinB;
+    const double den = p - s.e2 * s.a * cosB * cosB * cosB;
+    latitude = std::atan2(num, den);
+    longitude = std::atan2(y, x);
+
+    r = std::hypot(num, den);
+    if( r == 0 )
+        r = 1;
+    const double sinLat = num / r;
+    const double cosLat = den / r;
+    height = p * cosLat + z * sinLat - s.a * std::sqrt(1 - s.e2 * sinLat * sinLat);
+}
+
+// Helmert transformation of a datum to WGS84 as a matrix
+void helmertMatrix(const Datum::Helmert &h, double m[9])
+{
+    const double k = 1 + h.scale * 1e-6;
+    const double rx = h.rx * kArcSecond;
+    const double ry = h.ry * kArcSecond;
+    const double rz = h.rz * kArcSecond;
+    const double r[9] = {
+        1,   -rz,  ry,
+        rz,   1,  -rx,
+        -ry,  rx,   1
+    };
+    for( int i = 0; i < 9; ++i )
+        m[i] = k * r[i];
+}
+
+void invert(const double m[9], double inverse[9])
+{
+    const double c0 = m[4] * m[8] - m[5] * m[7];
+    const double c1 = m[5] * m[6] - m[3] * m[8];
+    const double c2 = m[3] * m[7] - m[4] * m[6];
+    const double d = 1 / (m[0] * c0 + m[1] * c1 + m[2] * c2);
+    inverse[0] = c0 * d;
+    inverse[1] = (m[2] * m[7] - m[1] * m[8]) * d;
+    inverse[2] = (m[1] * m[5] - m[2] * m[4]) * d;
+    inverse[3] = c1 * d;
+    inverse[4] = (m[0] * m[8] - m[2] * m[6]) * d;
+    inverse[5] = (m[2] * m[3] - m[0] * m[5]) * d;
+    inverse[6] = c2 * d;
+    inverse[7] = (m[1] * m[6] - m[0] * m[7]) * d;
+    inverse[8] = (m[0] * m[4] - m[1] * m[3]) * d;
+}
+
+void multiply(const double a[9], const double b[9], double product[9])
+{
+    for( int i = 0; i < 3; ++i ) {
+        for( int j = 0; j < 3; ++j )
+            product[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] + a[i * 3 + 2] * b[6 + j];
+    }
+}
+
+void multiply(const double m[9], const double v[3], double &x, double &y, double &z)
+{
+    x = m[0] * v[0] + m[1] * v[1] + m[2] * v[2];
+    y = m[3] * v[0] + m[4] * v[1] + m[5] * v[2];
+    z = m[6] * v[0] + m[7] * v[1] + m[8] * v[2];
+}
+
+// Block functions over count positions, with up to three inputs and outputs
+template<class P>
+using Chunk = void (*)(const P &, std::size_t, const double *, const double *, const double *,
+                       double *, double *, double *);
+
+struct Kernels
+{
+    Chunk<Shape> toEcef;
+    Chunk<Shape> fromEcef;
+    Chunk<Affine> transform;
+};
+
+} // namespace
+
+#ifdef UTM_HAVE_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+namespace sse41
+{
+    typedef UTM::batch_detail::sse41::V V;
+    using UTM::batch_detail::sse41::SinCos;
+    using UTM::batch_detail::sse41::Atan2;
+#include "datum_kernel.h"
+
+    const Kernels kKernels = {
+        &ForEachBlock<Shape, ToEcefBlock>,
+        &ForEachBlock<Shape, FromEcefBlock>,
+        &ForEachBlock<Affine, TransformBlock>
+    };
+} // namespace sse41
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace avx2
+{
+    typedef UTM::batch_detail::avx2::V V;
+    using UTM::batch_detail::avx2::SinCos;
+    using UTM::batch_detail::avx2::Atan2;
+#include "datum_kernel.h"
+
+    const Kernels kKernels = {
+        &ForEachBlock<Shape, ToEcefBlock>,
+        &ForEachBlock<Shape, FromEcefBlock>,
+        &ForEachBlock<Affine, TransformBlock>
+    };
+} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // UTM_HAVE_X86_DISPATCH
+
+namespace scalar
+{
+    typedef UTM::batch_detail::scalar::V V;
+    using UTM::batch_detail::scalar::SinCos;
+    using UTM::batch_detail::scalar::Atan2;
+#include "datum_kernel.h"
+
+    const Kernels kKernels = {
+        &ForEachBlock<Shape, ToEcefBlock>,
+        &ForEachBlock<Shape, FromEcefBlock>,
+        &ForEachBlock<Affine, TransformBlock>
+    };
+} // namespace scalar
+
+namespace {
+
+// The kernels of the best instruction set of the CPU
+const Kernels &kernels()
+{
+    switch( UTM::DetectSimdLevel() ) {
+#ifdef UTM_HAVE_X86_DISPATCH
+    case UTM::SIMD_AVX2:
+        return avx2::kKernels;
+    case UTM::SIMD_SSE41:
+        return sse41::kKernels;
+#endif
+    default:
+        return scalar::kKernels;
+    }
+}
+
+// work(begin, end) over [0, count), split over the calling thread and workers
+template<class Work>
+void parallelFor(std::size_t count, const Datum::Options &options, Work work)
+{
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = unsigned(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(count, 1)));
+    if( threads == 1 || count < options.parallelThreshold ) {
+        work(std::size_t(0), count);
+        return;
+    }
+
+    const std::size_t perThread = (count + threads - 1) / threads;
+    std::vector<std::thread> pool;
+    for( unsigned t = 1; t < threads; ++t ) {
+        const std::size_t begin = t * perThread;
+        if( begin >= count )
+            break;
+        pool.emplace_back(work, begin, std::min(begin + perThread, count));
+    }
+    work(std::size_t(0), std::min(perThread, count));
+
+    for( std::thread &t : pool )
+        t.join();
+}
+
+// Chunk over count positions in parallel; in2 and out2 may be nullptr
+template<class P>
+void runParallel(Chunk<P> chunk, const P &p, std::size_t count,
+                 const double *in0, const double *in1, const double *in2,
+                 double *out0, double *out1, double *out2, const Datum::Options &options)
+{
+    parallelFor(count, options, [&](std::size_t begin, std::size_t end) {
+        chunk(p, end - begin, in0 + begin, in1 + begin, in2 ? in2 + begin : nullptr,
+              out0 + begin, out1 + begin, out2 ? out2 + begin : nullptr);
+    });
+}
+
+} // namespace
+
+namespace Datum
+{
+
+const Definition &definition(DatumType datum)
+{
+    return kDefinitions[int(datum)];
+}
+
+void geodeticToEcef(const Ellipsoid &ellipsoid, double latitude, double longitude, double height,
+                    double &x, double &y, double &z)
+{
+    toEcef(makeShape(ellipsoid), latitude * DEG_TO_RAD, longitude * DEG_TO_RAD, height, x, y, z);
+}
+
+void ecefToGeodetic(const Ellipsoid &ellipsoid, double x, double y, double z,
+                    double &latitude, double &longitude, double &height)
+{
+    fromEcef(makeShape(ellipsoid), x, y, z, latitude, longitude, height);
+    latitude *= RAD_TO_DEG;
+    longitude *= RAD_TO_DEG;
+}
+
+void geodeticToEcef(const Ellipsoid &ellipsoid,
+                    const double *latitudes, const double *longitudes, const double *heights,
+                    std::size_t count, double *x, double *y, double *z, const Options &options)
+{
+    runParallel(kernels().toEcef, makeShape(ellipsoid), count,
+                latitudes, longitudes, heights, x, y, z, options);
+}
+
+void ecefToGeodetic(const Ellipsoid &ellipsoid, const double *x, const double *y, const double *z,
+                    std::size_t count, double *latitudes, double *longitudes, double *heights,
+                    const Options &options)
+{
+    runParallel(kernels().fromEcef, makeShape(ellipsoid), count,
+                x, y, z, latitudes, longitudes, heights, options);
+}
+
+///
+/// \brief Transform::Transform
+/// Combines the Helmert transformations of both datums to WGS84 into one:
+/// from's, then the inverse of to's.
+///
+Transform::Transform(DatumType from, DatumType to) :
+    m_from(from),
+    m_to(to)
+{
+    const Definition &source = definition(from);
+    const Definition &target = definition(to);
+    m_coefficients.source = source.ellipsoid;
+    m_coefficients.target = target.ellipsoid;
+
+    double fromMatrix[9], toMatrix[9], toInverse[9];
+    helmertMatrix(source.toWGS84, fromMatrix);
+    helmertMatrix(target.toWGS84, toMatrix);
+    invert(toMatrix, toInverse);
+    multiply(toInverse, fromMatrix, m_coefficients.matrix);
+
+    const double shift[3] = {
+        source.toWGS84.tx - target.toWGS84.tx,
+        source.toWGS84.ty - target.toWGS84.ty,
+        source.toWGS84.tz - target.toWGS84.tz
+    };
+    multiply(toInverse, shift, m_coefficients.translation[0], m_coefficients.translation[1],
+             m_coefficients.translation[2]);
+}
+
+void Transform::apply(double latitude, double longitude, double &outLatitude, double &outLongitude) const
+{
+    double height;
+    apply(latitude, longitude, 0, outLatitude, outLongitude, height);
+}
+
+void Transform::apply(double latitude, double longitude, double height,
+                      double &outLatitude, double &outLongitude, double &outHeight) const
+{
+    if( isIdentity() ) {
+        outLatitude = latitude;
+        outLongitude = longitude;
+        outHeight = height;
+        return;
+    }
+
+    const Affine t = makeAffine(m_coefficients);
+    double v[3];
+    toEcef(t.source, latitude * DEG_TO_RAD, longitude * DEG_TO_RAD, height, v[0], v[1], v[2]);
+    double x, y, z;
+    multiply(t.matrix, v, x, y, z);
+    fromEcef(t.target, x + t.translation[0], y + t.translation[1], z + t.translation[2],
+             outLatitude, outLongitude, outHeight);
+    outLatitude *= RAD_TO_DEG;
+    outLongitude *= RAD_TO_DEG;
+}
+
+void Transform::apply(const double *latitudes, const double *longitudes, const double *heights,
+                      std::size_t count, double *outLatitudes, double *outLongitudes, double *outHeights,
+                      const Options &options) const
+{
+    if( isIdentity() ) {
+        std::copy(latitudes, latitudes + count, outLatitudes);
+        std::copy(longitudes, longitudes + count, outLongitudes);
+        if( outHeights ) {
+            if( heights )
+                std::copy(heights, heights + count, outHeights);
+            else
+                std::fill(outHeights, outHeights + count, 0.0);
+        }
+        return;
+    }
+
+    runParallel(kernels().transform, makeAffine(m_coefficients), count,
+                latitudes, longitudes, heights, outLatitudes, outLongitudes, outHeights, options);
+}
+
+const Transform &transform(DatumType from, DatumType to)
+{
+    static const std::vector<Transform> table = [] {
+        std::vector<Transform> t;
+        t.reserve(kDatumCount * kDatumCount);
+        for( int i = 0; i < kDatumCount; ++i ) {
+            for( int j = 0; j < kDatumCount; ++j )
+                t.emplace_back(DatumType(i), DatumType(j));
+        }
+        return t;
+    }();
+    return table[std::size_t(int(from) * kDatumCount + int(to))];
+}
+
+namespace {
+
+template<class Ellipsoid>
+void projectOn(bool isPrecise, double latitude, double longitude,
+               double &northing, double &easting, UTM::UtmZone &zone)
+{
+    if( isPrecise )
+        UTM::KrugerTransverseMercator<Ellipsoid>::LLtoUTM(latitude, longitude, northing, easting, zone);
+    else
+        UTM::TransverseMercator<Ellipsoid>::LLtoUTM(latitude, longitude, northing, easting, zone);
+}
+
+template<class Ellipsoid>
+void unprojectOn(bool isPrecise, double northing, double easting, const UTM::UtmZone &zone,
+                 double &latitude, double &longitude)
+{
+    if( isPrecise )
+        UTM::KrugerTransverseMercator<Ellipsoid>::UTMtoLL(northing, easting, zone, latitude, longitude);
+    else
+        UTM::TransverseMercator<Ellipsoid>::UTMtoLL(northing, easting, zone, latitude, longitude);
+}
+
+} // namespace
+
+void LLtoUTM(DatumType datum, double latitude, double longitude, bool isPrecise,
+             double &northing, double &easting, UTM::UtmZone &zone)
+{
+    switch( datum ) {
+    case DatumType::eED50:
+        projectOn<UTM::International1924>(isPrecise, latitude, longitude, northing, easting, zone);
+        break;
+    case DatumType::eNAD27:
+        projectOn<UTM::Clarke1866>(isPrecise, latitude, longitude, northing, easting, zone);
+        break;
+    case DatumType::eOSGB36:
+        projectOn<UTM::Airy1830>(isPrecise, latitude, longitude, northing, easting, zone);
+        break;
+    default:
+        projectOn<UTM::WGS84>(isPrecise, latitude, longitude, northing, easting, zone);
+        break;
+    }
+}
+
+void UTMtoLL(DatumType datum, double northing, double easting, const UTM::UtmZone &zone,
+             bool isPrecise, double &latitude, double &longitude)
+{
+    switch( datum ) {
+    case DatumType::eED50:
+        unprojectOn<UTM::International1924>(isPrecise, northing, easting, zone, latitude, longitude);
+        break;
+    case DatumType::eNAD27:
+        unprojectOn<UTM::Clarke1866>(isPrecise, northing, easting, zone, latitude, longitude);
+        break;
+    case DatumType::eOSGB36:
+        unprojectOn<UTM::Airy1830>(isPrecise, northing, easting, zone, latitude, longitude);
+        break;
+    default:
+        unprojectOn<UTM::WGS84>(isPrecise, northing, easting, zone, latitude, longitude);
+        break;
+    }
+}
+
+} // namespace Datum
@@ -0,0 +1,162 @@
+#ifndef DATUM_H
+#define DATUM_H
+
+#include <cstddef>
+
+namespace UTM { struct UtmZone; }
+
+///
+/// \brief Geodetic datums and the transformations between them.
+///
+/// Positions on a datum other than WGS84 (legacy charts in ED50, NAD27 or
+/// OSGB36) are transformed through earth centred, earth fixed (ECEF)
+/// coordinates: geodetic to ECEF on the source ellipsoid, a Helmert
+/// 7-parameter transformation, and ECEF to geodetic on the target
+/// ellipsoid. The Helmert parameters of each pair of datums are combined
+/// into one rotation matrix and translation once, see transform().
+///
+/// The parameters are the published EPSG ones: a national fit for OSGB36,
+/// good to a few metres, and continental means for ED50 and NAD27, good to
+/// about ten. That is the accuracy of the datum definitions; the
+/// arithmetic round trips to well below a millimetre.
+///
+/// Positions are in degrees and heights in metres above the ellipsoid.
+/// The batch functions evaluate four (AVX2) or two (SSE4.1) positions at
+/// once, and split large batches over worker threads.
+///
+namespace Datum
+{
+
+enum class DatumType {
+    eWGS84,
+    eED50,      // European Datum 1950, International 1924 ellipsoid
+    eNAD27,     // North American Datum 1927, Clarke 1866 ellipsoid
+    eOSGB36     // Ordnance Survey Great Britain 1936, Airy 1830 ellipsoid
+};
+
+const int kDatumCount = 4;
+
+struct Ellipsoid
+{
+    double a;       ///< semi-major axis, metres
+    double f;       ///< flattening
+};
+
+///
+/// \brief Transformation from a datum to WGS84, position vector convention.
+///
+struct Helmert
+{
+    double tx, ty, tz;      ///< translation, metres
+    double rx, ry, rz;      ///< rotation, arc-seconds
+    double scale;           ///< scale difference, parts per million
+};
+
+struct Definition
+{
+    const char *name;
+    Ellipsoid ellipsoid;
+    Helmert toWGS84;
+};
+
+const Definition &definition(DatumType datum);
+
+void geodeticToEcef(const Ellipsoid &ellipsoid, double latitude, double longitude, double height,
+                    double &x, double &y, double &z);
+
+/// Bowring's method, one iteration; below a micrometre within 10 km of the ellipsoid.
+void ecefToGeodetic(const Ellipsoid &ellipsoid, double x, double y, double z,
+                    double &latitude, double &longitude, double &height);
+
+struct Options
+{
+    /// Worker threads, 0 for std::thread::hardware_concurrency().
+    unsigned threads {};
+
+    /// Batches with fewer positions run on the calling thread only.
+    std::size_t parallelThreshold {16384};
+};
+
+///
+/// \brief geodeticToEcef() of count positions. heights may be nullptr for 0.
+///
+void geodeticToEcef(const Ellipsoid &ellipsoid,
+                    const double *latitudes, const double *longitudes, const double *heights,
+                    std::size_t count, double *x, double *y, double *z, const Options &options);
+
+///
+/// \brief ecefToGeodetic() of count positions. heights may be nullptr.
+///
+void ecefToGeodetic(const Ellipsoid &ellipsoid, const double *x, const double *y, const double *z,
+                    std::size_t count, double *latitudes, double *longitudes, double *heights,
+                    const Options &options);
+
+///
+/// \brief Positions from one datum to another.
+///
+/// Holds the combined Helmert matrix of the pair; get one with transform().
+///
+class Transform
+{
+public:
+    Transform(DatumType from, DatumType to);
+
+    DatumType from() const { return m_from; }
+    DatumType to() const { return m_to; }
+
+    /// Both datums are the same; apply() copies.
+    bool isIdentity() const { return m_from == m_to; }
+
+    /// Positions on the source ellipsoid, at height 0.
+    void apply(double latitude, double longitude, double &outLatitude, double &outLongitude) const;
+    void apply(double latitude, double longitude, double height,
+               double &outLatitude, double &outLongitude, double &outHeight) const;
+
+    ///
+    /// \brief apply() of count positions.
+    ///
+    /// heights and outHeights may be nullptr (height 0, height dropped).
+    /// The output may be the input arrays. Agrees with the one position
+    /// apply() to well below a millimetre.
+    ///
+    void apply(const double *latitudes, const double *longitudes, const double *heights,
+               std::size_t count, double *outLatitudes, double *outLongitudes, double *outHeights,
+               const Options &options) const;
+
+    /// What the kernels use: x' = matrix x + translation between the ellipsoids.
+    struct Coefficients
+    {
+        double matrix[9];       ///< row major
+        double translation[3];
+        Ellipsoid source;
+        Ellipsoid target;
+    };
+
+    const Coefficients &coefficients() const { return m_coefficients; }
+
+private:
+    DatumType m_from;
+    DatumType m_to;
+    Coefficients m_coefficients;
+};
+
+///
+/// \brief The transformation from one datum to another, computed once per
+/// pair for the whole process.
+///
+const Transform &transform(DatumType from, DatumType to);
+
+///
+/// \brief UTM on the ellipsoid of datum, as in "ED50 / UTM zone 31N".
+///
+/// The series of UTM::LLtoUTM(), fast or precise; for eWGS84 the same
+/// results.
+///
+void LLtoUTM(DatumType datum, double latitude, double longitude, bool isPrecise,
+             double &northing, double &easting, UTM::UtmZone &zone);
+void UTMtoLL(DatumType datum, double northing, double easting, const UTM::UtmZone &zone,
+             bool isPrecise, double &latitude, double &longitude);
+
+} // namespace Datum
+
+#endif // DATUM_H
@@ -0,0 +1,171 @@
+/* -*- mode: C++ -*-
+ *
+ *  Batch kernels for the datum transformations.
+ *
+ *  License: Modified BSD Software License Agreement
+ */
+
+/**  @file
+ @brief Vector-width agnostic geodetic <-> ECEF and Helmert kernels.
+
+ This file has no include guard on purpose. datum.cpp includes it once per
+ instruction set, inside a namespace that provides utm.h's vector type
+ `V`, `SinCos()` and `Atan2()` (see UTM::batch_detail), and under the
+ matching compiler target options. It must not be included from anywhere
+ else.
+
+ `Shape`, the derived constants of an ellipsoid, and `Affine`, a combined
+ Helmert transformation between two of them, come from datum.cpp's
+ anonymous namespace.
+ */
+
+    /**
+     * Geodetic (radians) to ECEF of V::width positions.
+     */
+    static inline void ToEcef(const Shape &s, V::D lat, V::D lon, V::D h,
+                              V::D &x, V::D &y, V::D &z)
+    {
+        V::D sinLat, cosLat, sinLon, cosLon;
+        SinCos(lat, sinLat, cosLat);
+        SinCos(lon, sinLon, cosLon);
+
+        V::D n = V::div(V::set1(s.a), V::sqrt(V::sub(V::set1(1.0),
+                                                     V::mul(V::set1(s.e2), V::mul(sinLat, sinLat)))));
+        V::D r = V::mul(V::add(n, h), cosLat);
+        x = V::mul(r, cosLon);
+        y = V::mul(r, sinLon);
+        z = V::mul(V::add(V::mul(n, V::set1(1 - s.e2)), h), sinLat);
+    }
+
+    /**
+     * ECEF to geodetic (radians) of V::width positions, Bowring's method
+     * with one iteration.
+     */
+    static inline void FromEcef(const Shape &s, V::D x, V::D y, V::D z,
+                                V::D &lat, V::D &lon, V::D &h)
+    {
+        const V::D zero = V::set1(0.0);
+        const V::D one = V::set1(1.0);
+
+        V::D p = V::sqrt(V::add(V::mul(x, x), V::mul(y, y)));
+
+        // reduced latitude of the first guess, tan = a z / (b p)
+        V::D u = V::mul(V::set1(s.a), z);
+        V::D w = V::mul(V::set1(s.b), p);
+        V::D r = V::sqrt(V::add(V::mul(u, u), V::mul(w, w)));
+        r = V::select(V::eq(r, zero), one, r);      // the centre of the earth
+        V::D sinB = V::div(u, r);
+        V::D cosB = V::div(w, r);
+
+        V::D num = V::add(z, V::mul(V::set1(s.ep2*s.b), V::mul(sinB, V::mul(sinB, sinB))));
+        V::D den = V::sub(p, V::mul(V::set1(s.e2*s.a), V::mul(cosB, V::mul(cosB, cosB))));
+        lat = Atan2(num, den);
+        lon = Atan2(y, x);
+
+        r = V::sqrt(V::add(V::mul(num, num), V::mul(den, den)));
+        r = V::select(V::eq(r, zero), one, r);
+        V::D sinLat = V::div(num, r);
+        V::D cosLat = V::div(den, r);
+        V::D aOverN = V::mul(V::set1(s.a), V::sqrt(V::sub(one, V::mul(V::set1(s.e2),
+                                                                     V::mul(sinLat, sinLat)))));
+        h = V::sub(V::add(V::mul(p, cosLat), V::mul(z, sinLat)), aOverN);
+    }
+
+    /**
+     * Heights of a block, 0 without heights.
+     */
+    static inline V::D LoadHeight(const double *Height)
+    {
+        return Height ? V::loadu(Height) : V::set1(0.0);
+    }
+
+    static inline void ToEcefBlock(const Shape &s, const double *Lat, const double *Long,
+                                   const double *Height, double *X, double *Y, double *Z)
+    {
+        const V::D toRad = V::set1(DEG_TO_RAD);
+        V::D x, y, z;
+        ToEcef(s, V::mul(V::loadu(Lat), toRad), V::mul(V::loadu(Long), toRad), LoadHeight(Height),
+               x, y, z);
+        V::storeu(X, x);
+        V::storeu(Y, y);
+        V::storeu(Z, z);
+    }
+
+    static inline void FromEcefBlock(const Shape &s, const double *X, const double *Y,
+                                     const double *Z, double *Lat, double *Long, double *Height)
+    {
+        const V::D toDeg = V::set1(RAD_TO_DEG);
+        V::D lat, lon, h;
+        FromEcef(s, V::loadu(X), V::loadu(Y), V::loadu(Z), lat, lon, h);
+        V::storeu(Lat, V::mul(lat, toDeg));
+        V::storeu(Long, V::mul(lon, toDeg));
+        if(Height)
+            V::storeu(Height, h);
+    }
+
+    /**
+     * Datum transformation of V::width positions: ECEF on the source
+     * ellipsoid, the combined Helmert matrix, geodetic on the target.
+     * The output may be the input.
+     */
+    static inline void TransformBlock(const Affine &t, const double *Lat, const double *Long,
+                                      const double *Height, double *OutLat, double *OutLong,
+                                      double *OutHeight)
+    {
+        const V::D toRad = V::set1(DEG_TO_RAD);
+        const V::D toDeg = V::set1(RAD_TO_DEG);
+        const double *m = t.matrix;
+
+        V::D x, y, z;
+        ToEcef(t.source, V::mul(V::loadu(Lat), toRad), V::mul(V::loadu(Long), toRad),
+               LoadHeight(Height), x, y, z);
+
+        V::D tx = V::add(V::set1(t.translation[0]),
+                         V::add(V::mul(V::set1(m[0]), x), V::add(V::mul(V::set1(m[1]), y), V::mul(V::set1(m[2]), z))));
+        V::D ty = V::add(V::set1(t.translation[1]),
+                         V::add(V::mul(V::set1(m[3]), x), V::add(V::mul(V::set1(m[4]), y), V::mul(V::set1(m[5]), z))));
+        V::D tz = V::add(V::set1(t.translation[2]),
+                         V::add(V::mul(V::set1(m[6]), x), V::add(V::mul(V::set1(m[7]), y), V::mul(V::set1(m[8]), z))));
+
+        V::D lat, lon, h;
+        FromEcef(t.target, tx, ty, tz, lat, lon, h);
+        V::storeu(OutLat, V::mul(lat, toDeg));
+        V::storeu(OutLong, V::mul(lon, toDeg));
+        if(OutHeight)
+            V::storeu(OutHeight, h);
+    }
+
+    /**
+     * Block over count positions, the tail through a zero padded block.
+     * Each argument is an array of count doubles; the third input and
+     * output may be nullptr where the block takes that.
+     */
+    template<class P, void (*Block)(const P &, const double *, const double *, const double *,
+                                    double *, double *, double *)>
+    static inline void ForEachBlock(const P &p, std::size_t count,
+                                    const double *In0, const double *In1, const double *In2,
+                                    double *Out0, double *Out1, double *Out2)
+    {
+        std::size_t i = 0;
+        for(; i + V::width <= count; i += V::width) {
+            Block(p, In0 + i, In1 + i, In2 ? In2 + i : nullptr,
+                  Out0 + i, Out1 + i, Out2 ? Out2 + i : nullptr);
+        }
+        if(i == count)
+            return;
+
+        double in[3][V::width] = {}, out[3][V::width];
+        for(std::size_t k = 0; i + k < count; ++k) {
+            in[0][k] = In0[i + k];
+            in[1][k] = In1[i + k];
+            if(In2)
+                in[2][k] = In2[i + k];
+        }
+        Block(p, in[0], in[1], In2 ? in[2] : nullptr, out[0], out[1], Out2 ? out[2] : nullptr);
+        for(std::size_t k = 0; i + k < count; ++k) {
+            Out0[i + k] = out[0][k];
+            Out1[i + k] = out[1][k];
+            if(Out2)
+                Out2[i + k] = out[2][k];
+        }
+    }
@@ -0,0 +1,85 @@
+#ifndef FLOATTYPE_H
+#define FLOATTYPE_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+///
+/// \brief Structure to hold a floating point value as a whole and fraction part separately.
+///
+/// The whole part carries the sign and the fraction is always positive.
+/// Values between -1 and 0 have no sign in the whole part, isNegative()
+/// tells them apart from their positive counterparts.
+///
+struct FloatType
+{
+    FloatType(double value) { setValue(value); }
+    FloatType(int32_t whole, int32_t fraction, bool negative = false) { setValue(whole, fraction, negative); }
+
+    void setValue(double value) {
+        // use 6 digit precision, rounded like QString::number(value, 'f', 6)
+        double whole = std::trunc(value);
+        double rest = std::fabs(value - whole);
+        double fraction = std::floor(rest * 1000000.0);
+
+        // distance from the rounding midpoint; near a tie redo it exactly,
+        // and break exact ties to even
+        double half = rest * 1000000.0 - fraction - 0.5;
+        if( std::fabs(half) < 1e-6 ) {
+            half = std::fma(rest, 1000000.0, -(fraction + 0.5));
+            if( half == 0.0 )
+                half = std::fmod(fraction, 2.0) - 0.5;
+        }
+        if( half > 0 )
+            fraction += 1.0;
+
+        // rounding may carry into the whole part (e.g. 0.9999996)
+        if( fraction >= 1000000.0 ) {
+            fraction -= 1000000.0;
+            whole += (value < 0) ? -1.0 : 1.0;
+        }
+
+        // break into whole and fraction part
+        m_whole    = static_cast<int32_t>(whole);
+        m_fraction = static_cast<int32_t>(fraction);
+
+        // values rounding to zero lose their sign
+        m_negative = (value < 0) && (m_whole != 0 || m_fraction != 0);
+    }
+
+    // negative is only needed for values between -1 and 0 (whole == 0)
+    void setValue(int32_t whole, int32_t fraction, bool negative = false) {
+        // look for x33333, x66666, x99999 pattern in the 6 fraction digits
+        int32_t digits = std::abs(fraction % 1000000) % 100000;
+        if( digits == 33333 || digits == 66666 || digits == 99999 ) {
+            fraction += 1;
+        }
+
+        m_whole = whole;
+        m_fraction = fraction;
+        m_negative = (whole < 0) || (negative && whole == 0 && fraction != 0);
+    }
+
+    double getValue() const {
+        if( m_negative ) {
+            return (-double(std::abs(m_whole)) - (m_fraction/1000000.0));
+        } else {
+            return (double(m_whole) + (m_fraction/1000000.0));
+        }
+    }
+
+    void getValue(int32_t &whole, int32_t &fraction) const {
+        whole = m_whole;
+        fraction = m_fraction;
+    }
+
+    bool isNegative() const { return m_negative; }
+
+private:
+    int32_t m_whole;
+    int32_t m_fraction;
+    bool m_negative;
+};
+
+#endif // FLOATTYPE_H
@@ -0,0 +1,417 @@
+#include "geodesic.h"
+
+#include "utm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const double kA = UTM::WGS84::a;
+const double kF = UTM::WGS84::f;
+const double kOneMinusF = 1.0 - kF;
+const double kB = kA * kOneMinusF;
+const double kEp2 = (kA * kA - kB * kB) / (kB * kB);   // second eccentricity squared
+
+const double kPi = 3.14159265358979323846;
+const double kTwoPi = 6.28318530717958647692;
+
+// Vincenty's iteration stops when lambda moves less than this. Pairs not
+// converged after kVincentyIterations are nearly antipodal and solved by
+// solveByAzimuth().
+const double kVincentyTolerance = 1e-12;
+const int kVincentyIterations = 20;
+
+///
+/// \brief The position the distances of a batch are measured from.
+///
+struct Origin
+{
+    double latitudeDeg;
+    double longitudeDeg;
+    double latitude;        ///< radians
+    double longitude;       ///< radians
+    double sinLat;
+    double cosLat;
+    double sinU;            ///< reduced latitude
+    double cosU;
+};
+
+inline double wrapPi(double a)
+{
+    return a - kTwoPi * std::floor((a + kPi) / kTwoPi);
+}
+
+// radians to degrees in [0, 360)
+inline double bearingDegrees(double a)
+{
+    double d = a * RAD_TO_DEG;
+    if( d < 0 )
+        d += 360.0;
+    if( d >= 360.0 )
+        d -= 360.0;
+    return d;
+}
+
+// Reduced latitude U, tan U = (1 - f) tan(latitude)
+inline void reducedLatitude(double latitude, double &sinU, double &cosU)
+{
+    const double s = kOneMinusF * std::sin(latitude);
+    const double c = std::cos(latitude);
+    const double d = std::sqrt(c * c + s * s);
+    sinU = s / d;
+    cosU = c / d;
+}
+
+Origin makeOrigin(double latitude, double longitude)
+{
+    Origin o;
+    o.latitudeDeg = latitude;
+    o.longitudeDeg = longitude;
+    o.latitude = latitude * DEG_TO_RAD;
+    o.longitude = longitude * DEG_TO_RAD;
+    o.sinLat = std::sin(o.latitude);
+    o.cosLat = std::cos(o.latitude);
+    reducedLatitude(o.latitude, o.sinU, o.cosU);
+    return o;
+}
+
+// Vincenty's geodesic length from the auxiliary sphere arc sigma
+double geodesicLength(double cosSqAlpha, double sinSigma, double cosSigma, double sigma,
+                      double cos2SigmaM)
+{
+    const double uSq = cosSqAlpha * kEp2;
+    const double A = 1 + uSq / 16384 * (4096 + uSq * (-768 + uSq * (320 - 175 * uSq)));
+    const double B = uSq / 1024 * (256 + uSq * (-128 + uSq * (74 - 47 * uSq)));
+    const double c2 = cos2SigmaM * cos2SigmaM;
+    const double dSigma = B * sinSigma * (cos2SigmaM + B / 4 * (cosSigma * (2 * c2 - 1)
+                          - B / 6 * cos2SigmaM * (4 * sinSigma * sinSigma - 3) * (4 * c2 - 3)));
+    return kB * A * (sigma - dSigma);
+}
+
+// Vincenty's difference between the longitude on the auxiliary sphere and on the ellipsoid
+double lambdaCorrection(double sinAlpha, double cosSqAlpha, double sinSigma, double cosSigma,
+                        double sigma, double cos2SigmaM)
+{
+    const double C = kF / 16 * cosSqAlpha * (4 + kF * (4 - 3 * cosSqAlpha));
+    return (1 - C) * kF * sinAlpha
+            * (sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (2 * cos2SigmaM * cos2SigmaM - 1)));
+}
+
+///
+/// \brief Inverse problem for the pairs Vincenty's iteration does not solve.
+///
+/// After Karney (Algorithms for geodesics, 2013): with the positions
+/// arranged so that lat1 <= 0, |lat2| <= -lat1 and 0 <= L <= pi, the
+/// longitude at which the geodesic leaving lat1 with azimuth alpha1 first
+/// reaches lat2 grows with alpha1 over [0, pi], so alpha1 is found by
+/// bisection. Radians in; the Result bearings are in radians.
+///
+Geodesic::Result solveByAzimuth(double lat1, double lat2, double L)
+{
+    const bool swapped = std::fabs(lat1) < std::fabs(lat2);
+    if( swapped ) {
+        std::swap(lat1, lat2);
+        L = -L;
+    }
+    const bool mirrorLatitude = lat1 > 0;
+    if( mirrorLatitude ) {
+        lat1 = -lat1;
+        lat2 = -lat2;
+    }
+    const bool mirrorLongitude = L < 0;
+    if( mirrorLongitude )
+        L = -L;
+
+    double sinU1, cosU1, sinU2, cosU2;
+    reducedLatitude(lat1, sinU1, cosU1);
+    reducedLatitude(lat2, sinU2, cosU2);
+    sinU1 = -std::fabs(sinU1);      // -0 on the equator: sigma1 is -pi heading south
+    const double dCosSq = (cosU2 - cosU1) * (cosU2 + cosU1);
+
+    struct Path
+    {
+        double sigma, sinSigma, cosSigma, cosSqAlpha, cos2SigmaM;
+        double lambda;  ///< ellipsoid longitude reached
+        double alpha2;
+    };
+    auto path = [&](double alpha1) {
+        const double sinAlpha0 = std::sin(alpha1) * cosU1;
+        const double x1 = std::cos(alpha1) * cosU1;                 // cos(alpha1) cos(U1)
+        const double x2 = std::sqrt(std::max(0.0, x1 * x1 + dCosSq));  // cos(alpha2) cos(U2), northwards
+        const double sigma1 = std::atan2(sinU1, x1);
+        const double sigma2 = std::atan2(sinU2, x2);
+        const double omega = std::atan2(sinAlpha0 * sinU2, x2) - std::atan2(sinAlpha0 * sinU1, x1);
+
+        Path p;
+        p.sigma = sigma2 - sigma1;
+        p.sinSigma = std::sin(p.sigma);
+        p.cosSigma = std::cos(p.sigma);
+        p.cosSqAlpha = 1 - sinAlpha0 * sinAlpha0;
+        p.cos2SigmaM = std::cos(sigma1 + sigma2);
+        p.lambda = omega - lambdaCorrection(sinAlpha0, p.cosSqAlpha, p.sinSigma, p.cosSigma,
+                                            p.sigma, p.cos2SigmaM);
+        p.alpha2 = std::atan2(sinAlpha0, x2);
+        return p;
+    };
+
+    double lo = 0, hi = kPi;
+    for( int i = 0; i < 64; ++i ) {
+        const double mid = 0.5 * (lo + hi);
+        if( mid <= lo || mid >= hi )
+            break;
+        if( path(mid).lambda < L )
+            lo = mid;
+        else
+            hi = mid;
+    }
+    double alpha1 = 0.5 * (lo + hi);
+    const Path p = path(alpha1);
+    double alpha2 = p.alpha2;
+
+    if( mirrorLongitude ) {
+        alpha1 = -alpha1;
+        alpha2 = -alpha2;
+    }
+    if( mirrorLatitude ) {
+        alpha1 = kPi - alpha1;
+        alpha2 = kPi - alpha2;
+    }
+    if( swapped ) {
+        // travelled backwards
+        std::swap(alpha1, alpha2);
+        alpha1 += kPi;
+        alpha2 += kPi;
+    }
+
+    const double distance = geodesicLength(p.cosSqAlpha, p.sinSigma, p.cosSigma, p.sigma, p.cos2SigmaM);
+    return Geodesic::Result{distance, alpha1, alpha2};
+}
+
+#ifdef UTM_HAVE_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+namespace sse41
+{
+    typedef UTM::batch_detail::sse41::V V;
+    using UTM::batch_detail::sse41::SinCos;
+    using UTM::batch_detail::sse41::Atan2;
+#include "geodesic_kernel.h"
+} // namespace sse41
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace avx2
+{
+    typedef UTM::batch_detail::avx2::V V;
+    using UTM::batch_detail::avx2::SinCos;
+    using UTM::batch_detail::avx2::Atan2;
+#include "geodesic_kernel.h"
+} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // UTM_HAVE_X86_DISPATCH
+
+namespace scalar
+{
+    typedef UTM::batch_detail::scalar::V V;
+    using UTM::batch_detail::scalar::SinCos;
+    using UTM::batch_detail::scalar::Atan2;
+#include "geodesic_kernel.h"
+} // namespace scalar
+
+// Distances from o to count positions, on the calling thread
+void distancesFrom(const Origin &o, bool ellipsoid, const double *latitudes, const double *longitudes,
+                   std::size_t count, double *distance, double *bearing)
+{
+    switch( UTM::DetectSimdLevel() ) {
+#ifdef UTM_HAVE_X86_DISPATCH
+    case UTM::SIMD_AVX2:
+        avx2::DistancesChunk(o, ellipsoid, latitudes, longitudes, count, distance, bearing);
+        break;
+    case UTM::SIMD_SSE41:
+        sse41::DistancesChunk(o, ellipsoid, latitudes, longitudes, count, distance, bearing);
+        break;
+#endif
+    default:
+        scalar::DistancesChunk(o, ellipsoid, latitudes, longitudes, count, distance, bearing);
+        break;
+    }
+
+    if( !ellipsoid )
+        return;
+
+    // pairs the kernels left open: nearly antipodal or coincident
+    for( std::size_t i = 0; i < count; ++i ) {
+        if( !std::isnan(distance[i]) )
+            continue;
+        const Geodesic::Result r = Geodesic::inverse(o.latitudeDeg, o.longitudeDeg,
+                                                     latitudes[i], longitudes[i]);
+        distance[i] = r.distance;
+        if( bearing )
+            bearing[i] = r.initialBearing;
+    }
+}
+
+// work(begin, end) over [0, count), split over the calling thread and workers
+template<class Work>
+void parallelFor(std::size_t count, const Geodesic::Options &options, Work work)
+{
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = unsigned(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(count, 1)));
+    if( threads == 1 || count < options.parallelThreshold ) {
+        work(std::size_t(0), count);
+        return;
+    }
+
+    const std::size_t perThread = (count + threads - 1) / threads;
+    std::vector<std::thread> pool;
+    for( unsigned t = 1; t < threads; ++t ) {
+        const std::size_t begin = t * perThread;
+        if( begin >= count )
+            break;
+        pool.emplace_back(work, begin, std::min(begin + perThread, count));
+    }
+    work(std::size_t(0), std::min(perThread, count));
+
+    for( std::thread &t : pool )
+        t.join();
+}
+
+} // namespace
+
+namespace Geodesic
+{
+
+Result inverse(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    const double lat1 = latitude1 * DEG_TO_RAD;
+    const double lat2 = latitude2 * DEG_TO_RAD;
+    const double L = wrapPi((longitude2 - longitude1) * DEG_TO_RAD);
+
+    double sinU1, cosU1, sinU2, cosU2;
+    reducedLatitude(lat1, sinU1, cosU1);
+    reducedLatitude(lat2, sinU2, cosU2);
+
+    double lambda = L;
+    double sinLambda = 0, cosLambda = 1, sinSigma = 0, cosSigma = 1, sigma = 0;
+    double cosSqAlpha = 1, cos2SigmaM = 0, t1 = 0, t2 = 0;
+    bool converged = false;
+    for( int i = 0; i < kVincentyIterations && !converged; ++i ) {
+        sinLambda = std::sin(lambda);
+        cosLambda = std::cos(lambda);
+        t1 = cosU2 * sinLambda;
+        t2 = cosU1 * sinU2 - sinU1 * cosU2 * cosLambda;
+        sinSigma = std::sqrt(t1 * t1 + t2 * t2);
+        cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+        if( sinSigma == 0 ) {
+            if( cosSigma > 0 )
+                return Result{0, 0, 0};    // coincident
+            break;                          // pole to pole
+        }
+        sigma = std::atan2(sinSigma, cosSigma);
+
+        const double sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+        cosSqAlpha = 1 - sinAlpha * sinAlpha;
+        cos2SigmaM = (cosSqAlpha != 0) ? cosSigma - 2 * sinU1 * sinU2 / cosSqAlpha : 0;
+
+        const double previous = lambda;
+        lambda = L + lambdaCorrection(sinAlpha, cosSqAlpha, sinSigma, cosSigma, sigma, cos2SigmaM);
+        if( std::fabs(lambda) > kPi )
+            break;
+        converged = std::fabs(lambda - previous) < kVincentyTolerance;
+    }
+
+    if( !converged ) {
+        const Result r = solveByAzimuth(lat1, lat2, L);
+        return Result{r.distance, bearingDegrees(r.initialBearing), bearingDegrees(r.finalBearing)};
+    }
+
+    Result r;
+    r.distance = geodesicLength(cosSqAlpha, sinSigma, cosSigma, sigma, cos2SigmaM);
+    r.initialBearing = bearingDegrees(std::atan2(t1, t2));
+    r.finalBearing = bearingDegrees(std::atan2(cosU1 * sinLambda,
+                                               cosU1 * sinU2 * cosLambda - sinU1 * cosU2));
+    return r;
+}
+
+Result haversine(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    const double lat1 = latitude1 * DEG_TO_RAD;
+    const double lat2 = latitude2 * DEG_TO_RAD;
+    const double dLon = wrapPi((longitude2 - longitude1) * DEG_TO_RAD);
+    const double sinLat1 = std::sin(lat1), cosLat1 = std::cos(lat1);
+    const double sinLat2 = std::sin(lat2), cosLat2 = std::cos(lat2);
+    const double sinDLon = std::sin(dLon), cosDLon = std::cos(dLon);
+
+    const double sinHalfLat = std::sin((lat2 - lat1) * 0.5);
+    const double sinHalfLon = std::sin(dLon * 0.5);
+    const double h = sinHalfLat * sinHalfLat + cosLat1 * cosLat2 * sinHalfLon * sinHalfLon;
+
+    Result r;
+    r.distance = 2.0 * kMeanRadius * std::asin(std::sqrt(std::min(h, 1.0)));
+    r.initialBearing = bearingDegrees(std::atan2(sinDLon * cosLat2,
+                                                 cosLat1 * sinLat2 - sinLat1 * cosLat2 * cosDLon));
+    // the reverse course from the second position, turned around
+    r.finalBearing = bearingDegrees(std::atan2(-sinDLon * cosLat1,
+                                               cosLat2 * sinLat1 - sinLat2 * cosLat1 * cosDLon) + kPi);
+    return r;
+}
+
+void distances(double latitude, double longitude,
+               const double *latitudes, const double *longitudes, std::size_t count,
+               double *distance, double *bearing, const Options &options)
+{
+    const Origin o = makeOrigin(latitude, longitude);
+    const bool ellipsoid = (options.method == Method::eVINCENTY);
+    parallelFor(count, options, [&](std::size_t begin, std::size_t end) {
+        distancesFrom(o, ellipsoid, latitudes + begin, longitudes + begin, end - begin,
+                      distance + begin, bearing ? bearing + begin : nullptr);
+    });
+}
+
+void distanceMatrix(const double *originLatitudes, const double *originLongitudes,
+                    std::size_t originCount,
+                    const double *targetLatitudes, const double *targetLongitudes,
+                    std::size_t targetCount,
+                    double *distance, double *bearing, const Options &options)
+{
+    if( targetCount == 0 )
+        return;
+
+    const bool ellipsoid = (options.method == Method::eVINCENTY);
+    parallelFor(originCount * targetCount, options, [&](std::size_t begin, std::size_t end) {
+        // the range may start and end in the middle of a row
+        while( begin < end ) {
+            const std::size_t row = begin / targetCount;
+            const std::size_t column = begin % targetCount;
+            const std::size_t n = std::min(end - begin, targetCount - column);
+            const Origin o = makeOrigin(originLatitudes[row], originLongitudes[row]);
+            distancesFrom(o, ellipsoid, targetLatitudes + column, targetLongitudes + column, n,
+                          distance + begin, bearing ? bearing + begin : nullptr);
+            begin += n;
+        }
+    });
+}
+
+} // namespace Geodesic
@@ -0,0 +1,89 @@
+#ifndef GEODESIC_H
+#define GEODESIC_H
+
+#include <cstddef>
+
+///
+/// \brief Distance and bearing between positions, one pair or in bulk.
+///
+/// Two tiers:
+/// - eVINCENTY: geodesics on the WGS84 ellipsoid of utm.h (UTM::WGS84),
+///   Vincenty's inverse formula, about 0.5 mm. Nearly antipodal pairs,
+///   where Vincenty's iteration does not converge, are solved by bisection
+///   on the starting azimuth as in Karney's method.
+/// - eHAVERSINE: great circles on a sphere of kMeanRadius, the distances of
+///   PositionIndex. Up to about 0.5% off the ellipsoid, several times
+///   faster.
+///
+/// Positions are in degrees, distances in metres and bearings in degrees
+/// clockwise from north, in [0, 360).
+///
+/// The batch functions evaluate four (AVX2) or two (SSE4.1) pairs at once,
+/// and split large batches over worker threads.
+///
+namespace Geodesic
+{
+
+/// Radius of the haversine tier, the same as PositionIndex::kEarthRadius.
+const double kMeanRadius = 6371008.8;
+
+enum class Method {
+    eVINCENTY,      // WGS84 ellipsoid
+    eHAVERSINE      // sphere of kMeanRadius
+};
+
+struct Result
+{
+    double distance;        ///< metres
+    double initialBearing;  ///< at the first position
+    double finalBearing;    ///< at the second position, onward
+};
+
+///
+/// \brief Geodesic from the first to the second position on the WGS84 ellipsoid.
+///
+/// Coincident positions give a distance and bearings of 0.
+///
+Result inverse(double latitude1, double longitude1, double latitude2, double longitude2);
+
+///
+/// \brief Great circle from the first to the second position on a sphere of kMeanRadius.
+///
+Result haversine(double latitude1, double longitude1, double latitude2, double longitude2);
+
+struct Options
+{
+    Method method {Method::eVINCENTY};
+
+    /// Worker threads, 0 for std::thread::hardware_concurrency().
+    unsigned threads {};
+
+    /// Batches with fewer pairs run on the calling thread only.
+    std::size_t parallelThreshold {16384};
+};
+
+///
+/// \brief Distance and initial bearing from one position to count positions.
+///
+/// bearing may be nullptr. Gives the same values as inverse() (or
+/// haversine()) to well below a millimetre.
+///
+void distances(double latitude, double longitude,
+               const double *latitudes, const double *longitudes, std::size_t count,
+               double *distance, double *bearing, const Options &options);
+
+///
+/// \brief Distance and initial bearing from every origin to every target.
+///
+/// Row major: the pair (origin i, target j) is at i * targetCount + j of
+/// distance and bearing (which may be nullptr).
+///
+void distanceMatrix(const double *originLatitudes, const double *originLongitudes,
+                    std::size_t originCount,
+                    const double *targetLatitudes, const double *targetLongitudes,
+                    std::size_t targetCount,
+                    double *distance, double *bearing, const Options &options);
+
+} // namespace Geodesic
+
+#endif // GEODESIC_H
@@ -0,0 +1,207 @@
+/* -*- mode: C++ -*-
+ *
+ *  Batch kernels for the geodesic distances.
+ *
+ *  License: Modified BSD Software License Agreement
+ */
+
+/**  @file
+ @brief Vector-width agnostic distance and bearing kernels.
+
+ This file has no include guard on purpose. geodesic.cpp includes it once
+ per instruction set, inside a namespace that provides utm.h's vector type
+ `V`, `SinCos()` and `Atan2()` (see UTM::batch_detail), and under the
+ matching compiler target options. It must not be included from anywhere
+ else.
+
+ The ellipsoid constants and `Origin`, the position all distances of a
+ call are measured from, come from geodesic.cpp's anonymous namespace.
+ */
+
+    /**
+     * Angle wrapped into [-pi, pi).
+     */
+    static inline V::D WrapPi(V::D a)
+    {
+        V::D turns = V::floor(V::div(V::add(a, V::set1(kPi)), V::set1(kTwoPi)));
+        return V::sub(a, V::mul(turns, V::set1(kTwoPi)));
+    }
+
+    /**
+     * Bearing in degrees [0, 360) of an angle in radians.
+     */
+    static inline V::D BearingDegrees(V::D a)
+    {
+        const V::D full = V::set1(360.0);
+        V::D d = V::mul(a, V::set1(RAD_TO_DEG));
+        d = V::select(V::lt(d, V::set1(0.0)), V::add(d, full), d);
+        return V::select(V::lt(d, full), d, V::sub(d, full));
+    }
+
+    /**
+     * Great circle distance and initial bearing from the origin to
+     * V::width positions, as Geodesic::haversine().
+     */
+    static inline void HaversineBlock(const Origin &o, const double *Lat, const double *Long,
+                                      double *Distance, double *Bearing)
+    {
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+        const V::D half = V::set1(0.5);
+        const V::D toRad = V::set1(DEG_TO_RAD);
+
+        V::D lat = V::mul(V::loadu(Lat), toRad);
+        V::D dlon = WrapPi(V::sub(V::mul(V::loadu(Long), toRad), V::set1(o.longitude)));
+
+        V::D sinLat, cosLat, sinHalfLat, cosHalfLat, sinHalfLon, cosHalfLon;
+        SinCos(lat, sinLat, cosLat);
+        SinCos(V::mul(V::sub(lat, V::set1(o.latitude)), half), sinHalfLat, cosHalfLat);
+        SinCos(V::mul(dlon, half), sinHalfLon, cosHalfLon);
+
+        V::D h = V::add(V::mul(sinHalfLat, sinHalfLat),
+                        V::mul(V::mul(V::set1(o.cosLat), cosLat), V::mul(sinHalfLon, sinHalfLon)));
+        h = V::select(V::lt(one, h), one, h);
+        V::storeu(Distance, V::mul(V::set1(2*Geodesic::kMeanRadius),
+                                   Atan2(V::sqrt(h), V::sqrt(V::sub(one, h)))));
+
+        if(Bearing) {
+            V::D sinLon = V::mul(two, V::mul(sinHalfLon, cosHalfLon));
+            V::D cosLon = V::sub(one, V::mul(two, V::mul(sinHalfLon, sinHalfLon)));
+            V::D y = V::mul(sinLon, cosLat);
+            V::D x = V::sub(V::mul(V::set1(o.cosLat), sinLat),
+                            V::mul(V::mul(V::set1(o.sinLat), cosLat), cosLon));
+            V::storeu(Bearing, BearingDegrees(Atan2(y, x)));
+        }
+    }
+
+    /**
+     * Geodesic distance and initial bearing from the origin to V::width
+     * positions, as Geodesic::inverse().
+     *
+     * Iterates all lanes until none moves by more than the tolerance, at
+     * most kVincentyIterations times. Lanes that have not converged by then
+     * (nearly antipodal pairs) and coincident positions get a NaN distance,
+     * for the caller to solve one by one.
+     */
+    static inline void VincentyBlock(const Origin &o, const double *Lat, const double *Long,
+                                     double *Distance, double *Bearing)
+    {
+        const V::D zero = V::set1(0.0);
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+        const V::D three = V::set1(3.0);
+        const V::D four = V::set1(4.0);
+        const V::D f = V::set1(kF);
+        const V::D toRad = V::set1(DEG_TO_RAD);
+
+        V::D lat = V::mul(V::loadu(Lat), toRad);
+        V::D L = WrapPi(V::sub(V::mul(V::loadu(Long), toRad), V::set1(o.longitude)));
+
+        // reduced latitude
+        V::D s, c;
+        SinCos(lat, s, c);
+        s = V::mul(V::set1(kOneMinusF), s);
+        V::D d = V::sqrt(V::add(V::mul(c, c), V::mul(s, s)));
+        V::D sinU2 = V::div(s, d);
+        V::D cosU2 = V::div(c, d);
+
+        V::D sinU1sinU2 = V::mul(V::set1(o.sinU), sinU2);
+        V::D cosU1cosU2 = V::mul(V::set1(o.cosU), cosU2);
+        V::D cosU1sinU2 = V::mul(V::set1(o.cosU), sinU2);
+        V::D sinU1cosU2 = V::mul(V::set1(o.sinU), cosU2);
+
+        V::D lambda = L;
+        V::D lambdaPrev = L;
+        V::D t1 = zero, t2 = zero, sinSigma = zero, cosSigma = zero, sigma = zero;
+        V::D cosSqAlpha = zero, cos2SigmaM = zero;
+        for(int i = 0; i < kVincentyIterations; ++i) {
+            V::D sinLambda, cosLambda;
+            SinCos(lambda, sinLambda, cosLambda);
+            t1 = V::mul(cosU2, sinLambda);
+            t2 = V::sub(cosU1sinU2, V::mul(sinU1cosU2, cosLambda));
+            sinSigma = V::sqrt(V::add(V::mul(t1, t1), V::mul(t2, t2)));
+            cosSigma = V::add(sinU1sinU2, V::mul(cosU1cosU2, cosLambda));
+            sigma = Atan2(sinSigma, cosSigma);
+
+            V::D sinAlpha = V::div(V::mul(cosU1cosU2, sinLambda), sinSigma);
+            cosSqAlpha = V::sub(one, V::mul(sinAlpha, sinAlpha));
+            cos2SigmaM = V::select(V::eq(cosSqAlpha, zero), zero,
+                                   V::sub(cosSigma, V::div(V::mul(two, sinU1sinU2), cosSqAlpha)));
+
+            // C = f/16 cos^2(alpha) (4 + f (4 - 3 cos^2(alpha)))
+            V::D C = V::mul(V::mul(V::set1(kF/16), cosSqAlpha),
+                            V::add(four, V::mul(f, V::sub(four, V::mul(three, cosSqAlpha)))));
+            V::D inner = V::add(cos2SigmaM, V::mul(V::mul(C, cosSigma),
+                                                   V::sub(V::mul(two, V::mul(cos2SigmaM, cos2SigmaM)), one)));
+            lambdaPrev = lambda;
+            lambda = V::add(L, V::mul(V::mul(V::sub(one, C), V::mul(f, sinAlpha)),
+                                      V::add(sigma, V::mul(V::mul(C, sinSigma), inner))));
+
+            // NaN lanes compare false and do not hold the others back
+            if(V::none(V::lt(V::set1(kVincentyTolerance), V::abs(V::sub(lambda, lambdaPrev)))))
+                break;
+        }
+
+        // Vincenty's length, u^2 = cos^2(alpha) e'^2
+        V::D uSq = V::mul(cosSqAlpha, V::set1(kEp2));
+        V::D A = V::add(V::set1(320.0), V::mul(uSq, V::set1(-175.0)));
+        A = V::add(V::set1(-768.0), V::mul(uSq, A));
+        A = V::add(V::set1(4096.0), V::mul(uSq, A));
+        A = V::add(one, V::mul(V::mul(uSq, V::set1(1.0/16384)), A));
+        V::D B = V::add(V::set1(74.0), V::mul(uSq, V::set1(-47.0)));
+        B = V::add(V::set1(-128.0), V::mul(uSq, B));
+        B = V::add(V::set1(256.0), V::mul(uSq, B));
+        B = V::mul(V::mul(uSq, V::set1(1.0/1024)), B);
+
+        V::D c2 = V::mul(cos2SigmaM, cos2SigmaM);
+        V::D dSigma = V::sub(V::mul(cosSigma, V::sub(V::mul(two, c2), one)),
+                             V::mul(V::mul(V::div(B, V::set1(6.0)), cos2SigmaM),
+                                    V::mul(V::sub(V::mul(four, V::mul(sinSigma, sinSigma)), three),
+                                           V::sub(V::mul(four, c2), three))));
+        dSigma = V::mul(V::mul(B, sinSigma), V::add(cos2SigmaM, V::mul(V::div(B, four), dSigma)));
+        V::D distance = V::mul(V::set1(kB), V::mul(A, V::sub(sigma, dSigma)));
+
+        // open lanes (also NaN: coincident positions) are left to the caller
+        const V::D open = V::set1(std::numeric_limits<double>::quiet_NaN());
+        distance = V::select(V::lt(V::abs(V::sub(lambda, lambdaPrev)), V::set1(kVincentyTolerance)),
+                             distance, open);
+        distance = V::select(V::lt(V::set1(kPi), V::abs(lambda)), open, distance);
+        V::storeu(Distance, distance);
+
+        if(Bearing)
+            V::storeu(Bearing, BearingDegrees(Atan2(t1, t2)));
+    }
+
+    /**
+     * Run HaversineBlock() or VincentyBlock() over count positions,
+     * padding the last partial block.
+     */
+    static inline void DistancesChunk(const Origin &o, bool ellipsoid,
+                                      const double *Lat, const double *Long, std::size_t count,
+                                      double *Distance, double *Bearing)
+    {
+        std::size_t i = 0;
+        for(; i + V::width <= count; i += V::width) {
+            if(ellipsoid)
+                VincentyBlock(o, Lat + i, Long + i, Distance + i, Bearing ? Bearing + i : nullptr);
+            else
+                HaversineBlock(o, Lat + i, Long + i, Distance + i, Bearing ? Bearing + i : nullptr);
+        }
+        if(i == count)
+            return;
+
+        double lat[V::width] = {}, lon[V::width] = {}, dist[V::width], bear[V::width];
+        for(std::size_t k = 0; i + k < count; ++k) {
+            lat[k] = Lat[i + k];
+            lon[k] = Long[i + k];
+        }
+        if(ellipsoid)
+            VincentyBlock(o, lat, lon, dist, Bearing ? bear : nullptr);
+        else
+            HaversineBlock(o, lat, lon, dist, Bearing ? bear : nullptr);
+        for(std::size_t k = 0; i + k < count; ++k) {
+            Distance[i + k] = dist[k];
+            if(Bearing)
+                Bearing[i + k] = bear[k];
+        }
+    }
@@ -0,0 +1,35 @@
+# Qt-free coordinate core: position types, formatters, parsers and the
+# UTM conversions. Usable without the widget, e.g. from backend services.
+
+TEMPLATE = lib
+CONFIG += staticlib c++17 thread
+CONFIG -= qt
+
+TARGET = latloncore
+
+HEADERS += \
+    datum.h \
+    datum_kernel.h \
+    floattype.h \
+    geodesic.h \
+    geodesic_kernel.h \
+    latlonexport.h \
+    latlonformat.h \
+    latlonparser.h \
+    nmeaparser.h \
+    positionarray.h \
+    positionindex.h \
+    positionslot.h \
+    utm.h \
+    utm_kernel.h
+
+SOURCES += \
+    datum.cpp \
+    geodesic.cpp \
+    latlonexport.cpp \
+    latlonformat.cpp \
+    latlonparser.cpp \
+    nmeaparser.cpp \
+    positionarray.cpp \
+    positionindex.cpp \
+    positionslot.cpp
@@ -0,0 +1,135 @@
+#include "latlonexport.h"
+
+#include "floattype.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LatLonExport
+{
+
+char *formatLine(char *out, const Position &position, const Options &options)
+{
+    // go through FloatType like LatLonWidget::setPosition does, so the
+    // text (and the rounding before the UTM conversion) is the same
+    FloatType latitude(position.latitude);
+    FloatType longitude(position.longitude);
+
+    if( options.format == LatLonFormat::eUTM ) {
+        char easting[LatLonFormat::kMaxTextSize];
+        LatLonFormat::UTMTextEnd end = LatLonFormat::formatUTM(out, easting,
+                                                               latitude.getValue(),
+                                                               longitude.getValue(),
+                                                               options.engine);
+        out = end.northing;
+        *out++ = options.separator;
+        std::size_t n = std::size_t(end.easting - easting);
+        std::memcpy(out, easting, n);
+        out += n;
+    } else {
+        out = LatLonFormat::format(out, options.format, LatLonFormat::eLATITUDE,
+                                   options.notation, latitude);
+        *out++ = options.separator;
+        out = LatLonFormat::format(out, options.format, LatLonFormat::eLONGITUDE,
+                                   options.notation, longitude);
+    }
+    *out++ = '\n';
+    return out;
+}
+
+bool exportPositions(const Position *positions, std::size_t count,
+                     const Options &options, const Sink &sink)
+{
+    if( count == 0 )
+        return true;
+
+    const std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = unsigned(std::min<std::size_t>(std::max(threads, 1u), chunks));
+
+    // Workers may run this many chunks ahead of the sink; each chunk in
+    // flight owns one slot buffer, reused once the sink has consumed it.
+    const std::size_t window = std::size_t(threads) * 2;
+
+    struct Slot
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size {};
+        bool ready {};
+    };
+    std::vector<Slot> slots(std::min(window, chunks));
+    for( Slot &slot : slots )
+        slot.data.reset(new char[chunkSize * kMaxLineSize]);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t nextChunk = 0;
+    std::size_t written = 0;
+    bool stop = false;
+
+    auto worker = [&]() {
+        for( ;; ) {
+            std::size_t chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() {
+                    return stop || nextChunk >= chunks || nextChunk < written + slots.size();
+                });
+                if( stop || nextChunk >= chunks )
+                    return;
+                chunk = nextChunk++;
+            }
+
+            Slot &slot = slots[chunk % slots.size()];
+            const std::size_t first = chunk * chunkSize;
+            const std::size_t last = std::min(first + chunkSize, count);
+            char *out = slot.data.get();
+            for( std::size_t i = first; i < last; ++i )
+                out = formatLine(out, positions[i], options);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.size = std::size_t(out - slot.data.get());
+                slot.ready = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for( unsigned i = 0; i < threads; ++i )
+        pool.emplace_back(worker);
+
+    // hand the chunks to the sink in order on the calling thread
+    bool ok = true;
+    for( std::size_t chunk = 0; chunk < chunks && ok; ++chunk ) {
+        Slot &slot = slots[chunk % slots.size()];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return slot.ready; });
+        }
+
+        ok = sink(slot.data.get(), slot.size);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.ready = false;
+            ++written;
+            stop = !ok;
+        }
+        changed.notify_all();
+    }
+
+    for( std::thread &t : pool )
+        t.join();
+    return ok;
+}
+
+} // namespace LatLonExport
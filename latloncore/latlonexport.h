@@ -0,0 +1,71 @@
+#ifndef LATLONEXPORT_H
+#define LATLONEXPORT_H
+
+#include "latlonformat.h"
+
+#include <cstddef>
+#include <functional>
+
+///
+/// \brief Bulk export of positions as text, in the formats LatLonWidget shows.
+///
+/// The input is split into chunks that are formatted in parallel on a pool
+/// of worker threads, each into its own reusable buffer, and handed to the
+/// sink in input order. The text of every position is byte-identical to the
+/// widget's display (UTF-8).
+///
+namespace LatLonExport
+{
+
+///
+/// \brief One input position in decimal degrees.
+///
+/// Plain data, so a memory-mapped file of (latitude, longitude) double
+/// pairs can be passed directly.
+///
+struct Position
+{
+    double latitude;
+    double longitude;
+};
+
+struct Options
+{
+    LatLonFormat::PositionFormatType format {LatLonFormat::eDECIMAL_DEG};
+    LatLonFormat::NotationType notation {LatLonFormat::NotationType::eSIGN};
+    LatLonFormat::UTMEngineType engine {LatLonFormat::UTMEngineType::eFAST};
+
+    /// Between the latitude (northing) and longitude (easting) text.
+    char separator {'\t'};
+
+    /// Worker threads, 0 for std::thread::hardware_concurrency().
+    unsigned threads {};
+
+    /// Positions formatted per work item.
+    std::size_t chunkSize {16384};
+};
+
+/// Receives the text in input order; return false to stop the export.
+typedef std::function<bool(const char *data, std::size_t size)> Sink;
+
+/// Longest line written for one position, including the newline.
+const std::size_t kMaxLineSize = 2 * LatLonFormat::kMaxTextSize + 2;
+
+///
+/// \brief Format one position as "<lat><separator><lon>\n".
+///
+/// Writes at most kMaxLineSize bytes and returns the end of the line.
+///
+char *formatLine(char *out, const Position &position, const Options &options);
+
+///
+/// \brief Format count positions and pass the text to sink.
+///
+/// Returns false if the sink stopped the export.
+///
+bool exportPositions(const Position *positions, std::size_t count,
+                     const Options &options, const Sink &sink);
+
+} // namespace LatLonExport
+
+#endif // LATLONEXPORT_H
@@ -0,0 +1,264 @@
+#include "latlonformat.h"
+
+#include "floattype.h"
+#include "utm.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+namespace LatLonFormat
+{
+
+namespace {
+
+char *writeString(char *out, const char *s)
+{
+    std::size_t n = std::strlen(s);
+    std::memcpy(out, s, n);
+    return out + n;
+}
+
+// U+00B0 in UTF-8 and UTF-16
+char *writeDegreeSign(char *out)
+{
+    *out++ = '\xC2';
+    *out++ = '\xB0';
+    return out;
+}
+
+char16_t *writeDegreeSign(char16_t *out)
+{
+    *out++ = u'\u00B0';
+    return out;
+}
+
+// Sign or direction and the space after it, "+", "-", "N ", "S ", "E " or "W "
+template<ValueType T, NotationType N, class Char>
+Char *writePrefix(Char *out, bool negative)
+{
+    if( N == NotationType::eSIGN ) {
+        *out++ = negative ? Char('-') : Char('+');
+        return out;
+    }
+    if( T == eLATITUDE )
+        *out++ = negative ? Char('S') : Char('N');
+    else
+        *out++ = negative ? Char('W') : Char('E');
+    *out++ = Char(' ');
+    return out;
+}
+
+constexpr uint32_t powerOfTen(int n)
+{
+    return n == 0 ? 1 : 10 * powerOfTen(n - 1);
+}
+
+// Exactly Width digits of value, zero padded
+template<int Width, class Char>
+Char *writeDigits(Char *out, uint32_t value)
+{
+    for( int i = Width - 1; i >= 0; --i ) {
+        out[i] = Char('0' + value % 10);
+        value /= 10;
+    }
+    return out + Width;
+}
+
+// At least Width digits of value, zero padded ("%0*u")
+template<int Width, class Char>
+Char *writeUnsigned(Char *out, uint32_t value)
+{
+    if( value < powerOfTen(Width) )
+        return writeDigits<Width>(out, value);
+
+    // only degrees beyond the axis range take more than Width digits
+    int n = Width + 1;
+    for( uint32_t rest = value / powerOfTen(n); rest > 0; rest /= 10 )
+        ++n;
+    for( int i = n - 1; i >= 0; --i ) {
+        out[i] = Char('0' + value % 10);
+        value /= 10;
+    }
+    return out + n;
+}
+
+// Fixed notation, zero padded to width after the sign ("%0*.*f")
+char *writeFixed(char *out, double value, int width, int precision)
+{
+    char tmp[348];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value,
+                                           std::chars_format::fixed, precision);
+    const char *digits = tmp;
+    if( *digits == '-' ) {
+        *out++ = *digits++;
+        --width;
+    }
+    for( int pad = width - int(r.ptr - digits); pad > 0; --pad )
+        *out++ = '0';
+    std::memcpy(out, digits, std::size_t(r.ptr - digits));
+    return out + (r.ptr - digits);
+}
+
+template<class Char>
+Char *dispatch(Char *out, PositionFormatType posFormat, ValueType type,
+               NotationType notation, const FloatType &value)
+{
+    typedef Char *(*Formatter)(Char *, const FloatType &);
+
+    // [format][value type][notation]
+    static const Formatter formatters[2][2][2] = {
+        { { formatAs<eDECIMAL_DEG, eLATITUDE, NotationType::eSIGN, Char>,
+            formatAs<eDECIMAL_DEG, eLATITUDE, NotationType::eDIRECTION, Char> },
+          { formatAs<eDECIMAL_DEG, eLONGITUDE, NotationType::eSIGN, Char>,
+            formatAs<eDECIMAL_DEG, eLONGITUDE, NotationType::eDIRECTION, Char> } },
+        { { formatAs<eDMS, eLATITUDE, NotationType::eSIGN, Char>,
+            formatAs<eDMS, eLATITUDE, NotationType::eSIGN, Char> },
+          { formatAs<eDMS, eLONGITUDE, NotationType::eSIGN, Char>,
+            formatAs<eDMS, eLONGITUDE, NotationType::eSIGN, Char> } }
+    };
+    if( posFormat != eDECIMAL_DEG && posFormat != eDMS )
+        return out;
+    return formatters[posFormat][type][notation == NotationType::eSIGN ? 0 : 1](out, value);
+}
+
+} // namespace
+
+template<PositionFormatType F, ValueType T, NotationType N, class Char>
+Char *formatAs(Char *out, const FloatType &value)
+{
+    static_assert(F == eDECIMAL_DEG || F == eDMS, "UTM text needs both axes, see formatUTM()");
+    const int kDegreeWidth = (T == eLATITUDE) ? 2 : 3;
+
+    int32_t whole, fraction;
+    value.getValue(whole, fraction);
+
+    if( F == eDECIMAL_DEG ) {
+        // whole and millionths carry into each other exactly as rounding the
+        // value to 6 digits would (e.g. a fraction of 1000000)
+        const uint64_t micro = uint64_t(std::abs(int64_t(whole))) * 1000000 + uint64_t(fraction);
+
+        out = writePrefix<T, N>(out, value.isNegative());
+        out = writeUnsigned<kDegreeWidth>(out, uint32_t(micro / 1000000));
+        *out++ = Char('.');
+        out = writeDigits<6>(out, uint32_t(micro % 1000000));
+        return writeDegreeSign(out);
+    }
+
+    // The seconds in 1/10000 s are exact: a millionth of a degree is
+    // 0.0036". Their last two digits are a multiple of 4, never 50, so
+    // rounding to 1/100 s has no ties and matches rounding the double
+    // the seconds used to be computed in.
+    const int32_t min = (fraction * 6) / 100000;
+    const int64_t secondsE4 = int64_t(fraction) * 36 - int64_t(min) * 600000;
+    const uint32_t centiseconds = uint32_t((secondsE4 + 50) / 100);
+
+    out = writePrefix<T, NotationType::eDIRECTION>(out, value.isNegative());
+    out = writeUnsigned<kDegreeWidth>(out, uint32_t(std::abs(int64_t(whole))));
+    out = writeDegreeSign(out);
+    *out++ = Char(' ');
+    out = writeUnsigned<2>(out, uint32_t(min));
+    *out++ = Char('\'');
+    *out++ = Char(' ');
+    out = writeUnsigned<2>(out, centiseconds / 100);
+    *out++ = Char('.');
+    out = writeDigits<2>(out, centiseconds % 100);
+    *out++ = Char('"');
+    return out;
+}
+
+#define LATLONFORMAT_INSTANTIATE(F, T, Char) \
+    template Char *formatAs<F, T, NotationType::eSIGN, Char>(Char *, const FloatType &); \
+    template Char *formatAs<F, T, NotationType::eDIRECTION, Char>(Char *, const FloatType &);
+
+LATLONFORMAT_INSTANTIATE(eDECIMAL_DEG, eLATITUDE, char)
+LATLONFORMAT_INSTANTIATE(eDECIMAL_DEG, eLONGITUDE, char)
+LATLONFORMAT_INSTANTIATE(eDMS, eLATITUDE, char)
+LATLONFORMAT_INSTANTIATE(eDMS, eLONGITUDE, char)
+LATLONFORMAT_INSTANTIATE(eDECIMAL_DEG, eLATITUDE, char16_t)
+LATLONFORMAT_INSTANTIATE(eDECIMAL_DEG, eLONGITUDE, char16_t)
+LATLONFORMAT_INSTANTIATE(eDMS, eLATITUDE, char16_t)
+LATLONFORMAT_INSTANTIATE(eDMS, eLONGITUDE, char16_t)
+
+#undef LATLONFORMAT_INSTANTIATE
+
+char *formatDecimalDeg(char *out, const FloatType &value, ValueType type, NotationType notation)
+{
+    return dispatch(out, eDECIMAL_DEG, type, notation, value);
+}
+
+char *formatDMS(char *out, const FloatType &value, ValueType type)
+{
+    return dispatch(out, eDMS, type, NotationType::eDIRECTION, value);
+}
+
+char *format(char *out, PositionFormatType posFormat, ValueType type,
+             NotationType notation, const FloatType &value)
+{
+    return dispatch(out, posFormat, type, notation, value);
+}
+
+char16_t *format(char16_t *out, PositionFormatType posFormat, ValueType type,
+                 NotationType notation, const FloatType &value)
+{
+    return dispatch(out, posFormat, type, notation, value);
+}
+
+static_assert(int(UTMEngineType::eFAST) == UTM::ENGINE_FAST &&
+              int(UTMEngineType::ePRECISE) == UTM::ENGINE_PRECISE &&
+              int(UTMEngineType::eTABLE) == UTM::ENGINE_TABLE, "UTM engine enums differ");
+
+UTMTextEnd formatUTM(char *northing, char *easting, double latitude, double longitude,
+                     UTMEngineType engine)
+{
+    double n, e;
+    UTM::UtmZone zone;
+    UTM::LLtoUTM(latitude, longitude, n, e, zone, static_cast<UTM::Engine>(engine));
+    return formatUTMGrid(northing, easting, zone, n, e);
+}
+
+UTMTextEnd formatUTMGrid(char *northingText, char *eastingText, const UTM::UtmZone &zone,
+                         double northing, double easting)
+{
+    UTMTextEnd end;
+    end.northing = UTM::FormatUTMZone(northingText, zone);
+    *end.northing++ = ' ';
+    end.northing = writeFixed(end.northing, northing, 6, 0);
+    end.northing = writeString(end.northing, " m");
+
+    end.easting = writeFixed(eastingText, easting, 6, 0);
+    end.easting = writeString(end.easting, " m");
+    return end;
+}
+
+std::string formatDecimalDeg(const FloatType &value, ValueType type, NotationType notation)
+{
+    char buf[kMaxTextSize];
+    return std::string(buf, formatDecimalDeg(buf, value, type, notation));
+}
+
+std::string formatDMS(const FloatType &value, ValueType type)
+{
+    char buf[kMaxTextSize];
+    return std::string(buf, formatDMS(buf, value, type));
+}
+
+std::string format(PositionFormatType posFormat, ValueType type,
+                   NotationType notation, const FloatType &value)
+{
+    char buf[kMaxTextSize];
+    return std::string(buf, format(buf, posFormat, type, notation, value));
+}
+
+UTMText formatUTM(double latitude, double longitude, UTMEngineType engine)
+{
+    char northing[kMaxTextSize], easting[kMaxTextSize];
+    UTMTextEnd end = formatUTM(northing, easting, latitude, longitude, engine);
+
+    UTMText text;
+    text.northing.assign(northing, end.northing);
+    text.easting.assign(easting, end.easting);
+    return text;
+}
+
+} // namespace LatLonFormat
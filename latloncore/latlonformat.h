@@ -0,0 +1,111 @@
+#ifndef LATLONFORMAT_H
+#define LATLONFORMAT_H
+
+#include <cstddef>
+#include <string>
+
+struct FloatType;
+
+namespace UTM { struct UtmZone; }
+
+///
+/// \brief Text formatting of positions, as shown by LatLonWidget.
+///
+/// Output is UTF-8 (the degree sign is U+00B0). The enums mirror the ones in
+/// LatLonWidget and have the same values.
+///
+namespace LatLonFormat
+{
+
+enum PositionFormatType {
+    eDECIMAL_DEG,
+    eDMS,
+    eUTM
+};
+
+enum ValueType {
+    eLATITUDE,
+    eLONGITUDE
+};
+
+enum class NotationType {
+    eSIGN,
+    eDIRECTION
+};
+
+/// Transverse Mercator series used for UTM, see UTM::Engine.
+enum class UTMEngineType {
+    eFAST,
+    ePRECISE,
+    eTABLE
+};
+
+///
+/// \brief Northing (with zone) and easting text of one position.
+///
+struct UTMText
+{
+    std::string northing;   ///< "33U 5000000 m"
+    std::string easting;    ///< "500000 m"
+};
+
+/// Enough room for any text written by the char* formatters below.
+const std::size_t kMaxTextSize = 32;
+
+///
+/// \brief End of the northing and easting text written by formatUTM(char *, char *, ...).
+///
+struct UTMTextEnd
+{
+    char *northing;
+    char *easting;
+};
+
+// The char* formatters write into a caller provided buffer of at least
+// kMaxTextSize bytes, without a terminating nul, and return the end of
+// the text. They do not allocate.
+
+char *formatDecimalDeg(char *out, const FloatType &value, ValueType type, NotationType notation);
+char *formatDMS(char *out, const FloatType &value, ValueType type);
+char *format(char *out, PositionFormatType posFormat, ValueType type,
+             NotationType notation, const FloatType &value);
+UTMTextEnd formatUTM(char *northing, char *easting, double latitude, double longitude,
+                     UTMEngineType engine = UTMEngineType::eFAST);
+
+/// Text of UTM coordinates already projected, on any ellipsoid.
+UTMTextEnd formatUTMGrid(char *northingText, char *eastingText, const UTM::UtmZone &zone,
+                         double northing, double easting);
+
+/// UTF-16 text for QString, which takes it without decoding.
+char16_t *format(char16_t *out, PositionFormatType posFormat, ValueType type,
+                 NotationType notation, const FloatType &value);
+
+///
+/// \brief Decimal degree or DMS text with the format, axis and notation
+/// fixed at compile time.
+///
+/// What the runtime formatters above dispatch to: the prefix and field
+/// widths are constants and all digits come from integer arithmetic on the
+/// FloatType's whole and millionths. Char is char (UTF-8) or char16_t
+/// (UTF-16); DMS ignores the notation. Instantiated in latlonformat.cpp
+/// for eDECIMAL_DEG and eDMS only.
+///
+template<PositionFormatType F, ValueType T, NotationType N, class Char>
+Char *formatAs(Char *out, const FloatType &value);
+
+/// "+12.345678°" or "N 12.345678°" depending on the notation.
+std::string formatDecimalDeg(const FloatType &value, ValueType type, NotationType notation);
+
+/// "N 12° 34' 56.78\""
+std::string formatDMS(const FloatType &value, ValueType type);
+
+/// Decimal degree or DMS text; empty for eUTM, which needs both axes.
+std::string format(PositionFormatType posFormat, ValueType type,
+                   NotationType notation, const FloatType &value);
+
+UTMText formatUTM(double latitude, double longitude,
+                  UTMEngineType engine = UTMEngineType::eFAST);
+
+} // namespace LatLonFormat
+
+#endif // LATLONFORMAT_H
@@ -0,0 +1,246 @@
+#include "latlonparser.h"
+
+#include <type_traits>
+
+namespace LatLonParser
+{
+
+namespace {
+
+///
+/// \brief Read position within the text being parsed.
+///
+/// CharT is char16_t for UTF-16 or char for UTF-8 text. Everything but the
+/// degree sign is ASCII, so only expectDegree() cares about the encoding.
+///
+template <typename CharT>
+struct Cursor
+{
+    explicit Cursor(std::basic_string_view<CharT> t) : text(t) {}
+
+    bool atEnd() const { return pos >= int(text.size()); }
+    unsigned peek() const
+    {
+        return atEnd() ? 0 : unsigned(std::make_unsigned_t<CharT>(text[pos]));
+    }
+
+    bool accept(unsigned c)
+    {
+        if( peek() != c )
+            return false;
+        ++pos;
+        return true;
+    }
+
+    // Set an error at the current position, returns false for convenience
+    bool fail(ErrorType e)
+    {
+        error = e;
+        return false;
+    }
+
+    bool expect(unsigned c)
+    {
+        if( accept(c) )
+            return true;
+        return fail(atEnd() ? eUNEXPECTED_END : eEXPECTED_SEPARATOR);
+    }
+
+    bool expectDegree();
+
+    // Read between 1 and maxDigits decimal digits
+    bool digits(int maxDigits, int32_t &value, int &count)
+    {
+        value = 0;
+        count = 0;
+        while( !atEnd() && peek() >= '0' && peek() <= '9' ) {
+            if( count == maxDigits )
+                return fail(eTOO_MANY_DIGITS);
+            value = value * 10 + (peek() - '0');
+            ++count;
+            ++pos;
+        }
+        if( count == 0 )
+            return fail(atEnd() ? eUNEXPECTED_END : eEXPECTED_DIGIT);
+        return true;
+    }
+
+    bool finish()
+    {
+        return atEnd() || fail(eTRAILING_TEXT);
+    }
+
+    std::basic_string_view<CharT> text;
+    int pos {};
+    ErrorType error {eNO_ERROR};
+};
+
+template <>
+bool Cursor<char16_t>::expectDegree()
+{
+    return expect(0x00B0);
+}
+
+template <>
+bool Cursor<char>::expectDegree()
+{
+    // U+00B0 in UTF-8
+    if( peek() == 0xC2 && pos + 1 < int(text.size()) && unsigned((unsigned char)text[pos + 1]) == 0xB0 ) {
+        pos += 2;
+        return true;
+    }
+    return fail(atEnd() ? eUNEXPECTED_END : eEXPECTED_SEPARATOR);
+}
+
+bool isNegativeDirection(unsigned c)
+{
+    return c == 'S' || c == 's' || c == 'W' || c == 'w';
+}
+
+bool isDirection(unsigned c)
+{
+    return c == 'N' || c == 'n' || c == 'E' || c == 'e' || isNegativeDirection(c);
+}
+
+template <typename Result, typename CharT>
+Result failed(const Cursor<CharT> &c)
+{
+    Result r;
+    r.error = c.error;
+    r.position = c.pos;
+    return r;
+}
+
+template <typename CharT>
+AngleResult parseDecimalDegImpl(std::basic_string_view<CharT> text)
+{
+    Cursor<CharT> c(text);
+    bool negative {};
+
+    // either a sign (blank when untouched) or a direction letter and a blank
+    unsigned first = c.peek();
+    if( first == '+' || first == ' ' ) {
+        c.accept(first);
+    } else if( first == '-' ) {
+        c.accept(first);
+        negative = true;
+    } else if( isDirection(first) ) {
+        c.accept(first);
+        negative = isNegativeDirection(first);
+        if( !c.expect(' ') )
+            return failed<AngleResult>(c);
+    } else if( !(first >= '0' && first <= '9') ) {
+        c.fail(c.atEnd() ? eUNEXPECTED_END : eINVALID_PREFIX);
+        return failed<AngleResult>(c);
+    }
+
+    int32_t deg, frac;
+    int degCount, fracCount;
+    if( !c.digits(3, deg, degCount) || !c.expect('.') ||
+        !c.digits(6, frac, fracCount) || !c.expectDegree() || !c.finish() )
+        return failed<AngleResult>(c);
+
+    // scale to millionths of a degree
+    for( ; fracCount < 6; ++fracCount )
+        frac *= 10;
+
+    AngleResult r;
+    r.whole = negative ? -deg : deg;
+    r.fraction = frac;
+    r.negative = negative;
+    return r;
+}
+
+template <typename CharT>
+AngleResult parseDMSImpl(std::basic_string_view<CharT> text)
+{
+    Cursor<CharT> c(text);
+
+    unsigned direction = c.peek();
+    if( !isDirection(direction) ) {
+        c.fail(c.atEnd() ? eUNEXPECTED_END : eINVALID_PREFIX);
+        return failed<AngleResult>(c);
+    }
+    c.accept(direction);
+
+    int32_t deg, min, sec, secFrac;
+    int count, secFracCount;
+    if( !c.expect(' ') || !c.digits(3, deg, count) || !c.expectDegree() ||
+        !c.expect(' ') || !c.digits(2, min, count) || !c.expect('\'') ||
+        !c.expect(' ') || !c.digits(2, sec, count) || !c.expect('.') ||
+        !c.digits(2, secFrac, secFracCount) || !c.expect('"') || !c.finish() )
+        return failed<AngleResult>(c);
+
+    double scale = (secFracCount == 1) ? 10.0 : 100.0;
+    double seconds = (sec * scale + secFrac) / scale;
+
+    bool negative = isNegativeDirection(direction);
+
+    AngleResult r;
+    r.whole = negative ? -deg : deg;
+    // convert minutes and seconds
+    r.fraction = static_cast<int32_t>(((min / 60.0) + (seconds / 3600.0)) * 1000000);
+    r.negative = negative;
+    return r;
+}
+
+template <typename CharT>
+UTMResult parseUTMNorthingImpl(std::basic_string_view<CharT> text)
+{
+    Cursor<CharT> c(text);
+
+    int32_t zone, northing;
+    int count;
+    if( !c.digits(2, zone, count) )
+        return failed<UTMResult>(c);
+
+    unsigned letter = c.peek();
+    if( letter >= 'a' && letter <= 'z' )
+        letter -= 'a' - 'A';
+    // latitude bands C to X, without I and O (UTM::zone_detail::bands)
+    if( letter < 'C' || letter > 'X' || letter == 'I' || letter == 'O' ) {
+        c.fail(c.atEnd() ? eUNEXPECTED_END : eINVALID_PREFIX);
+        return failed<UTMResult>(c);
+    }
+    c.pos++;
+
+    if( !c.expect(' ') || !c.digits(7, northing, count) ||
+        !c.expect(' ') || !c.expect('m') || !c.finish() )
+        return failed<UTMResult>(c);
+
+    UTMResult r;
+    r.zoneNumber = zone;
+    r.zoneLetter = static_cast<char>(letter);
+    r.value = northing;
+    return r;
+}
+
+template <typename CharT>
+UTMResult parseUTMEastingImpl(std::basic_string_view<CharT> text)
+{
+    Cursor<CharT> c(text);
+
+    int32_t easting;
+    int count;
+    if( !c.digits(6, easting, count) || !c.expect(' ') ||
+        !c.expect('m') || !c.finish() )
+        return failed<UTMResult>(c);
+
+    UTMResult r;
+    r.value = easting;
+    return r;
+}
+
+} // namespace
+
+AngleResult parseDecimalDeg(std::u16string_view text) { return parseDecimalDegImpl(text); }
+AngleResult parseDMS(std::u16string_view text) { return parseDMSImpl(text); }
+UTMResult parseUTMNorthing(std::u16string_view text) { return parseUTMNorthingImpl(text); }
+UTMResult parseUTMEasting(std::u16string_view text) { return parseUTMEastingImpl(text); }
+
+AngleResult parseDecimalDeg(std::string_view text) { return parseDecimalDegImpl(text); }
+AngleResult parseDMS(std::string_view text) { return parseDMSImpl(text); }
+UTMResult parseUTMNorthing(std::string_view text) { return parseUTMNorthingImpl(text); }
+UTMResult parseUTMEasting(std::string_view text) { return parseUTMEastingImpl(text); }
+
+} // namespace LatLonParser
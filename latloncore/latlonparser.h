@@ -0,0 +1,76 @@
+#ifndef LATLONPARSER_H
+#define LATLONPARSER_H
+
+#include <cstdint>
+#include <string_view>
+
+///
+/// \brief Parsers for the text shown by LatLonWidget.
+///
+/// The parsers walk the text once, in place, and never allocate. They take
+/// UTF-16 (e.g. a QString's utf16() data) or UTF-8 text and accept exactly
+/// the layouts produced by the widget's input masks:
+///
+///   Decimal degree (sign)       "+12.345678°"        "-123.456789°"
+///   Decimal degree (direction)  "N 12.345678°"       "W 123.456789°"
+///   DMS                         "N 12° 34' 56.78\""  "E 123° 45' 06.70\""
+///   UTM northing                "33U 5000000 m"
+///   UTM easting                 "500000 m"
+///
+namespace LatLonParser
+{
+
+enum ErrorType {
+    eNO_ERROR,
+    eUNEXPECTED_END,        ///< text ended before the field was complete
+    eINVALID_PREFIX,        ///< sign, direction or zone letter not recognised
+    eEXPECTED_DIGIT,
+    eTOO_MANY_DIGITS,
+    eEXPECTED_SEPARATOR,    ///< missing blank, '.', unit or degree/minute/second sign
+    eTRAILING_TEXT
+};
+
+///
+/// \brief Angle split into whole degrees and millionths of a degree.
+///
+/// As with FloatType, \a whole carries the sign and \a fraction is always
+/// positive; \a negative is also set for values between -1 and 0.
+///
+struct AngleResult
+{
+    ErrorType error {eNO_ERROR};
+    int position {};        ///< index of the offending character on error
+    int32_t whole {};
+    int32_t fraction {};
+    bool negative {};
+
+    bool isValid() const { return error == eNO_ERROR; }
+};
+
+///
+/// \brief One UTM line edit. The zone is only filled in for the northing field.
+///
+struct UTMResult
+{
+    ErrorType error {eNO_ERROR};
+    int position {};
+    int zoneNumber {};
+    char zoneLetter {};
+    double value {};
+
+    bool isValid() const { return error == eNO_ERROR; }
+};
+
+AngleResult parseDecimalDeg(std::u16string_view text);
+AngleResult parseDMS(std::u16string_view text);
+UTMResult parseUTMNorthing(std::u16string_view text);
+UTMResult parseUTMEasting(std::u16string_view text);
+
+AngleResult parseDecimalDeg(std::string_view text);
+AngleResult parseDMS(std::string_view text);
+UTMResult parseUTMNorthing(std::string_view text);
+UTMResult parseUTMEasting(std::string_view text);
+
+} // namespace LatLonParser
+
+#endif // LATLONPARSER_H
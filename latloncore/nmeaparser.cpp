@@ -0,0 +1,230 @@
+#include "nmeaparser.h"
+
+namespace NmeaParser
+{
+
+namespace {
+
+int hexDigit(char c)
+{
+    if( c >= '0' && c <= '9' )
+        return c - '0';
+    if( c >= 'A' && c <= 'F' )
+        return c - 'A' + 10;
+    if( c >= 'a' && c <= 'f' )
+        return c - 'a' + 10;
+    return -1;
+}
+
+///
+/// \brief Walks the comma separated fields of a sentence body.
+///
+struct Fields
+{
+    explicit Fields(std::string_view b) : body(b) {}
+
+    // The next field, empty at and after the end
+    std::string_view next()
+    {
+        if( pos > body.size() )
+            return std::string_view();
+        std::size_t end = body.find(',', pos);
+        if( end == std::string_view::npos )
+            end = body.size();
+        std::string_view field = body.substr(pos, end - pos);
+        pos = end + 1;
+        ++index;
+        return field;
+    }
+
+    std::string_view body;
+    std::size_t pos {};
+    int index {-1};
+};
+
+// Exactly count digits of text from position at
+bool fixedDigits(std::string_view text, std::size_t at, int count, int32_t &value)
+{
+    if( at + std::size_t(count) > text.size() )
+        return false;
+    value = 0;
+    for( int i = 0; i < count; ++i ) {
+        const char c = text[at + std::size_t(i)];
+        if( c < '0' || c > '9' )
+            return false;
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+// "hhmmss" with optional fraction of a second, in milliseconds
+bool parseTime(std::string_view text, int32_t &timeMs)
+{
+    int32_t h, m, s;
+    if( !fixedDigits(text, 0, 2, h) || !fixedDigits(text, 2, 2, m) || !fixedDigits(text, 4, 2, s) )
+        return false;
+    if( h > 23 || m > 59 || s > 60 )
+        return false;
+
+    int32_t ms = 0;
+    if( text.size() > 6 ) {
+        if( text[6] != '.' )
+            return false;
+        // milliseconds, further digits are checked and dropped
+        int32_t scale = 100;
+        for( std::size_t i = 7; i < text.size(); ++i ) {
+            const char c = text[i];
+            if( c < '0' || c > '9' )
+                return false;
+            ms += (c - '0') * scale;
+            scale /= 10;
+        }
+    }
+    timeMs = ((h * 60 + m) * 60 + s) * 1000 + ms;
+    return true;
+}
+
+// "dddmm.mmmm" and the hemisphere letter, in degrees
+bool parseAngle(std::string_view text, std::string_view hemisphere, char positive, char negative,
+                int32_t limit, double &degrees)
+{
+    if( hemisphere.size() != 1 || (hemisphere[0] != positive && hemisphere[0] != negative) )
+        return false;
+
+    int64_t whole = 0;
+    std::size_t i = 0;
+    for( ; i < text.size() && text[i] != '.'; ++i ) {
+        const char c = text[i];
+        if( c < '0' || c > '9' || i == 5 )
+            return false;
+        whole = whole * 10 + (c - '0');
+    }
+    if( i < 3 )
+        return false;
+
+    // up to 10 decimals of a minute, beyond a micrometre
+    int64_t fraction = 0;
+    int64_t scale = 1;
+    if( i < text.size() ) {
+        for( ++i; i < text.size(); ++i ) {
+            const char c = text[i];
+            if( c < '0' || c > '9' )
+                return false;
+            if( scale < 10000000000 ) {
+                fraction = fraction * 10 + (c - '0');
+                scale *= 10;
+            }
+        }
+    }
+
+    const int64_t wholeDegrees = whole / 100;
+    const int64_t minutes = whole % 100;
+    if( minutes > 59 || wholeDegrees > limit || (wholeDegrees == limit && (minutes > 0 || fraction > 0)) )
+        return false;
+
+    degrees = double(wholeDegrees) + (double(minutes) + double(fraction) / double(scale)) / 60.0;
+    if( hemisphere[0] == negative )
+        degrees = -degrees;
+    return true;
+}
+
+// Latitude, N/S, longitude and E/W fields; all empty leaves hasPosition unset
+bool parsePosition(Fields &fields, Fix &fix)
+{
+    const std::string_view lat = fields.next();
+    const std::string_view ns = fields.next();
+    const std::string_view lon = fields.next();
+    const std::string_view ew = fields.next();
+    if( lat.empty() && ns.empty() && lon.empty() && ew.empty() )
+        return true;
+
+    if( !parseAngle(lat, ns, 'N', 'S', 90, fix.latitude) ) {
+        fix.field = fields.index - 3;
+        return false;
+    }
+    if( !parseAngle(lon, ew, 'E', 'W', 180, fix.longitude) ) {
+        fix.field = fields.index - 1;
+        return false;
+    }
+    fix.hasPosition = true;
+    return true;
+}
+
+Fix failed(ErrorType error, int field = 0)
+{
+    Fix fix;
+    fix.error = error;
+    fix.field = field;
+    return fix;
+}
+
+} // namespace
+
+uint8_t checksum(std::string_view sentence)
+{
+    uint8_t sum = 0;
+    std::size_t i = (!sentence.empty() && sentence[0] == '$') ? 1 : 0;
+    for( ; i < sentence.size() && sentence[i] != '*'; ++i )
+        sum ^= uint8_t(sentence[i]);
+    return sum;
+}
+
+Fix parseSentence(std::string_view sentence)
+{
+    while( !sentence.empty() && (sentence.back() == '\n' || sentence.back() == '\r') )
+        sentence.remove_suffix(1);
+    if( sentence.empty() || sentence[0] != '$' )
+        return failed(eNOT_A_SENTENCE);
+
+    const std::size_t star = sentence.size() >= 3 ? sentence.size() - 3 : 0;
+    if( star == 0 || sentence[star] != '*' )
+        return failed(eMISSING_CHECKSUM);
+    const int high = hexDigit(sentence[star + 1]);
+    const int low = hexDigit(sentence[star + 2]);
+    if( high < 0 || low < 0 )
+        return failed(eMISSING_CHECKSUM);
+    if( checksum(sentence) != uint8_t(high * 16 + low) )
+        return failed(eBAD_CHECKSUM);
+
+    Fields fields(sentence.substr(1, star - 1));
+
+    // talker (2 letters, or "P" and a maker code) and sentence formatter
+    const std::string_view address = fields.next();
+    if( address.size() < 5 )
+        return failed(eUNSUPPORTED_SENTENCE);
+    const std::string_view formatter = address.substr(address.size() - 3);
+
+    Fix fix;
+    if( formatter == "GGA" )
+        fix.type = eGGA;
+    else if( formatter == "RMC" )
+        fix.type = eRMC;
+    else
+        return failed(eUNSUPPORTED_SENTENCE);
+
+    const std::string_view time = fields.next();
+    if( !time.empty() && !parseTime(time, fix.timeMs) )
+        return failed(eINVALID_FIELD, fields.index);
+
+    bool hasFix;
+    if( fix.type == eRMC ) {
+        const std::string_view status = fields.next();
+        if( status != "A" && status != "V" )
+            return failed(eINVALID_FIELD, fields.index);
+        hasFix = (status == "A");
+        if( !parsePosition(fields, fix) )
+            return failed(eINVALID_FIELD, fix.field);
+    } else {
+        if( !parsePosition(fields, fix) )
+            return failed(eINVALID_FIELD, fix.field);
+        const std::string_view quality = fields.next();
+        if( quality.size() != 1 || quality[0] < '0' || quality[0] > '9' )
+            return failed(eINVALID_FIELD, fields.index);
+        hasFix = (quality[0] != '0');
+    }
+
+    fix.hasPosition = fix.hasPosition && hasFix;
+    return fix;
+}
+
+} // namespace NmeaParser
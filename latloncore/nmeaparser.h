@@ -0,0 +1,69 @@
+#ifndef NMEAPARSER_H
+#define NMEAPARSER_H
+
+#include <cstdint>
+#include <string_view>
+
+///
+/// \brief Position fixes from NMEA 0183 GGA and RMC sentences.
+///
+/// Sentences from any talker ("$GPGGA", "$GNRMC", ...) are parsed in place,
+/// in one pass, without allocating:
+///
+///   $GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69
+///   $GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*44
+///
+/// The checksum is required and checked. Other sentence types are
+/// recognised as eUNSUPPORTED_SENTENCE so callers can skip them cheaply.
+///
+namespace NmeaParser
+{
+
+enum ErrorType {
+    eNO_ERROR,
+    eNOT_A_SENTENCE,        ///< does not start with '$'
+    eMISSING_CHECKSUM,      ///< no "*hh" at the end
+    eBAD_CHECKSUM,
+    eUNSUPPORTED_SENTENCE,  ///< neither GGA nor RMC
+    eINVALID_FIELD          ///< a field of GGA or RMC does not parse
+};
+
+enum SentenceType {
+    eGGA,
+    eRMC
+};
+
+/// Longest sentence NMEA 0183 allows, "$" to "\r\n" inclusive.
+const int kMaxSentenceLength = 82;
+
+struct Fix
+{
+    ErrorType error {eNO_ERROR};
+    int field {};               ///< index of the offending field on eINVALID_FIELD
+    SentenceType type {eGGA};
+
+    /// UTC time of day in milliseconds, -1 when the field is empty.
+    int32_t timeMs {-1};
+
+    /// False for GGA fix quality 0 and RMC status 'V' (receiver has no
+    /// fix), and when the position fields are empty.
+    bool hasPosition {};
+    double latitude {};         ///< degrees, south negative
+    double longitude {};        ///< degrees, west negative
+
+    bool isValid() const { return error == eNO_ERROR; }
+};
+
+///
+/// \brief Parse one sentence, with or without the trailing "\r\n".
+///
+Fix parseSentence(std::string_view sentence);
+
+///
+/// \brief XOR of the characters between '$' and '*', as the checksum field holds it.
+///
+uint8_t checksum(std::string_view sentence);
+
+} // namespace NmeaParser
+
+#endif // NMEAPARSER_H
@@ -0,0 +1,202 @@
+#include "positionarray.h"
+
+#include "floattype.h"
+#include "utm.h"
+
+#include <climits>
+#include <cmath>
+
+namespace {
+
+const int32_t kLatitudeLimit = 90 * PositionArray::kUnitsPerDegree;
+const int32_t kLongitudeLimit = 180 * PositionArray::kUnitsPerDegree;
+
+inline uint8_t validFlags(int32_t latitude, int32_t longitude)
+{
+    return uint8_t((latitude >= -kLatitudeLimit && latitude <= kLatitudeLimit)
+                       ? PositionArray::eLATITUDE_VALID : 0)
+         | uint8_t((longitude >= -kLongitudeLimit && longitude <= kLongitudeLimit)
+                       ? PositionArray::eLONGITUDE_VALID : 0);
+}
+
+#ifdef UTM_HAVE_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+// Eight positions per step, the same checks as validFlags(). Returns the
+// number of positions done, a multiple of eight, and adds the invalid ones
+// to invalid.
+std::size_t validateAvx2(const int32_t *latitude, const int32_t *longitude, std::size_t count,
+                         uint8_t *valid, std::size_t &invalid)
+{
+    const __m256i latMin = _mm256_set1_epi32(-kLatitudeLimit - 1);
+    const __m256i latMax = _mm256_set1_epi32(kLatitudeLimit + 1);
+    const __m256i lonMin = _mm256_set1_epi32(-kLongitudeLimit - 1);
+    const __m256i lonMax = _mm256_set1_epi32(kLongitudeLimit + 1);
+    const __m256i latFlag = _mm256_set1_epi32(PositionArray::eLATITUDE_VALID);
+    const __m256i lonFlag = _mm256_set1_epi32(PositionArray::eLONGITUDE_VALID);
+    const __m256i bothFlags = _mm256_set1_epi32(PositionArray::ePOSITION_VALID);
+
+    std::size_t i = 0;
+    for( ; i + 8 <= count; i += 8 ) {
+        const __m256i lat = _mm256_load_si256(reinterpret_cast<const __m256i *>(latitude + i));
+        const __m256i lon = _mm256_load_si256(reinterpret_cast<const __m256i *>(longitude + i));
+        const __m256i latOk = _mm256_and_si256(_mm256_cmpgt_epi32(lat, latMin),
+                                               _mm256_cmpgt_epi32(latMax, lat));
+        const __m256i lonOk = _mm256_and_si256(_mm256_cmpgt_epi32(lon, lonMin),
+                                               _mm256_cmpgt_epi32(lonMax, lon));
+        const __m256i flags = _mm256_or_si256(_mm256_and_si256(latOk, latFlag),
+                                              _mm256_and_si256(lonOk, lonFlag));
+
+        const int ok = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(flags, bothFlags)));
+        invalid += 8 - __builtin_popcount(ok);
+
+        if( valid ) {
+            // 8 x int32 -> 8 x uint8, in order
+            const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(flags),
+                                                  _mm256_extracti128_si256(flags, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(valid + i), _mm_packus_epi16(words, words));
+        }
+    }
+    return i;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // UTM_HAVE_X86_DISPATCH
+
+} // namespace
+
+PositionArray::PositionArray(std::size_t count) :
+    m_latitude(count),
+    m_longitude(count)
+{
+}
+
+void PositionArray::reserve(std::size_t count)
+{
+    m_latitude.reserve(count);
+    m_longitude.reserve(count);
+}
+
+void PositionArray::resize(std::size_t count)
+{
+    m_latitude.resize(count);
+    m_longitude.resize(count);
+}
+
+void PositionArray::clear()
+{
+    m_latitude.clear();
+    m_longitude.clear();
+}
+
+void PositionArray::append(double latitude, double longitude)
+{
+    m_latitude.push_back(toUnits(latitude));
+    m_longitude.push_back(toUnits(longitude));
+}
+
+void PositionArray::append(const FloatType &latitude, const FloatType &longitude)
+{
+    m_latitude.push_back(toUnits(latitude));
+    m_longitude.push_back(toUnits(longitude));
+}
+
+void PositionArray::append(const double *latitude, const double *longitude, std::size_t count)
+{
+    const std::size_t first = size();
+    resize(first + count);
+    for( std::size_t i = 0; i < count; ++i ) {
+        m_latitude[first + i] = toUnits(latitude[i]);
+        m_longitude[first + i] = toUnits(longitude[i]);
+    }
+}
+
+void PositionArray::set(std::size_t i, double latitude, double longitude)
+{
+    m_latitude[i] = toUnits(latitude);
+    m_longitude[i] = toUnits(longitude);
+}
+
+void PositionArray::set(std::size_t i, const FloatType &latitude, const FloatType &longitude)
+{
+    m_latitude[i] = toUnits(latitude);
+    m_longitude[i] = toUnits(longitude);
+}
+
+FloatType PositionArray::latitudeValue(std::size_t i) const
+{
+    return toFloatType(m_latitude[i]);
+}
+
+FloatType PositionArray::longitudeValue(std::size_t i) const
+{
+    return toFloatType(m_longitude[i]);
+}
+
+std::size_t PositionArray::validate(uint8_t *valid) const
+{
+    const int32_t *latitude = m_latitude.data();
+    const int32_t *longitude = m_longitude.data();
+    const std::size_t count = size();
+
+    std::size_t invalid = 0;
+    std::size_t i = 0;
+#ifdef UTM_HAVE_X86_DISPATCH
+    if( UTM::DetectSimdLevel() >= UTM::SIMD_AVX2 )
+        i = validateAvx2(latitude, longitude, count, valid, invalid);
+#endif
+    for( ; i < count; ++i ) {
+        const uint8_t flags = validFlags(latitude[i], longitude[i]);
+        if( flags != ePOSITION_VALID )
+            ++invalid;
+        if( valid )
+            valid[i] = flags;
+    }
+    return invalid;
+}
+
+int32_t PositionArray::toUnits(double degrees)
+{
+    const double r = std::nearbyint(degrees * kUnitsPerDegree);
+    if( !(r >= double(INT32_MIN)) )     // also NaN
+        return INT32_MIN;
+    if( r > double(INT32_MAX) )
+        return INT32_MAX;
+    return int32_t(r);
+}
+
+int32_t PositionArray::toUnits(const FloatType &value)
+{
+    int32_t whole, fraction;
+    value.getValue(whole, fraction);
+    int64_t units = (int64_t(std::abs(whole)) * 1000000 + fraction) * 10;
+    if( value.isNegative() )
+        units = -units;
+    if( units < INT32_MIN )
+        return INT32_MIN;
+    if( units > INT32_MAX )
+        return INT32_MAX;
+    return int32_t(units);
+}
+
+FloatType PositionArray::toFloatType(int32_t units)
+{
+    // to millionths, ties to even
+    int64_t micro = units / 10;
+    const int32_t rest = std::abs(units % 10);
+    if( rest > 5 || (rest == 5 && (micro & 1)) )
+        micro += (units < 0) ? -1 : 1;
+
+    // FloatType(double) finds the same millionths again; FloatType(whole,
+    // fraction) would adjust some fractions
+    return FloatType(double(micro) / 1000000.0);
+}
@@ -0,0 +1,133 @@
+#ifndef POSITIONARRAY_H
+#define POSITIONARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+struct FloatType;
+
+///
+/// \brief Compact container for millions of positions.
+///
+/// Latitudes and longitudes are kept in two separate contiguous arrays of
+/// 32-bit fixed point values in units of 1e-7 degree (about 1 cm), each
+/// aligned to kAlignment bytes for vector loads: 8 bytes per position.
+///
+/// FloatType and LatLonWidget work in millionths of a degree, a multiple of
+/// the unit, so FloatType -> PositionArray -> FloatType and
+/// LatLonWidget::getPosition() -> append() -> latitude()/longitude() ->
+/// LatLonWidget::setPosition() are lossless. Values set from doubles keep
+/// the seventh decimal, which FloatType then rounds away.
+///
+class PositionArray
+{
+public:
+    /// Fixed point units per degree.
+    static constexpr int32_t kUnitsPerDegree = 10000000;
+
+    /// Alignment of the arrays in bytes, enough for AVX-512 loads.
+    static constexpr std::size_t kAlignment = 64;
+
+    /// Flags written by validate().
+    enum ValidFlags : uint8_t {
+        eLATITUDE_VALID = 1,
+        eLONGITUDE_VALID = 2,
+        ePOSITION_VALID = eLATITUDE_VALID | eLONGITUDE_VALID
+    };
+
+    ///
+    /// \brief std::allocator returning kAlignment aligned memory.
+    ///
+    template<class T>
+    struct AlignedAllocator
+    {
+        typedef T value_type;
+
+        AlignedAllocator() = default;
+        template<class U> AlignedAllocator(const AlignedAllocator<U> &) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+        }
+        void deallocate(T *p, std::size_t)
+        {
+            ::operator delete(p, std::align_val_t(kAlignment));
+        }
+
+        template<class U> bool operator==(const AlignedAllocator<U> &) const { return true; }
+        template<class U> bool operator!=(const AlignedAllocator<U> &) const { return false; }
+    };
+
+    typedef std::vector<int32_t, AlignedAllocator<int32_t>> Storage;
+
+    PositionArray() = default;
+
+    /// count positions at 0, 0
+    explicit PositionArray(std::size_t count);
+
+    std::size_t size() const { return m_latitude.size(); }
+    bool empty() const { return m_latitude.empty(); }
+    void reserve(std::size_t count);
+    void resize(std::size_t count);
+    void clear();
+
+    void append(double latitude, double longitude);
+    void append(const FloatType &latitude, const FloatType &longitude);
+
+    ///
+    /// \brief Append count positions in degrees.
+    ///
+    void append(const double *latitude, const double *longitude, std::size_t count);
+
+    void set(std::size_t i, double latitude, double longitude);
+    void set(std::size_t i, const FloatType &latitude, const FloatType &longitude);
+
+    /// Degrees, exact to the unit.
+    double latitude(std::size_t i) const { return toDegrees(m_latitude[i]); }
+    double longitude(std::size_t i) const { return toDegrees(m_longitude[i]); }
+
+    /// Rounded to millionths (ties to even).
+    FloatType latitudeValue(std::size_t i) const;
+    FloatType longitudeValue(std::size_t i) const;
+
+    // The fixed point arrays, kAlignment aligned
+    const int32_t *latitudeData() const { return m_latitude.data(); }
+    const int32_t *longitudeData() const { return m_longitude.data(); }
+    int32_t *latitudeData() { return m_latitude.data(); }
+    int32_t *longitudeData() { return m_longitude.data(); }
+
+    ///
+    /// \brief Bounds check of every position, as LatLonWidget checks its input.
+    ///
+    /// A latitude is valid within +-90 degrees, a longitude within +-180.
+    /// Writes the ValidFlags of each position to valid (when given) and
+    /// returns the number of positions that are not ePOSITION_VALID. Uses
+    /// AVX2 when the CPU has it.
+    ///
+    std::size_t validate(uint8_t *valid = nullptr) const;
+
+    ///
+    /// \brief Fixed point value of degrees, rounded to nearest (ties to even).
+    ///
+    /// Out of range values are clamped to the int32_t range and NaN becomes
+    /// INT32_MIN; both fail validate().
+    ///
+    static int32_t toUnits(double degrees);
+
+    /// Exact for every value validate() accepts.
+    static int32_t toUnits(const FloatType &value);
+
+    static double toDegrees(int32_t units) { return units / double(kUnitsPerDegree); }
+
+    /// Rounded to millionths (ties to even).
+    static FloatType toFloatType(int32_t units);
+
+private:
+    Storage m_latitude;
+    Storage m_longitude;
+};
+
+#endif // POSITIONARRAY_H
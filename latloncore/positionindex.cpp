@@ -0,0 +1,412 @@
+#include "positionindex.h"
+
+#include "floattype.h"
+#include "utm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+const int32_t kLatitudeOffset = 90000000;
+const int32_t kLongitudeOffset = 180000000;
+
+// Cell size exponent of the quadtree root: 2^29 micro-degrees covers the
+// offset longitudes (0..360e6), so every code is below 2^58
+const int kRootLevel = 29;
+
+// Cells with at most this many positions are scanned instead of split
+const std::size_t kLeafSize = 16;
+
+// Level of the directory of cell offsets: 4^8 cells of about 2 degrees
+const int kDirectoryLevel = 21;
+const std::size_t kDirectorySize = std::size_t(1) << (2 * (kRootLevel - kDirectoryLevel));
+
+const double kMicroToRad = 1e-6 * DEG_TO_RAD;
+const double kHalfPi = 1.57079632679489661923;
+const double kTwoPi = 6.28318530717958647692;
+
+// Spread the low 32 bits of x to the even bits of the result
+inline uint64_t spreadBits(uint64_t x)
+{
+    x &= 0xFFFFFFFFull;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8))  & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2))  & 0x3333333333333333ull;
+    x = (x | (x << 1))  & 0x5555555555555555ull;
+    return x;
+}
+
+// Inverse of spreadBits(): gather the even bits of x
+inline uint32_t compactBits(uint64_t x)
+{
+    x &= 0x5555555555555555ull;
+    x = (x | (x >> 1))  & 0x3333333333333333ull;
+    x = (x | (x >> 2))  & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x >> 4))  & 0x00FF00FF00FF00FFull;
+    x = (x | (x >> 8))  & 0x0000FFFF0000FFFFull;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+    return uint32_t(x);
+}
+
+// Haversine distance, positions in radians with the cosine of the latitude
+inline double haversine(double lat1, double cosLat1, double lon1,
+                        double lat2, double cosLat2, double lon2)
+{
+    const double sinLat = std::sin((lat2 - lat1) * 0.5);
+    const double sinLon = std::sin((lon2 - lon1) * 0.5);
+    const double h = sinLat * sinLat + cosLat1 * cosLat2 * sinLon * sinLon;
+    return 2.0 * PositionIndex::kEarthRadius * std::asin(std::sqrt(std::min(h, 1.0)));
+}
+
+// Angle wrapped into [0, 2pi)
+inline double wrapPositive(double a)
+{
+    return a - kTwoPi * std::floor(a / kTwoPi);
+}
+
+// Distance from a position to the part of meridian lon between lat1 and lat2
+double meridianDistance(double lat, double cosLat, double lon,
+                        double meridian, double lat1, double lat2)
+{
+    double dlon = std::fabs(wrapPositive(lon - meridian + kHalfPi * 2) - kHalfPi * 2);
+
+    // beyond 90 degrees the foot of the perpendicular is on the opposite
+    // meridian; along this one the distance then has no minimum inside the
+    // segment, so the nearest point is one of its ends
+    if( dlon >= kHalfPi )
+        return std::min(haversine(lat, cosLat, lon, lat1, std::cos(lat1), meridian),
+                        haversine(lat, cosLat, lon, lat2, std::cos(lat2), meridian));
+
+    // foot of the perpendicular on the meridian's great circle
+    double foot = std::atan(std::tan(lat) / std::cos(dlon));
+    foot = std::min(std::max(foot, lat1), lat2);
+    return haversine(lat, cosLat, lon, foot, std::cos(foot), meridian);
+}
+
+#ifdef UTM_HAVE_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+inline __m256i spreadBits(__m256i x)
+{
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 16)),
+                         _mm256_set1_epi64x(0x0000FFFF0000FFFFll));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 8)),
+                         _mm256_set1_epi64x(0x00FF00FF00FF00FFll));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 4)),
+                         _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0Fll));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 2)),
+                         _mm256_set1_epi64x(0x3333333333333333ll));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 1)),
+                         _mm256_set1_epi64x(0x5555555555555555ll));
+    return x;
+}
+
+// Four positions per step, the same operations as the scalar
+// latitudeToMicro()/longitudeToMicro()/encode(). Returns the number of
+// positions done, a multiple of four.
+std::size_t encodeAvx2(const double *latitude, const double *longitude, std::size_t count,
+                       uint64_t *codes)
+{
+    const __m256d micro = _mm256_set1_pd(1e6);
+    const __m256d latMin = _mm256_set1_pd(-90e6);
+    const __m256d latMax = _mm256_set1_pd(90e6);
+    const __m256d lonMin = _mm256_set1_pd(-180e6);
+    const __m256d lonMax = _mm256_set1_pd(180e6);
+    const __m256d lonRange = _mm256_set1_pd(360e6);
+    const __m256d half = _mm256_set1_pd(180.0);
+    const __m256d full = _mm256_set1_pd(360.0);
+    const __m128i latOffset = _mm_set1_epi32(kLatitudeOffset);
+    const __m128i lonOffset = _mm_set1_epi32(kLongitudeOffset);
+    const int nearest = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    std::size_t i = 0;
+    for( ; i + 4 <= count; i += 4 ) {
+        __m256d lat = _mm256_round_pd(_mm256_mul_pd(_mm256_loadu_pd(latitude + i), micro), nearest);
+        lat = _mm256_min_pd(_mm256_max_pd(lat, latMin), latMax);    // NaN becomes latMin
+
+        __m256d lon = _mm256_loadu_pd(longitude + i);
+        __m256d turns = _mm256_floor_pd(_mm256_div_pd(_mm256_add_pd(lon, half), full));
+        lon = _mm256_sub_pd(lon, _mm256_mul_pd(full, turns));
+        lon = _mm256_round_pd(_mm256_mul_pd(lon, micro), nearest);
+        lon = _mm256_max_pd(lon, lonMin);
+        lon = _mm256_sub_pd(lon, _mm256_and_pd(_mm256_cmp_pd(lon, lonMax, _CMP_GE_OQ), lonRange));
+
+        __m128i y = _mm_add_epi32(_mm256_cvtpd_epi32(lat), latOffset);
+        __m128i x = _mm_add_epi32(_mm256_cvtpd_epi32(lon), lonOffset);
+        __m256i code = _mm256_or_si256(spreadBits(_mm256_cvtepu32_epi64(x)),
+                                       _mm256_slli_epi64(spreadBits(_mm256_cvtepu32_epi64(y)), 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes + i), code);
+    }
+    return i;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // UTM_HAVE_X86_DISPATCH
+
+} // namespace
+
+///
+/// \brief A node of the implicit quadtree: the positions whose code starts with prefix.
+///
+struct PositionIndex::Cell
+{
+    uint64_t prefix;        ///< code >> (2 * level)
+    int level;              ///< the cell is 2^level micro-degrees square
+    std::size_t begin;      ///< first position in the cell
+    std::size_t end;        ///< one past the last position
+    double minDistance;     ///< lower bound of the distance to any position in the cell
+};
+
+int32_t PositionIndex::latitudeToMicro(double latitude)
+{
+    double r = std::nearbyint(latitude * 1e6);
+    r = (r >= -90e6) ? r : -90e6;       // also NaN
+    r = (r <= 90e6) ? r : 90e6;
+    return int32_t(r);
+}
+
+int32_t PositionIndex::longitudeToMicro(double longitude)
+{
+    const double turns = std::floor((longitude + 180.0) / 360.0);
+    double r = std::nearbyint((longitude - 360.0 * turns) * 1e6);
+    r = (r >= -180e6) ? r : -180e6;     // also NaN
+    if( r >= 180e6 )
+        r -= 360e6;
+    return int32_t(r);
+}
+
+int32_t PositionIndex::toMicro(const FloatType &value)
+{
+    int32_t whole, fraction;
+    value.getValue(whole, fraction);
+    const int32_t micro = std::abs(whole) * 1000000 + fraction;
+    return value.isNegative() ? -micro : micro;
+}
+
+uint64_t PositionIndex::encode(int32_t latitudeMicro, int32_t longitudeMicro)
+{
+    const uint32_t y = uint32_t(latitudeMicro + kLatitudeOffset);
+    const uint32_t x = uint32_t(longitudeMicro + kLongitudeOffset);
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+void PositionIndex::encode(const double *latitude, const double *longitude, std::size_t count,
+                           uint64_t *codes)
+{
+    std::size_t i = 0;
+#ifdef UTM_HAVE_X86_DISPATCH
+    if( UTM::DetectSimdLevel() >= UTM::SIMD_AVX2 )
+        i = encodeAvx2(latitude, longitude, count, codes);
+#endif
+    for( ; i < count; ++i )
+        codes[i] = encode(latitudeToMicro(latitude[i]), longitudeToMicro(longitude[i]));
+}
+
+double PositionIndex::distance(double latitude1, double longitude1,
+                               double latitude2, double longitude2)
+{
+    const double lat1 = latitude1 * DEG_TO_RAD;
+    const double lat2 = latitude2 * DEG_TO_RAD;
+    return haversine(lat1, std::cos(lat1), longitude1 * DEG_TO_RAD,
+                     lat2, std::cos(lat2), longitude2 * DEG_TO_RAD);
+}
+
+void PositionIndex::build(const double *latitude, const double *longitude, std::size_t count)
+{
+    std::vector<uint64_t> codes(count);
+    encode(latitude, longitude, count, codes.data());
+
+    // sort (code, input index); equal codes keep the input order
+    std::vector<std::pair<uint64_t, uint32_t>> order(count);
+    for( std::size_t i = 0; i < count; ++i )
+        order[i] = std::make_pair(codes[i], uint32_t(i));
+    std::sort(order.begin(), order.end());
+    std::vector<uint64_t>().swap(codes);
+
+    m_codes.resize(count);
+    m_latitude.resize(count);
+    m_longitude.resize(count);
+    m_ids.resize(count);
+    for( std::size_t i = 0; i < count; ++i ) {
+        const uint32_t id = order[i].second;
+        m_codes[i] = order[i].first;
+        m_latitude[i] = latitudeToMicro(latitude[id]);
+        m_longitude[i] = longitudeToMicro(longitude[id]);
+        m_ids[i] = id;
+    }
+
+    m_directory.assign(kDirectorySize + 1, uint32_t(count));
+    std::size_t cell = 0;
+    for( std::size_t i = 0; i < count; ++i ) {
+        const std::size_t c = std::size_t(m_codes[i] >> (2 * kDirectoryLevel));
+        while( cell <= c )
+            m_directory[cell++] = uint32_t(i);
+    }
+}
+
+double PositionIndex::pointDistance(double latRad, double cosLat, double lonRad,
+                                    std::size_t i) const
+{
+    const double lat = m_latitude[i] * kMicroToRad;
+    return haversine(latRad, cosLat, lonRad, lat, std::cos(lat), m_longitude[i] * kMicroToRad);
+}
+
+///
+/// Split a cell into its (up to four) non-empty children, with the distance
+/// bound still to be filled in.
+///
+void PositionIndex::split(const Cell &cell, Cell children[4], int &count) const
+{
+    const int level = cell.level - 1;
+    const uint64_t *codes = m_codes.data();
+    std::size_t begin = cell.begin;
+    count = 0;
+    for( uint64_t q = 0; q < 4; ++q ) {
+        const uint64_t prefix = cell.prefix * 4 + q;
+        std::size_t end = cell.end;
+        if( q < 3 ) {
+            const uint64_t next = (prefix + 1) << (2 * level);
+            if( level >= kDirectoryLevel )
+                end = m_directory[std::size_t(next >> (2 * kDirectoryLevel))];
+            else
+                end = std::size_t(std::lower_bound(codes + begin, codes + cell.end, next) - codes);
+        }
+        if( end > begin ) {
+            Cell &child = children[count++];
+            child.prefix = prefix;
+            child.level = level;
+            child.begin = begin;
+            child.end = end;
+            child.minDistance = 0;
+        }
+        begin = end;
+    }
+}
+
+namespace {
+
+// Lower bound of the distance from a position (radians) to any position in
+// the cell: the exact distance to the cell's latitude/longitude box
+double cellDistance(int level, uint64_t prefix, double lat, double cosLat, double lon)
+{
+    const uint64_t first = prefix << (2 * level);
+    const int64_t size = int64_t(1) << level;
+    const int64_t x0 = int64_t(compactBits(first)) - kLongitudeOffset;
+    const int64_t y0 = int64_t(compactBits(first >> 1)) - kLatitudeOffset;
+
+    const double lat1 = std::max<int64_t>(y0, -kLatitudeOffset) * kMicroToRad;
+    const double lat2 = std::min<int64_t>(y0 + size - 1, kLatitudeOffset) * kMicroToRad;
+    const double lon1 = x0 * kMicroToRad;
+    const double lon2 = std::min<int64_t>(x0 + size - 1, kLongitudeOffset - 1) * kMicroToRad;
+
+    if( wrapPositive(lon - lon1) <= lon2 - lon1 ) {
+        // within the cell's longitudes, straight along the meridian
+        const double dlat = std::max(std::max(lat1 - lat, lat - lat2), 0.0);
+        return dlat * PositionIndex::kEarthRadius;
+    }
+    return std::min(meridianDistance(lat, cosLat, lon, lon1, lat1, lat2),
+                    meridianDistance(lat, cosLat, lon, lon2, lat1, lat2));
+}
+
+} // namespace
+
+std::vector<PositionIndex::Neighbour> PositionIndex::nearest(double latitude, double longitude,
+                                                             std::size_t k) const
+{
+    std::vector<Neighbour> result;
+    if( k == 0 || m_codes.empty() )
+        return result;
+    k = std::min(k, m_codes.size());
+    result.reserve(k);
+
+    const double lat = latitudeToMicro(latitude) * kMicroToRad;
+    const double lon = longitudeToMicro(longitude) * kMicroToRad;
+    const double cosLat = std::cos(lat);
+
+    // best first: cells by their distance bound and single positions
+    // (level -1, index in begin) by their distance
+    struct Closer
+    {
+        bool operator()(const Cell &a, const Cell &b) const { return a.minDistance > b.minDistance; }
+    };
+    std::priority_queue<Cell, std::vector<Cell>, Closer> queue;
+    queue.push(Cell { 0, kRootLevel, 0, m_codes.size(), 0.0 });
+
+    while( !queue.empty() && result.size() < k ) {
+        const Cell cell = queue.top();
+        queue.pop();
+
+        if( cell.level < 0 ) {
+            result.push_back(Neighbour { m_ids[cell.begin], cell.minDistance });
+            continue;
+        }
+
+        if( cell.end - cell.begin <= kLeafSize || cell.level == 0 ) {
+            for( std::size_t i = cell.begin; i < cell.end; ++i )
+                queue.push(Cell { 0, -1, i, i + 1, pointDistance(lat, cosLat, lon, i) });
+            continue;
+        }
+
+        Cell children[4];
+        int count;
+        split(cell, children, count);
+        for( int c = 0; c < count; ++c ) {
+            children[c].minDistance = cellDistance(children[c].level, children[c].prefix,
+                                                   lat, cosLat, lon);
+            queue.push(children[c]);
+        }
+    }
+    return result;
+}
+
+void PositionIndex::collect(const Cell &cell, double latRad, double cosLat, double lonRad,
+                            double radius, std::vector<Neighbour> &result) const
+{
+    if( cell.end - cell.begin <= kLeafSize || cell.level == 0 ) {
+        for( std::size_t i = cell.begin; i < cell.end; ++i ) {
+            const double d = pointDistance(latRad, cosLat, lonRad, i);
+            if( d <= radius )
+                result.push_back(Neighbour { m_ids[i], d });
+        }
+        return;
+    }
+
+    Cell children[4];
+    int count;
+    split(cell, children, count);
+    for( int c = 0; c < count; ++c ) {
+        if( cellDistance(children[c].level, children[c].prefix, latRad, cosLat, lonRad) <= radius )
+            collect(children[c], latRad, cosLat, lonRad, radius, result);
+    }
+}
+
+std::vector<PositionIndex::Neighbour> PositionIndex::withinRadius(double latitude, double longitude,
+                                                                  double radius) const
+{
+    std::vector<Neighbour> result;
+    if( m_codes.empty() || !(radius >= 0) )
+        return result;
+
+    const double lat = latitudeToMicro(latitude) * kMicroToRad;
+    const double lon = longitudeToMicro(longitude) * kMicroToRad;
+    collect(Cell { 0, kRootLevel, 0, m_codes.size(), 0.0 }, lat, std::cos(lat), lon, radius, result);
+
+    std::sort(result.begin(), result.end(), [](const Neighbour &a, const Neighbour &b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+    });
+    return result;
+}
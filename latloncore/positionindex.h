@@ -0,0 +1,113 @@
+#ifndef POSITIONINDEX_H
+#define POSITIONINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FloatType;
+
+///
+/// \brief Static spatial index for nearest-position and radius queries.
+///
+/// Positions are stored in micro-degrees, the fixed point resolution of
+/// FloatType, and sorted by the Morton (Z-order) code of their grid cell:
+/// the bits of the latitude and longitude cell numbers interleaved, as in a
+/// binary geohash. The sorted codes form an implicit quadtree, which the
+/// queries descend with binary searches; no tree nodes are stored.
+///
+/// Distances are great-circle distances on a sphere of the mean earth
+/// radius, in metres.
+///
+class PositionIndex
+{
+public:
+    ///
+    /// \brief One query result.
+    ///
+    struct Neighbour
+    {
+        std::size_t id;     ///< index of the position in the build() input
+        double distance;    ///< metres
+    };
+
+    PositionIndex() = default;
+
+    ///
+    /// \brief Bulk load count positions, replacing the current content.
+    ///
+    /// Latitudes are clamped to +-90 and longitudes wrapped into -180..180;
+    /// NaN is treated as -90 / -180. At most 2^32 - 1 positions.
+    ///
+    void build(const double *latitude, const double *longitude, std::size_t count);
+
+    std::size_t size() const { return m_codes.size(); }
+
+    ///
+    /// \brief The k positions closest to (latitude, longitude), nearest first.
+    ///
+    std::vector<Neighbour> nearest(double latitude, double longitude, std::size_t k) const;
+
+    ///
+    /// \brief All positions within radius metres, nearest first.
+    ///
+    std::vector<Neighbour> withinRadius(double latitude, double longitude, double radius) const;
+
+    /// Earth radius used for the distances.
+    static constexpr double kEarthRadius = 6371008.8;
+
+    ///
+    /// \brief Micro-degrees of a latitude, rounded to nearest (ties to even).
+    ///
+    static int32_t latitudeToMicro(double latitude);
+
+    ///
+    /// \brief Micro-degrees of a longitude, wrapped into [-180000000, 180000000).
+    ///
+    static int32_t longitudeToMicro(double longitude);
+
+    ///
+    /// \brief Micro-degrees of a FloatType value (whole and millionths).
+    ///
+    static int32_t toMicro(const FloatType &value);
+
+    ///
+    /// \brief Morton code of the micro-degree cell of a position.
+    ///
+    static uint64_t encode(int32_t latitudeMicro, int32_t longitudeMicro);
+
+    ///
+    /// \brief Morton codes of count positions in degrees.
+    ///
+    /// Uses AVX2 when the CPU has it; gives the same codes as
+    /// encode(latitudeToMicro(), longitudeToMicro()).
+    ///
+    static void encode(const double *latitude, const double *longitude, std::size_t count,
+                       uint64_t *codes);
+
+    ///
+    /// \brief Great-circle distance in metres between two positions in degrees.
+    ///
+    static double distance(double latitude1, double longitude1,
+                           double latitude2, double longitude2);
+
+private:
+    struct Cell;
+
+    double pointDistance(double latRad, double cosLat, double lonRad, std::size_t i) const;
+    void split(const Cell &cell, Cell children[4], int &count) const;
+    void collect(const Cell &cell, double latRad, double cosLat, double lonRad,
+                 double radius, std::vector<Neighbour> &result) const;
+
+    // sorted by code; the other arrays in the same order
+    std::vector<uint64_t> m_codes;
+    std::vector<int32_t> m_latitude;    ///< micro-degrees
+    std::vector<int32_t> m_longitude;   ///< micro-degrees
+    std::vector<uint32_t> m_ids;
+
+    // first position of every cell of the directory level (and the end),
+    // saves the binary searches over the whole index near the root
+    std::vector<uint32_t> m_directory;
+};
+
+#endif // POSITIONINDEX_H
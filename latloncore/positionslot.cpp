@@ -0,0 +1,92 @@
+#include "positionslot.h"
+
+#include <cstring>
+#include <utility>
+
+namespace {
+
+uint64_t toBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+void PositionSlot::setNotifier(std::function<void()> notifier)
+{
+    m_notifier = std::move(notifier);
+}
+
+bool PositionSlot::publish(double latitude, double longitude)
+{
+    // A cell of our own: odd sequence until the position is stored. A cell
+    // still held by a writer one lap behind is skipped with a new ticket.
+    uint64_t ticket;
+    Cell *cell;
+    uint64_t sequence;
+    for( ;; ) {
+        ticket = m_tickets.fetch_add(1, std::memory_order_relaxed) + 1;
+        cell = &m_cells[ticket % kCellCount];
+        sequence = cell->sequence.load(std::memory_order_relaxed);
+        if( !(sequence & 1) &&
+            cell->sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                   std::memory_order_acquire, std::memory_order_relaxed) )
+            break;
+    }
+
+    // a reader that sees any of the values also sees the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    cell->ticket.store(ticket, std::memory_order_relaxed);
+    cell->latitude.store(toBits(latitude), std::memory_order_relaxed);
+    cell->longitude.store(toBits(longitude), std::memory_order_relaxed);
+    cell->sequence.store(sequence + 2, std::memory_order_release);
+
+    // newest ticket wins
+    uint64_t latest = m_latest.load(std::memory_order_relaxed);
+    do {
+        if( latest > ticket )
+            return false;
+    } while( !m_latest.compare_exchange_weak(latest, ticket,
+                                             std::memory_order_release, std::memory_order_relaxed) );
+
+    if( !m_isPending.exchange(true, std::memory_order_acq_rel) && m_notifier )
+        m_notifier();
+    return true;
+}
+
+bool PositionSlot::take(double &latitude, double &longitude)
+{
+    // Cleared before reading: a publish this read misses finds the flag
+    // clear and notifies again.
+    m_isPending.exchange(false, std::memory_order_acq_rel);
+
+    const uint64_t ticket = m_latest.load(std::memory_order_acquire);
+    if( ticket == m_lastTaken )
+        return false;
+
+    const Cell &cell = m_cells[ticket % kCellCount];
+    const uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if( sequence & 1 )
+        return false;   // reused by a newer ticket, which notifies
+    const uint64_t cellTicket = cell.ticket.load(std::memory_order_relaxed);
+    const uint64_t latitudeBits = cell.latitude.load(std::memory_order_relaxed);
+    const uint64_t longitudeBits = cell.longitude.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if( cell.sequence.load(std::memory_order_relaxed) != sequence || cellTicket != ticket )
+        return false;
+
+    latitude = fromBits(latitudeBits);
+    longitude = fromBits(longitudeBits);
+    m_lastTaken = ticket;
+    ++m_taken;
+    return true;
+}
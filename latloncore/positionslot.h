@@ -0,0 +1,80 @@
+#ifndef POSITIONSLOT_H
+#define POSITIONSLOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+///
+/// \brief Latest position of a sensor, written by any thread and read by one.
+///
+/// Lock-free: publish() takes a ticket, writes the position into one of a
+/// few cells under that cell's sequence number (a seqlock) and then moves
+/// the latest ticket forward. take() reads the cell of the latest ticket
+/// and checks the cell's sequence did not move meanwhile. A writer
+/// preempted in the middle of a write holds up nobody: the others write
+/// other cells and the reader keeps reading the latest complete one. Every
+/// value is delivered whole; samples published faster than the reader
+/// takes them, or finished after a newer one, are dropped.
+///
+/// The notifier is called by the publish() that makes a position pending,
+/// at most once until the next take(). Use it to schedule the read on the
+/// consumer thread, so that a burst of samples costs one wakeup:
+/// \code
+/// slot.setNotifier([widget] {
+///     QMetaObject::invokeMethod(widget, "positionSlotReady", Qt::QueuedConnection);
+/// });
+/// \endcode
+///
+class PositionSlot
+{
+public:
+    PositionSlot() = default;
+    PositionSlot(const PositionSlot &) = delete;
+    PositionSlot &operator=(const PositionSlot &) = delete;
+
+    /// Set before the producers start; called on the producer threads.
+    void setNotifier(std::function<void()> notifier);
+
+    /// Any thread, lock-free. False if a newer sample was published first.
+    bool publish(double latitude, double longitude);
+
+    ///
+    /// \brief The position published last, if it has not been taken yet.
+    ///
+    /// One consumer thread only. Never waits; if the latest cell is being
+    /// rewritten it returns false, and the writer notifies again.
+    ///
+    bool take(double &latitude, double &longitude);
+
+    /// Samples published so far.
+    uint64_t published() const { return m_tickets.load(std::memory_order_relaxed); }
+
+    /// Samples taken by the consumer.
+    uint64_t taken() const { return m_taken; }
+
+private:
+    // More cells than writers likely to be preempted mid-write at once
+    static constexpr int kCellCount = 8;
+
+    struct alignas(64) Cell
+    {
+        std::atomic<uint64_t> sequence {0};     // odd while written
+        std::atomic<uint64_t> ticket {0};
+        std::atomic<uint64_t> latitude {0};     // bits of the doubles
+        std::atomic<uint64_t> longitude {0};
+    };
+
+    Cell m_cells[kCellCount];
+    alignas(64) std::atomic<uint64_t> m_tickets {0};
+    alignas(64) std::atomic<uint64_t> m_latest {0};     // ticket of the latest position, 0 for none
+    std::atomic<bool> m_isPending {false};
+
+    std::function<void()> m_notifier;
+
+    // consumer side
+    uint64_t m_lastTaken {0};
+    uint64_t m_taken {0};
+};
+
+#endif // POSITIONSLOT_H
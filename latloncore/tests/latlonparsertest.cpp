@@ -0,0 +1,237 @@
+// Round trip and fuzz test of LatLonParser against LatLonFormat.
+//
+// Random positions are formatted the way LatLonWidget shows them and must
+// parse back to the same value. Random, truncated and mutated text must be
+// rejected with an error position inside the text, and never crash.
+
+#include "floattype.h"
+#include "latlonformat.h"
+#include "latlonparser.h"
+#include "utm.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+
+int failures = 0;
+
+void fail(const char *what, const std::u16string &text)
+{
+    if( ++failures > 20 )
+        return;
+    std::string ascii;
+    for( char16_t c : text )
+        ascii += (c < 0x80) ? char(c) : '?';
+    std::fprintf(stderr, "FAIL: %s: \"%s\"\n", what, ascii.c_str());
+}
+
+std::u16string formatted(LatLonFormat::PositionFormatType posFormat, LatLonFormat::ValueType type,
+                         LatLonFormat::NotationType notation, const FloatType &value)
+{
+    char16_t buf[LatLonFormat::kMaxTextSize];
+    return std::u16string(buf, LatLonFormat::format(buf, posFormat, type, notation, value));
+}
+
+std::u16string widen(const char *begin, const char *end)
+{
+    return std::u16string(begin, end);
+}
+
+template<class Result>
+void checkError(const char *what, const Result &r, const std::u16string &text)
+{
+    if( r.isValid() )
+        fail(what, text);
+    else if( r.position < 0 || r.position > int(text.size()) )
+        fail("error position out of range", text);
+}
+
+// Every parser on text that may or may not be valid: no crash, and an
+// error position inside the text when it is rejected
+void parseAny(const std::u16string &text)
+{
+    const std::u16string_view view(text);
+    const LatLonParser::AngleResult angles[] = {
+        LatLonParser::parseDecimalDeg(view), LatLonParser::parseDMS(view)
+    };
+    const LatLonParser::UTMResult utms[] = {
+        LatLonParser::parseUTMNorthing(view), LatLonParser::parseUTMEasting(view)
+    };
+    for( const LatLonParser::AngleResult &r : angles ) {
+        if( !r.isValid() && (r.position < 0 || r.position > int(text.size())) )
+            fail("error position out of range", text);
+    }
+    for( const LatLonParser::UTMResult &r : utms ) {
+        if( !r.isValid() && (r.position < 0 || r.position > int(text.size())) )
+            fail("error position out of range", text);
+    }
+}
+
+// The value a decimal degree text must parse to: exactly the FloatType's
+void checkDecimalDeg(const FloatType &value, LatLonFormat::ValueType type,
+                     LatLonFormat::NotationType notation)
+{
+    const std::u16string text = formatted(LatLonFormat::eDECIMAL_DEG, type, notation, value);
+    const LatLonParser::AngleResult r = LatLonParser::parseDecimalDeg(text);
+    int32_t whole, fraction;
+    value.getValue(whole, fraction);
+    if( !r.isValid() )
+        fail("decimal degree text rejected", text);
+    else if( r.whole != whole || r.fraction != fraction || r.negative != value.isNegative() )
+        fail("decimal degree text parsed to another value", text);
+
+    // every shorter text is incomplete
+    for( std::size_t n = 0; n < text.size(); ++n )
+        checkError("truncated decimal degree text accepted",
+                   LatLonParser::parseDecimalDeg(std::u16string_view(text).substr(0, n)),
+                   text.substr(0, n));
+}
+
+// DMS shows hundredths of a second, the value comes back to within those
+void checkDMS(const FloatType &value, LatLonFormat::ValueType type)
+{
+    const std::u16string text = formatted(LatLonFormat::eDMS, type,
+                                          LatLonFormat::NotationType::eSIGN, value);
+    const LatLonParser::AngleResult r = LatLonParser::parseDMS(text);
+    if( !r.isValid() ) {
+        fail("DMS text rejected", text);
+        return;
+    }
+    const double parsed = (r.negative ? -1.0 : 1.0)
+            * (std::abs(r.whole) + r.fraction / 1000000.0);
+    if( std::fabs(parsed - value.getValue()) > 0.005 / 3600.0 + 1.5e-6 )
+        fail("DMS text parsed to another value", text);
+
+    for( std::size_t n = 0; n < text.size(); ++n )
+        checkError("truncated DMS text accepted",
+                   LatLonParser::parseDMS(std::u16string_view(text).substr(0, n)),
+                   text.substr(0, n));
+}
+
+// Whole metres, with the zone in the northing field
+void checkUTM(double latitude, double longitude)
+{
+    char northingText[LatLonFormat::kMaxTextSize];
+    char eastingText[LatLonFormat::kMaxTextSize];
+    const LatLonFormat::UTMTextEnd end = LatLonFormat::formatUTM(northingText, eastingText,
+                                                                 latitude, longitude);
+    const std::u16string northing = widen(northingText, end.northing);
+    const std::u16string easting = widen(eastingText, end.easting);
+
+    double n, e;
+    UTM::UtmZone zone;
+    UTM::LLtoUTM(latitude, longitude, n, e, zone);
+
+    const LatLonParser::UTMResult rn = LatLonParser::parseUTMNorthing(northing);
+    const LatLonParser::UTMResult re = LatLonParser::parseUTMEasting(easting);
+    if( !rn.isValid() )
+        fail("UTM northing text rejected", northing);
+    else if( rn.zoneNumber != zone.number || rn.zoneLetter != zone.band
+             || std::fabs(rn.value - n) > 0.5 )
+        fail("UTM northing text parsed to another value", northing);
+    if( !re.isValid() )
+        fail("UTM easting text rejected", easting);
+    else if( std::fabs(re.value - e) > 0.5 )
+        fail("UTM easting text parsed to another value", easting);
+
+    for( std::size_t k = 0; k < northing.size(); ++k )
+        checkError("truncated UTM northing text accepted",
+                   LatLonParser::parseUTMNorthing(std::u16string_view(northing).substr(0, k)),
+                   northing.substr(0, k));
+    for( std::size_t k = 0; k < easting.size(); ++k )
+        checkError("truncated UTM easting text accepted",
+                   LatLonParser::parseUTMEasting(std::u16string_view(easting).substr(0, k)),
+                   easting.substr(0, k));
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 gen(20240229u);
+    std::uniform_real_distribution<double> latitudes(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitudes(-180.0, 180.0);
+    std::uniform_real_distribution<double> utmLatitudes(-80.0, 84.0);
+
+    const int rounds = 20000;
+    for( int i = 0; i < rounds; ++i ) {
+        const FloatType latitude(latitudes(gen));
+        const FloatType longitude(longitudes(gen));
+        for( LatLonFormat::NotationType notation : { LatLonFormat::NotationType::eSIGN,
+                                                     LatLonFormat::NotationType::eDIRECTION } ) {
+            checkDecimalDeg(latitude, LatLonFormat::eLATITUDE, notation);
+            checkDecimalDeg(longitude, LatLonFormat::eLONGITUDE, notation);
+        }
+        checkDMS(latitude, LatLonFormat::eLATITUDE);
+        checkDMS(longitude, LatLonFormat::eLONGITUDE);
+        checkUTM(utmLatitudes(gen), longitudes(gen));
+    }
+
+    // the edges: poles, antimeridian and values between -1 and 0
+    const double edges[] = { 0.0, -0.000001, -0.5, 0.999999, 90.0, -90.0, 180.0, -180.0 };
+    for( double v : edges ) {
+        checkDecimalDeg(FloatType(v), LatLonFormat::eLONGITUDE, LatLonFormat::NotationType::eSIGN);
+        checkDecimalDeg(FloatType(v), LatLonFormat::eLONGITUDE, LatLonFormat::NotationType::eDIRECTION);
+        checkDMS(FloatType(v), LatLonFormat::eLONGITUDE);
+    }
+
+    // UTM band letters: C to X without I and O, in either case
+    for( char letter = 'A'; letter <= 'Z'; ++letter ) {
+        const bool band = letter >= 'C' && letter <= 'X' && letter != 'I' && letter != 'O';
+        for( char c : { letter, char(letter - 'A' + 'a') } ) {
+            const std::u16string text = u"32" + std::u16string(1, char16_t(c)) + u" 5412345 m";
+            const LatLonParser::UTMResult r = LatLonParser::parseUTMNorthing(text);
+            const LatLonParser::UTMResult r8 =
+                    LatLonParser::parseUTMNorthing(std::string("32") + c + " 5412345 m");
+            if( band ) {
+                if( !r.isValid() || !r8.isValid() || r.zoneLetter != letter || r8.zoneLetter != letter )
+                    fail("UTM band letter rejected", text);
+            } else if( r.error != LatLonParser::eINVALID_PREFIX || r.position != 2
+                       || r8.error != LatLonParser::eINVALID_PREFIX || r8.position != 2 ) {
+                fail("UTM text outside the latitude bands accepted", text);
+            }
+        }
+    }
+
+    // Garbage: text drawn from the characters the formats use, plus any
+    // UTF-16 code unit (lone surrogates included)
+    const std::u16string alphabet = u"0123456789 .+-°'\"NSEWmUCXZ";
+    std::uniform_int_distribution<int> lengths(0, 24);
+    std::uniform_int_distribution<int> pick(0, int(alphabet.size()));
+    std::uniform_int_distribution<int> units(0, 0xffff);
+    for( int i = 0; i < 200000; ++i ) {
+        std::u16string text(std::size_t(lengths(gen)), u' ');
+        for( char16_t &c : text ) {
+            const int k = pick(gen);
+            c = (k < int(alphabet.size())) ? alphabet[std::size_t(k)] : char16_t(units(gen));
+        }
+        parseAny(text);
+    }
+
+    // Valid text with one character replaced, dropped or doubled
+    for( int i = 0; i < 50000; ++i ) {
+        std::u16string text = formatted(LatLonFormat::PositionFormatType(i % 2),
+                                        LatLonFormat::ValueType((i / 2) % 2),
+                                        LatLonFormat::NotationType((i / 4) % 2),
+                                        FloatType(longitudes(gen)));
+        std::uniform_int_distribution<int> where(0, int(text.size()) - 1);
+        const std::size_t at = std::size_t(where(gen));
+        switch( i % 3 ) {
+        case 0: text[at] = char16_t(units(gen) & 0x7f); break;
+        case 1: text.erase(at, 1); break;
+        default: text.insert(at, 1, text[at]); break;
+        }
+        parseAny(text);
+    }
+
+    if( failures ) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    std::printf("latlonparser: all round trips and fuzz inputs passed\n");
+    return 0;
+}
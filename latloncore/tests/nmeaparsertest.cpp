@@ -0,0 +1,153 @@
+// Unit tests of NmeaParser: checksums, the GGA and RMC fields, fixes
+// without a position and the time of day.
+//
+// Most sentences get their checksum appended by withChecksum(), computed
+// here independently of NmeaParser::checksum(); the examples of the header
+// are checked as written.
+
+#include "nmeaparser.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void fail(const std::string &sentence, const char *what)
+{
+    ++failures;
+    std::fprintf(stderr, "FAIL: %s: %s\n", sentence.c_str(), what);
+}
+
+std::string withChecksum(const std::string &body)
+{
+    unsigned sum = 0;
+    for( char c : body )
+        sum ^= static_cast<unsigned char>(c);
+    char hex[4];
+    std::snprintf(hex, sizeof(hex), "*%02X", sum);
+    return "$" + body + hex;
+}
+
+void checkFix(const std::string &sentence, NmeaParser::SentenceType type, int32_t timeMs,
+              bool hasPosition, double latitude = 0, double longitude = 0)
+{
+    const NmeaParser::Fix fix = NmeaParser::parseSentence(sentence);
+    if( !fix.isValid() ) {
+        fail(sentence, "rejected");
+        return;
+    }
+    if( fix.type != type )
+        fail(sentence, "sentence type");
+    if( fix.timeMs != timeMs )
+        fail(sentence, "time");
+    if( fix.hasPosition != hasPosition )
+        fail(sentence, "hasPosition");
+    if( hasPosition && (std::fabs(fix.latitude - latitude) > 1e-9
+                        || std::fabs(fix.longitude - longitude) > 1e-9) )
+        fail(sentence, "position");
+}
+
+void checkError(const std::string &sentence, NmeaParser::ErrorType error, int field = 0)
+{
+    const NmeaParser::Fix fix = NmeaParser::parseSentence(sentence);
+    if( fix.error != error )
+        fail(sentence, "error type");
+    else if( error == NmeaParser::eINVALID_FIELD && fix.field != field )
+        fail(sentence, "field index");
+}
+
+void checkTime(const char *time, int32_t timeMs)
+{
+    checkFix(withChecksum(std::string("GPGGA,") + time + ",4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+             NmeaParser::eGGA, timeMs, true, 48.1173, 11.0 + 31.0 / 60.0);
+}
+
+} // namespace
+
+int main()
+{
+    using namespace NmeaParser;
+
+    const double latitude = 48.1173;
+    const double longitude = 11.0 + 31.0 / 60.0;
+    const int32_t time = ((12 * 60 + 35) * 60 + 19) * 1000;
+
+    // the examples of nmeaparser.h
+    const std::string gga = "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69";
+    const std::string rmc = "$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*44";
+    checkFix(gga, eGGA, time, true, latitude, longitude);
+    checkFix(rmc, eRMC, time, true, latitude, longitude);
+    if( checksum(gga) != 0x69 || checksum(rmc) != 0x44 )
+        fail(gga, "checksum()");
+
+    // checksum field: good, lower case, wrong, missing, line endings
+    checkFix(gga + "\r\n", eGGA, time, true, latitude, longitude);
+    checkFix("$GNGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*77",
+             eGGA, time, true, latitude, longitude);
+    checkFix(withChecksum("GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"),
+             eRMC, time, true, latitude, longitude);
+    checkFix("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6a",
+             eRMC, time, true, latitude, longitude);
+    checkError("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47", eBAD_CHECKSUM);
+    checkError("$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A", eBAD_CHECKSUM);
+    checkError("$GPGGA,123519.00,4807.039,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69", eBAD_CHECKSUM);
+    checkError("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", eMISSING_CHECKSUM);
+    checkError("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*6", eMISSING_CHECKSUM);
+    checkError("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*6G", eMISSING_CHECKSUM);
+    checkError("GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69", eNOT_A_SENTENCE);
+    checkError("", eNOT_A_SENTENCE);
+    checkError(withChecksum("GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00"),
+               eUNSUPPORTED_SENTENCE);
+    checkError(withChecksum("GGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+               eUNSUPPORTED_SENTENCE);
+
+    // southern and western hemispheres
+    checkFix(withChecksum("GPGGA,123519,3351.500,S,15112.250,W,1,08,0.9,545.4,M,46.9,M,,"),
+             eGGA, time, true, -(33.0 + 51.5 / 60.0), -(151.0 + 12.25 / 60.0));
+
+    // no position: empty fields, RMC status V, GGA fix quality 0
+    checkFix(withChecksum("GPGGA,123519,,,,,0,00,,,M,,M,,"), eGGA, time, false);
+    checkFix(withChecksum("GPGGA,123519,,,,,1,00,,,M,,M,,"), eGGA, time, false);
+    checkFix(withChecksum("GPRMC,123519,V,,,,,,,230394,,"), eRMC, time, false);
+    checkFix(withChecksum("GPRMC,123519,V,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"),
+             eRMC, time, false);
+    checkFix(withChecksum("GPGGA,123519,4807.038,N,01131.000,E,0,00,,,M,,M,,"), eGGA, time, false);
+    checkFix(withChecksum("GPGGA,,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+             eGGA, -1, true, latitude, longitude);
+
+    // invalid fields, with the index of the offending one
+    checkError(withChecksum("GPRMC,123519,X,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"),
+               eINVALID_FIELD, 2);
+    checkError(withChecksum("GPGGA,123519,4807.038,X,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+               eINVALID_FIELD, 2);
+    checkError(withChecksum("GPGGA,123519,9000.001,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+               eINVALID_FIELD, 2);
+    checkError(withChecksum("GPGGA,123519,4807.038,N,18100.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+               eINVALID_FIELD, 4);
+    checkError(withChecksum("GPGGA,123519,4807.038,N,01131.000,E,,08,0.9,545.4,M,46.9,M,,"),
+               eINVALID_FIELD, 6);
+    checkError(withChecksum("GPGGA,123519,4807.038,N,,E,1,08,0.9,545.4,M,46.9,M,,"),
+               eINVALID_FIELD, 4);
+
+    // time of day: midnight, fractions, leap second, out of range
+    checkTime("000000", 0);
+    checkTime("000000.00", 0);
+    checkTime("000000.5", 500);
+    checkTime("000000.05", 50);
+    checkTime("000000.001", 1);
+    checkTime("000000.0019", 1);
+    checkTime("235959.999", 86399999);
+    checkTime("235960", 86400000);
+    checkTime("123519.25", time + 250);
+    checkTime("123519.", time);
+    for( const char *bad : { "240000", "236000", "235961", "12351", "1235190", "123519.2x", "12a519" } )
+        checkError(withChecksum(std::string("GPGGA,") + bad
+                                + ",4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+                   eINVALID_FIELD, 1);
+
+    std::printf("nmeaparser: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
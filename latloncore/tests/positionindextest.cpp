@@ -0,0 +1,156 @@
+// Brute-force check of PositionIndex: nearest() and withinRadius() against a
+// scan over all positions with PositionIndex::distance(), for radii up to
+// half the circumference and query positions anywhere on the sphere.
+//
+// The positions are whole micro-degrees, the resolution of the index, so the
+// index and the scan measure the same distances; a position only counts as
+// missing or extra when it is more than a millimetre inside or outside.
+
+#include "positionindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void fail(const char *what, double latitude, double longitude, double value)
+{
+    ++failures;
+    std::fprintf(stderr, "FAIL: %s at (%.6f, %.6f): %.3f\n", what, latitude, longitude, value);
+}
+
+constexpr double kTolerance = 1e-3;   // metres
+const double kHalfCircumference = PositionIndex::kEarthRadius * 3.14159265358979323846;
+
+struct Positions
+{
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+
+    void add(double lat, double lon)
+    {
+        latitude.push_back(std::nearbyint(lat * 1e6) / 1e6);
+        longitude.push_back(std::nearbyint(lon * 1e6) / 1e6);
+    }
+};
+
+std::vector<double> scan(const Positions &positions, double latitude, double longitude)
+{
+    std::vector<double> distances(positions.latitude.size());
+    for( std::size_t i = 0; i < distances.size(); ++i )
+        distances[i] = PositionIndex::distance(latitude, longitude,
+                                               positions.latitude[i], positions.longitude[i]);
+    return distances;
+}
+
+void checkRadius(const PositionIndex &index, const std::vector<double> &distances,
+                 double latitude, double longitude, double radius)
+{
+    const std::vector<PositionIndex::Neighbour> found = index.withinRadius(latitude, longitude, radius);
+
+    std::vector<char> seen(distances.size(), 0);
+    double previous = 0;
+    for( const PositionIndex::Neighbour &n : found ) {
+        if( n.id >= distances.size() || seen[n.id] ) {
+            fail("withinRadius id out of range or repeated", latitude, longitude, double(n.id));
+            return;
+        }
+        seen[n.id] = 1;
+        if( distances[n.id] > radius + kTolerance )
+            fail("withinRadius extra position", latitude, longitude, distances[n.id]);
+        if( std::fabs(n.distance - distances[n.id]) > kTolerance ) {
+            fail("withinRadius distance", latitude, longitude, n.distance);
+            return;
+        }
+        if( n.distance < previous )
+            fail("withinRadius not sorted", latitude, longitude, n.distance);
+        previous = n.distance;
+    }
+    for( std::size_t i = 0; i < distances.size(); ++i )
+        if( !seen[i] && distances[i] < radius - kTolerance ) {
+            fail("withinRadius missed position", latitude, longitude, distances[i]);
+            return;
+        }
+}
+
+void checkNearest(const PositionIndex &index, std::vector<double> distances,
+                  double latitude, double longitude, std::size_t k)
+{
+    const std::vector<PositionIndex::Neighbour> found = index.nearest(latitude, longitude, k);
+    k = std::min(k, distances.size());
+    if( found.size() != k ) {
+        fail("nearest count", latitude, longitude, double(found.size()));
+        return;
+    }
+    std::vector<double> foundDistances;
+    for( const PositionIndex::Neighbour &n : found )
+        foundDistances.push_back(n.distance);
+    std::nth_element(distances.begin(), distances.begin() + std::ptrdiff_t(k - 1), distances.end());
+    std::sort(distances.begin(), distances.begin() + std::ptrdiff_t(k));
+    for( std::size_t i = 0; i < k; ++i )
+        if( std::fabs(foundDistances[i] - distances[i]) > kTolerance ) {
+            fail("nearest distance", latitude, longitude, foundDistances[i]);
+            return;
+        }
+}
+
+void check(const PositionIndex &index, const Positions &positions,
+           double latitude, double longitude, double radius)
+{
+    // the index rounds the query to micro-degrees as well
+    latitude = std::nearbyint(latitude * 1e6) / 1e6;
+    longitude = std::nearbyint(longitude * 1e6) / 1e6;
+    const std::vector<double> distances = scan(positions, latitude, longitude);
+    checkRadius(index, distances, latitude, longitude, radius);
+    checkNearest(index, distances, latitude, longitude, 10);
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937_64 random(20240613);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto randomLatitude = [&] { return std::asin(2 * unit(random) - 1) * 180 / 3.14159265358979323846; };
+    auto randomLongitude = [&] { return unit(random) * 360 - 180; };
+
+    // uniform on the sphere, plus the poles, the antimeridian and a
+    // point the meridian bound once pruned from far away
+    Positions positions;
+    for( int i = 0; i < 100000; ++i )
+        positions.add(randomLatitude(), randomLongitude());
+    positions.add(90, 0);
+    positions.add(-90, 0);
+    positions.add(0, -180);
+    positions.add(45, 179.999999);
+    positions.add(-86.085, 57.932);
+
+    PositionIndex index;
+    index.build(positions.latitude.data(), positions.longitude.data(), positions.latitude.size());
+    if( index.size() != positions.latitude.size() )
+        fail("size", 0, 0, double(index.size()));
+
+    check(index, positions, 13.808, -120.658, 11978000);
+    check(index, positions, 13.808, -120.658, kHalfCircumference);
+    check(index, positions, 0, 0, kHalfCircumference);
+    check(index, positions, 90, 0, 10000000);
+    check(index, positions, -90, 0, 10000000);
+
+    for( int i = 0; i < 64; ++i ) {
+        const double latitude = randomLatitude();
+        const double longitude = randomLongitude();
+        // mostly large radii, where the cells span more than 90 degrees
+        const double radius = (i % 4 == 0) ? unit(random) * 1000000
+                                           : unit(random) * kHalfCircumference;
+        check(index, positions, latitude, longitude, radius);
+    }
+
+    std::printf("positionindex: %zu positions, %d failures\n", index.size(), failures);
+    return failures ? 1 : 0;
+}
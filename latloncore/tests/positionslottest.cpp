@@ -0,0 +1,106 @@
+// Stress test of PositionSlot: several producer threads publish into one
+// slot while one consumer takes from it.
+//
+// Each producer publishes (v, -v) with v counting up, so a read mixing two
+// samples is torn (latitude != -longitude) and a read older than the one
+// before from the same producer went backwards. After the producers stop,
+// the last sample published must be the one taken, and the notifier must
+// have fired at most once per take() (plus the pending one).
+
+#include "positionslot.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what, int producers)
+{
+    if( !ok ) {
+        ++failures;
+        std::fprintf(stderr, "FAIL: %s (%d producers)\n", what, producers);
+    }
+}
+
+void stress(int producers, int samples)
+{
+    PositionSlot slot;
+    std::atomic<uint64_t> notified(0);
+    slot.setNotifier([&notified] { notified.fetch_add(1, std::memory_order_relaxed); });
+
+    std::atomic<int> running(producers);
+    std::vector<std::thread> threads;
+    for( int i = 0; i < producers; ++i ) {
+        threads.emplace_back([&slot, &running, producers, samples, i] {
+            for( int k = 0; k < samples; ++k ) {
+                const double v = double(k * producers + i) * 1e-6;
+                slot.publish(v, -v);
+                // let the consumer in now and then, also on a single core
+                if( k % 256 == 255 )
+                    std::this_thread::yield();
+            }
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    uint64_t tornReads = 0;
+    uint64_t backwardReads = 0;
+    std::vector<long> last(std::size_t(producers), -1);
+    auto take = [&] {
+        double latitude, longitude;
+        if( !slot.take(latitude, longitude) )
+            return;
+        if( latitude != -longitude ) {
+            ++tornReads;
+            return;
+        }
+        const long v = std::lround(latitude * 1e6);
+        long &previous = last[std::size_t(v % producers)];
+        if( v / producers <= previous )
+            ++backwardReads;
+        previous = v / producers;
+    };
+    while( running.load(std::memory_order_acquire) > 0 )
+        take();
+    for( std::thread &t : threads )
+        t.join();
+    take();
+
+    check(tornReads == 0, "torn read", producers);
+    check(backwardReads == 0, "read went backwards", producers);
+    // tickets skipped over a busy cell count as published too
+    check(slot.published() >= uint64_t(producers) * uint64_t(samples),
+          "published count", producers);
+    check(notified.load() <= slot.taken() + 1, "notifier fired more than once per take", producers);
+
+    // the latest sample wins once the producers are done
+    slot.publish(12.5, -45.25);
+    double latitude, longitude;
+    check(slot.take(latitude, longitude) && latitude == 12.5 && longitude == -45.25,
+          "last sample not taken", producers);
+    check(!slot.take(latitude, longitude), "sample taken twice", producers);
+
+    std::printf("positionslot: %d producers, %llu published, %llu taken\n", producers,
+                static_cast<unsigned long long>(slot.published()),
+                static_cast<unsigned long long>(slot.taken()));
+}
+
+} // namespace
+
+int main()
+{
+    for( int producers : { 1, 2, 4, 16 } )
+        stress(producers, 100000);
+
+    if( failures ) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
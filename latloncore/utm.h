@@ -0,0 +1,1146 @@
+/* -*- mode: C++ -*-
+ *
+ *  Conversions between Latitude/Longitude and UTM
+ *              (Universal Transverse Mercator) coordinates.
+ *
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _UTM_H
+#define _UTM_H
+
+/**  @file
+ @brief Universal Transverse Mercator transforms.
+ Functions to convert (spherical) latitude and longitude to and
+ from (Euclidean) UTM coordinates.
+ @author Chuck Gantz- chuck.gantz@globalstar.com
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define UTM_HAVE_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+// #include "ofMathConstants.h"
+
+
+namespace UTM
+{
+    // Grid granularity for rounding UTM coordinates to generate MapXY.
+    const double grid_size = 100000.0;    ///< 100 km grid
+
+#define DEG_TO_RAD 0.017453292519943295	///< pi/180
+#define RAD_TO_DEG 57.295779513082321	///< 180/pi
+
+// WGS84 Parameters
+#define WGS84_A		6378137.0		///< major axis
+#define WGS84_B		6356752.314245179	///< minor axis
+#define WGS84_F		0.0033528106647474805	///< ellipsoid flattening
+#define WGS84_E		0.081819190842621486	///< first eccentricity
+#define WGS84_EP	0.082094437949695676	///< second eccentricity
+
+    // UTM Parameters
+#define UTM_K0		0.9996			///< scale factor
+#define UTM_FE		500000.0		///< false easting
+#define UTM_FN_N	0.0           ///< false northing, northern hemisphere
+#define UTM_FN_S	10000000.0    ///< false northing, southern hemisphere
+#define UTM_E2		(WGS84_E*WGS84_E)	///< e^2
+#define UTM_E4		(UTM_E2*UTM_E2)		///< e^4
+#define UTM_E6		(UTM_E4*UTM_E2)		///< e^6
+#define UTM_EP2		(UTM_E2/(1-UTM_E2))	///< e'^2
+
+    /**
+     * UTM zone of a position: number 1..60 and latitude band 'C'..'X'
+     * ('Z' outside 80S..84N).
+     */
+    struct UtmZone
+    {
+        uint8_t number;
+        char band;
+    };
+
+    namespace zone_detail
+    {
+        /// Latitude bands of 8 degrees from 80S, the last one (X) reaching 84N.
+        static const char bands[21] = {
+            'C', 'D', 'E', 'F', 'G', 'H', 'J', 'K', 'L', 'M',
+            'N', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'X'
+        };
+
+        /// Index of the band of Lat in bands[], -1 outside the UTM limits.
+        /// The band edges match the comparisons of the original if/else
+        /// chain exactly.
+        static inline int BandIndex(double Lat)
+        {
+            if(!(Lat >= -80.0 && Lat <= 84.0))
+                return -1;
+            int band = int(std::floor(Lat*0.125));
+            // tiny negative latitudes underflow to -0 in Lat/8
+            if(Lat < band*8.0)
+                --band;
+            return band + 10;
+        }
+
+        const int band_v = 17;  ///< 56N..64N, Norway
+        const int band_x = 19;  ///< 72N..84N, Svalbard (with 20)
+
+        /// Zones for the 3 degree columns from 0E to 42E in band V (row 0)
+        /// and X (row 1); 0 keeps the regular 6 degree zone.
+        static const uint8_t exception_zones[2][14] = {
+            {  0, 32, 32, 32,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0 },
+            { 31, 31, 31, 33, 33, 33, 33, 35, 35, 35, 35, 37, 37, 37 }
+        };
+    } // end namespace zone_detail
+
+    /**
+     * Determine the correct UTM letter designator for the
+     * given latitude
+     *
+     * @returns 'Z' if latitude is outside the UTM limits of 84N to 80S
+     *
+     * Written by Chuck Gantz- chuck.gantz@globalstar.com
+     */
+    static inline char UTMLetterDesignator(double Lat)
+    {
+        // 'Z' is an error flag, the Latitude is outside the UTM limits
+        const int band = zone_detail::BandIndex(Lat);
+        return band < 0 ? 'Z' : zone_detail::bands[band];
+    }
+
+    /**
+     * Bring a longitude into the -180.00 .. 179.9 range used for
+     * the zone computation.
+     */
+    static inline double NormalizeLongitude(double Long)
+    {
+        return (Long+180)-int((Long+180)/360)*360-180;
+    }
+
+    /**
+     * Determine the UTM zone number for the given latitude and
+     * (normalized) longitude, including the Norway and Svalbard exceptions.
+     */
+    static inline int UTMZoneNumber(double Lat, double LongTemp)
+    {
+        int ZoneNumber = int((LongTemp + 180)/6) + 1;
+
+        // Special zones for Norway (band V) and Svalbard (band X up to,
+        // but not including, 84N), all between 0E and 42E
+        if( LongTemp >= 0.0 && LongTemp < 42.0 )
+        {
+            const int band = zone_detail::BandIndex(Lat);
+            const int row = (band == zone_detail::band_v) ? 0
+                          : (band >= zone_detail::band_x && Lat < 84.0) ? 1 : -1;
+            if( row >= 0 )
+            {
+                // exact at the column edges, unlike a plain int(LongTemp/3)
+                int column = int(LongTemp/3);
+                if( column*3.0 > LongTemp )
+                    --column;
+                if( zone_detail::exception_zones[row][column] )
+                    ZoneNumber = zone_detail::exception_zones[row][column];
+            }
+        }
+        return ZoneNumber;
+    }
+
+    /**
+     * Zone number and latitude band of a position.
+     */
+    static inline UtmZone UTMZoneOf(double Lat, double Long)
+    {
+        UtmZone Zone;
+        Zone.number = uint8_t(UTMZoneNumber(Lat, NormalizeLongitude(Long)));
+        Zone.band = UTMLetterDesignator(Lat);
+        return Zone;
+    }
+
+    /**
+     * Write the zone as text ("33U"), without a terminating nul.
+     *
+     * @returns the end of the text, at most 4 characters are written.
+     */
+    static inline char *FormatUTMZone(char *out, UtmZone Zone)
+    {
+        if(Zone.number >= 100)
+            *out++ = char('0' + Zone.number/100);
+        if(Zone.number >= 10)
+            *out++ = char('0' + Zone.number/10 % 10);
+        *out++ = char('0' + Zone.number % 10);
+        *out++ = Zone.band;
+        return out;
+    }
+
+    /**
+     * Read a zone written by FormatUTMZone(); leading blanks are skipped
+     * and the band is the character after the digits.
+     */
+    static inline UtmZone ParseUTMZone(const char *text)
+    {
+        while(*text == ' ' || *text == '\t')
+            ++text;
+        unsigned number = 0;
+        for(; *text >= '0' && *text <= '9'; ++text)
+            number = number*10 + unsigned(*text - '0');
+
+        UtmZone Zone;
+        Zone.number = uint8_t(number);
+        Zone.band = *text;
+        return Zone;
+    }
+
+    /// @name Reference ellipsoids
+    /// Semi-major axis and flattening, usable as TransverseMercator parameter.
+    /// @{
+    struct WGS84
+    {
+        static constexpr double a = 6378137.0;            ///< major axis
+        static constexpr double f = 1/298.257223563;      ///< flattening
+    };
+
+    struct GRS80
+    {
+        static constexpr double a = 6378137.0;
+        static constexpr double f = 1/298.257222101;
+    };
+
+    struct International1924
+    {
+        static constexpr double a = 6378388.0;
+        static constexpr double f = 1/297.0;
+    };
+
+    struct Clarke1866
+    {
+        static constexpr double a = 6378206.4;
+        static constexpr double f = (6378206.4 - 6356583.8)/6378206.4;
+    };
+
+    struct Airy1830
+    {
+        static constexpr double a = 6377563.396;
+        static constexpr double f = (6377563.396 - 6356256.909)/6377563.396;
+    };
+    /// @}
+
+    /**
+     * UTM zone handling on top of a projection's Forward()/Reverse(), which
+     * work relative to the central meridian without false origin.
+     */
+    template<class Projection>
+    struct UTMProjection
+    {
+        /**
+         * Convert lat/long to UTM coords and the zone they are in.
+         */
+        static inline void LLtoUTM(double Lat, double Long,
+                                   double &UTMNorthing, double &UTMEasting,
+                                   UtmZone &Zone)
+        {
+            //Make sure the longitude is between -180.00 .. 179.9
+            const double LongTemp = NormalizeLongitude(Long);
+            Zone.number = uint8_t(UTMZoneNumber(Lat, LongTemp));
+            Zone.band = UTMLetterDesignator(Lat);
+
+            // +3 puts origin in middle of zone
+            const double LongOrigin = (Zone.number - 1)*6 - 180 + 3;
+            double x, y;
+            Projection::Forward(Lat, LongTemp - LongOrigin, x, y);
+
+            UTMEasting = x + UTM_FE;
+            //10000000 meter offset for southern hemisphere
+            UTMNorthing = (Lat < 0) ? y + UTM_FN_S : y;
+        }
+
+        /**
+         * Convert UTM coords to lat/long.
+         */
+        static inline void UTMtoLL(double UTMNorthing, double UTMEasting, UtmZone Zone,
+                                   double &Lat, double &Long)
+        {
+            //remove 500,000 meter offset for longitude
+            const double x = UTMEasting - UTM_FE;
+            //remove 10,000,000 meter offset used for southern hemisphere
+            const double y = ((Zone.band - 'N') < 0) ? UTMNorthing - UTM_FN_S : UTMNorthing;
+
+            double LongRel;
+            Projection::Reverse(x, y, Lat, LongRel);
+            //+3 puts origin in middle of zone
+            Long = (Zone.number - 1)*6 - 180 + 3 + LongRel;
+        }
+    };
+
+    /**
+     * USGS Bulletin 1532 transverse Mercator series for one ellipsoid.
+     *
+     * Everything that only depends on the ellipsoid (eccentricities and the
+     * series coefficients) is a compile time constant. Evaluation needs one
+     * sine/cosine pair per direction (two for UTMtoLL); the multiple angles
+     * of the meridian arc series come from the double angle identities.
+     */
+    template<class Ellipsoid>
+    struct TransverseMercator : UTMProjection<TransverseMercator<Ellipsoid> >
+    {
+        static constexpr double a   = Ellipsoid::a;
+        static constexpr double e2  = Ellipsoid::f*(2 - Ellipsoid::f);  ///< e^2
+        static constexpr double e4  = e2*e2;                            ///< e^4
+        static constexpr double e6  = e4*e2;                            ///< e^6
+        static constexpr double ep2 = e2/(1 - e2);                      ///< e'^2
+        /// (1-sqrt(1-e^2))/(1+sqrt(1-e^2)), sqrt(1-e^2) being 1-f
+        static constexpr double e1  = Ellipsoid::f/(2 - Ellipsoid::f);
+
+        /// Meridian arc M = a*(M0*phi - M2*sin(2phi) + M4*sin(4phi) - M6*sin(6phi))
+        static constexpr double M0 = 1 - e2/4 - 3*e4/64 - 5*e6/256;
+        static constexpr double M2 = 3*e2/8 + 3*e4/32 + 45*e6/1024;
+        static constexpr double M4 = 15*e4/256 + 45*e6/1024;
+        static constexpr double M6 = 35*e6/3072;
+
+        /// Footpoint latitude phi1 = mu + P2*sin(2mu) + P4*sin(4mu) + P6*sin(6mu)
+        static constexpr double P2 = 3*e1/2 - 27*e1*e1*e1/32;
+        static constexpr double P4 = 21*e1*e1/16 - 55*e1*e1*e1*e1/32;
+        static constexpr double P6 = 151*e1*e1*e1/96;
+
+        /**
+         * Project a point. LongRel is the longitude relative to the central
+         * meridian in degrees. Returns easting/northing without false
+         * easting and northing.
+         */
+        static inline void Forward(double Lat, double LongRel, double &x, double &y)
+        {
+            const double LatRad = Lat*DEG_TO_RAD;
+            const double s = sin(LatRad);
+            const double c = cos(LatRad);
+            const double t = s/c;
+
+            const double N = a/sqrt(1 - e2*s*s);
+            const double T = t*t;
+            const double C = ep2*c*c;
+            const double A = c*LongRel*DEG_TO_RAD;
+
+            const double sin2 = 2*s*c;
+            const double cos2 = c*c - s*s;
+            const double sin4 = 2*sin2*cos2;
+            const double cos4 = 1 - 2*sin2*sin2;
+            const double sin6 = sin4*cos2 + cos4*sin2;
+            const double M = a*(M0*LatRad - M2*sin2 + M4*sin4 - M6*sin6);
+
+            const double A2 = A*A;
+            const double A4 = A2*A2;
+            x = UTM_K0*N*(A + (1-T+C)*A2*A/6
+                          + (5-18*T+T*T+72*C-58*ep2)*A4*A/120);
+            y = UTM_K0*(M + N*t*(A2/2 + (5-T+9*C+4*C*C)*A4/24
+                                 + (61-58*T+T*T+600*C-330*ep2)*A4*A2/720));
+        }
+
+        /**
+         * Inverse of Forward(). Returns the latitude and the longitude
+         * relative to the central meridian, both in degrees.
+         */
+        static inline void Reverse(double x, double y, double &Lat, double &LongRel)
+        {
+            const double mu = y/(UTM_K0*a*M0);
+            double s = sin(mu);
+            double c = cos(mu);
+            const double sin2 = 2*s*c;
+            const double cos2 = c*c - s*s;
+            const double sin4 = 2*sin2*cos2;
+            const double cos4 = 1 - 2*sin2*sin2;
+            const double sin6 = sin4*cos2 + cos4*sin2;
+            const double phi1Rad = mu + P2*sin2 + P4*sin4 + P6*sin6;
+
+            s = sin(phi1Rad);
+            c = cos(phi1Rad);
+            const double t1 = s/c;
+            const double w = 1 - e2*s*s;
+            const double sw = sqrt(w);
+            const double N1 = a/sw;
+            const double T1 = t1*t1;
+            const double C1 = ep2*c*c;
+            const double R1 = a*(1 - e2)/(w*sw);
+            const double D = x/(N1*UTM_K0);
+            const double D2 = D*D;
+            const double D4 = D2*D2;
+
+            Lat = phi1Rad - (N1*t1/R1)
+                    *(D2/2 - (5+3*T1+10*C1-4*C1*C1-9*ep2)*D4/24
+                      + (61+90*T1+298*C1+45*T1*T1-252*ep2-3*C1*C1)*D4*D2/720);
+            Lat *= RAD_TO_DEG;
+
+            LongRel = (D - (1+2*T1+C1)*D2*D/6
+                       + (5-2*C1+28*T1-3*C1*C1+8*ep2+24*T1*T1)*D4*D/120)/c;
+            LongRel *= RAD_TO_DEG;
+        }
+    };
+
+    /**
+     * TransverseMercator with the latitude dependent terms looked up in
+     * tables instead of evaluated.
+     *
+     * Forward() tabulates the meridian arc M, the radius of curvature N and
+     * sin/cos of the latitude; Reverse() tabulates the footpoint latitude
+     * phi1 with its sin/cos and sqrt(1-e^2 sin^2 phi1) over the rectifying
+     * latitude mu. Each table covers +-89.5 degrees in 256 intervals, one
+     * cubic per term and interval fitted at the Chebyshev nodes, so an
+     * interval is 128 bytes (two cache lines) and both tables together
+     * 64 KB. tan and sec are recovered from sin/cos rather than tabulated,
+     * they do not interpolate well towards the poles.
+     *
+     * Maximum deviation from TransverseMercator is 0.003 mm within the
+     * standard zone width and 0.005 mm at 6 degrees from the central
+     * meridian, far below the error of the series itself. Latitudes (and
+     * northings) beyond the tables use the exact terms.
+     *
+     * The tables are built on first use, in well under a millisecond.
+     */
+    template<class Ellipsoid>
+    struct TabulatedTransverseMercator : UTMProjection<TabulatedTransverseMercator<Ellipsoid> >
+    {
+        typedef TransverseMercator<Ellipsoid> Series;
+
+        static constexpr int intervals = 256;       ///< per table
+        static constexpr double limit = 89.5;       ///< degrees either side of the equator
+
+        /// Cubics in v = -1..1 across one interval, c[term][power].
+        struct alignas(64) Interval
+        {
+            double c[4][4];
+        };
+
+        struct Tables
+        {
+            Interval forward[intervals];    ///< M, N, sin(phi), cos(phi) over phi
+            Interval reverse[intervals];    ///< phi1, sin(phi1), cos(phi1), sqrt(w) over mu
+            double phiMin, phiScale;        ///< interval index = (phi - phiMin)*phiScale
+            double muMin, muScale;
+        };
+
+        /// M, N, sin(phi) and cos(phi), evaluated.
+        static inline void ExactForwardTerms(double phi, double *terms)
+        {
+            const double s = sin(phi);
+            terms[0] = Series::a*(Series::M0*phi - Series::M2*sin(2*phi)
+                                  + Series::M4*sin(4*phi) - Series::M6*sin(6*phi));
+            terms[1] = Series::a/sqrt(1 - Series::e2*s*s);
+            terms[2] = s;
+            terms[3] = cos(phi);
+        }
+
+        /// phi1, sin(phi1), cos(phi1) and sqrt(1-e^2 sin^2 phi1), evaluated.
+        static inline void ExactReverseTerms(double mu, double *terms)
+        {
+            const double phi1 = mu + Series::P2*sin(2*mu) + Series::P4*sin(4*mu)
+                    + Series::P6*sin(6*mu);
+            const double s = sin(phi1);
+            terms[0] = phi1;
+            terms[1] = s;
+            terms[2] = cos(phi1);
+            terms[3] = sqrt(1 - Series::e2*s*s);
+        }
+
+        /**
+         * Fill one interval from the terms at the four Chebyshev nodes,
+         * converted to plain polynomial coefficients in v.
+         */
+        static void Fit(double lo, double hi, void (*terms)(double, double *), Interval &out)
+        {
+            const double pi = 3.14159265358979323846;
+            double values[4][4];
+            for(int k = 0; k < 4; ++k)
+                terms(lo + (cos((2*k + 1)*pi/8) + 1)*0.5*(hi - lo), values[k]);
+
+            for(int t = 0; t < 4; ++t) {
+                double cheb[4];
+                for(int j = 0; j < 4; ++j) {
+                    double sum = 0;
+                    for(int k = 0; k < 4; ++k)
+                        sum += values[k][t]*cos(j*(2*k + 1)*pi/8);
+                    cheb[j] = 0.5*sum;
+                }
+                cheb[0] *= 0.5;
+                // T2 = 2v^2 - 1, T3 = 4v^3 - 3v
+                out.c[t][0] = cheb[0] - cheb[2];
+                out.c[t][1] = cheb[1] - 3*cheb[3];
+                out.c[t][2] = 2*cheb[2];
+                out.c[t][3] = 4*cheb[3];
+            }
+        }
+
+        static const Tables &BuildTables()
+        {
+            static Tables tables;
+            const double phiMax = limit*DEG_TO_RAD;
+            double h = 2*phiMax/intervals;
+            tables.phiMin = -phiMax;
+            tables.phiScale = 1/h;
+            for(int i = 0; i < intervals; ++i)
+                Fit(-phiMax + i*h, -phiMax + (i + 1)*h, ExactForwardTerms, tables.forward[i]);
+
+            double terms[4];
+            ExactForwardTerms(phiMax, terms);
+            const double muMax = terms[0]/(Series::a*Series::M0);
+            h = 2*muMax/intervals;
+            tables.muMin = -muMax;
+            tables.muScale = 1/h;
+            for(int i = 0; i < intervals; ++i)
+                Fit(-muMax + i*h, -muMax + (i + 1)*h, ExactReverseTerms, tables.reverse[i]);
+            return tables;
+        }
+
+        /// The tables, built by the first caller.
+        static inline const Tables &GetTables()
+        {
+            static const Tables &tables = BuildTables();
+            return tables;
+        }
+
+        static inline double Evaluate(const double *c, double v)
+        {
+            return ((c[3]*v + c[2])*v + c[1])*v + c[0];
+        }
+
+        /**
+         * Look up the terms for terms[] at x, table index u = (x - min)*scale.
+         * @returns false if x lies outside the table.
+         */
+        static inline bool Lookup(const Interval *table, double u, double *terms)
+        {
+            if(!(u >= 0 && u < intervals))
+                return false;
+            const int i = int(u);
+            const double v = 2*(u - i) - 1;
+            for(int t = 0; t < 4; ++t)
+                terms[t] = Evaluate(table[i].c[t], v);
+            return true;
+        }
+
+        /// M, N, sin(phi) and cos(phi) for latitude phi in radians.
+        static inline void ForwardTerms(double phi, double *terms)
+        {
+            const Tables &tables = GetTables();
+            if(!Lookup(tables.forward, (phi - tables.phiMin)*tables.phiScale, terms))
+                ExactForwardTerms(phi, terms);
+        }
+
+        /// phi1, sin(phi1), cos(phi1) and sqrt(1-e^2 sin^2 phi1) for mu.
+        static inline void ReverseTerms(double mu, double *terms)
+        {
+            const Tables &tables = GetTables();
+            if(!Lookup(tables.reverse, (mu - tables.muMin)*tables.muScale, terms))
+                ExactReverseTerms(mu, terms);
+        }
+
+        /// See TransverseMercator::Forward()
+        static inline void Forward(double Lat, double LongRel, double &x, double &y)
+        {
+            double terms[4];
+            ForwardTerms(Lat*DEG_TO_RAD, terms);
+            const double M = terms[0];
+            const double N = terms[1];
+            const double s = terms[2];
+            const double c = terms[3];
+
+            const double ep2 = Series::ep2;
+            const double t = s/c;
+            const double T = t*t;
+            const double C = ep2*c*c;
+            const double A = c*LongRel*DEG_TO_RAD;
+
+            const double A2 = A*A;
+            const double A4 = A2*A2;
+            x = UTM_K0*N*(A + (1-T+C)*A2*A/6
+                          + (5-18*T+T*T+72*C-58*ep2)*A4*A/120);
+            y = UTM_K0*(M + N*t*(A2/2 + (5-T+9*C+4*C*C)*A4/24
+                                 + (61-58*T+T*T+600*C-330*ep2)*A4*A2/720));
+        }
+
+        /// See TransverseMercator::Reverse()
+        static inline void Reverse(double x, double y, double &Lat, double &LongRel)
+        {
+            double terms[4];
+            ReverseTerms(y/(UTM_K0*Series::a*Series::M0), terms);
+            const double phi1Rad = terms[0];
+            const double s = terms[1];
+            const double c = terms[2];
+            const double sw = terms[3];
+
+            const double ep2 = Series::ep2;
+            const double ic = 1/c;
+            const double t1 = s*ic;
+            const double T1 = t1*t1;
+            const double C1 = ep2*c*c;
+            // N1*t1/R1 = t1*w/(1-e^2)
+            const double NtR = t1*sw*sw/(1 - Series::e2);
+            const double D = x*sw/(Series::a*UTM_K0);
+            const double D2 = D*D;
+            const double D4 = D2*D2;
+
+            Lat = phi1Rad - NtR
+                    *(D2/2 - (5+3*T1+10*C1-4*C1*C1-9*ep2)*D4/24
+                      + (61+90*T1+298*C1+45*T1*T1-252*ep2-3*C1*C1)*D4*D2/720);
+            Lat *= RAD_TO_DEG;
+
+            LongRel = (D - (1+2*T1+C1)*D2*D/6
+                       + (5-2*C1+28*T1-3*C1*C1+8*ep2+24*T1*T1)*D4*D/120)*ic;
+            LongRel *= RAD_TO_DEG;
+        }
+    };
+
+    /// sqrt() usable in constant expressions (Newton iteration).
+    constexpr double ConstSqrt(double x)
+    {
+        double r = x > 1 ? x : 1;
+        for(int i = 0; i < 64; ++i)
+            r = 0.5*(r + x/r);
+        return r;
+    }
+
+    /**
+     * Krüger transverse Mercator series to sixth order in n, after
+     * C. F. F. Karney, "Transverse Mercator with an accuracy of a few
+     * nanometers", J. Geodesy 85 (2011).
+     *
+     * Accurate to a few nanometres within 3900 km of the central meridian,
+     * so points far outside their zone can be projected without loss. Costs
+     * four to five times as much as the Bulletin 1532 series of
+     * TransverseMercator, which is good to about a millimetre within the
+     * standard zone width only.
+     */
+    template<class Ellipsoid>
+    struct KrugerTransverseMercator : UTMProjection<KrugerTransverseMercator<Ellipsoid> >
+    {
+        static constexpr double n   = Ellipsoid::f/(2 - Ellipsoid::f);  ///< third flattening
+        static constexpr double e2  = Ellipsoid::f*(2 - Ellipsoid::f);  ///< e^2
+        static constexpr double e   = ConstSqrt(e2);                    ///< e
+        /// Rectifying radius times the UTM scale factor
+        static constexpr double kA  = UTM_K0*Ellipsoid::a/(1 + n)
+                *(1 + n*n/4 + n*n*n*n/64 + n*n*n*n*n*n/256);
+
+        /// Conformal latitude to northing/easting, sin(2j zeta) terms
+        static constexpr double alpha[6] = {
+            n/2 - 2*n*n/3 + 5*n*n*n/16 + 41*n*n*n*n/180
+                - 127*n*n*n*n*n/288 + 7891*n*n*n*n*n*n/37800,
+            13*n*n/48 - 3*n*n*n/5 + 557*n*n*n*n/1440
+                + 281*n*n*n*n*n/630 - 1983433*n*n*n*n*n*n/1935360,
+            61*n*n*n/240 - 103*n*n*n*n/140 + 15061*n*n*n*n*n/26880
+                + 167603*n*n*n*n*n*n/181440,
+            49561*n*n*n*n/161280 - 179*n*n*n*n*n/168 + 6601661*n*n*n*n*n*n/7257600,
+            34729*n*n*n*n*n/80640 - 3418889*n*n*n*n*n*n/1995840,
+            212378941*n*n*n*n*n*n/319334400
+        };
+
+        /// Northing/easting to conformal latitude, sin(2j xi) terms
+        static constexpr double beta[6] = {
+            n/2 - 2*n*n/3 + 37*n*n*n/96 - n*n*n*n/360
+                - 81*n*n*n*n*n/512 + 96199*n*n*n*n*n*n/604800,
+            n*n/48 + n*n*n/15 - 437*n*n*n*n/1440
+                + 46*n*n*n*n*n/105 - 1118711*n*n*n*n*n*n/3870720,
+            17*n*n*n/480 - 37*n*n*n*n/840 - 209*n*n*n*n*n/4480
+                + 5569*n*n*n*n*n*n/90720,
+            4397*n*n*n*n/161280 - 11*n*n*n*n*n/504 - 830251*n*n*n*n*n*n/7257600,
+            4583*n*n*n*n*n/161280 - 108847*n*n*n*n*n*n/3991680,
+            20648693*n*n*n*n*n*n/638668800
+        };
+
+        /**
+         * zeta + sign * sum_j c[j] sin(2j zeta) for zeta = xi + i eta,
+         * by Clenshaw summation. One complex sin/cos pair for all terms.
+         */
+        static inline void Clenshaw(const double *c, double sign, double &xi, double &eta)
+        {
+            const double s2 = sin(2*xi), c2 = cos(2*xi);
+            const double sh2 = sinh(2*eta), ch2 = cosh(2*eta);
+
+            // 2 cos(2 zeta)
+            const double ar = 2*c2*ch2, ai = -2*s2*sh2;
+            double b1r = 0, b1i = 0, b2r = 0, b2i = 0;
+            for(int j = 5; j >= 0; --j) {
+                const double br = c[j] + ar*b1r - ai*b1i - b2r;
+                const double bi = ar*b1i + ai*b1r - b2i;
+                b2r = b1r; b2i = b1i;
+                b1r = br;  b1i = bi;
+            }
+            // times sin(2 zeta)
+            const double sr = s2*ch2, si = c2*sh2;
+            xi  += sign*(sr*b1r - si*b1i);
+            eta += sign*(sr*b1i + si*b1r);
+        }
+
+        /// See TransverseMercator::Forward()
+        static inline void Forward(double Lat, double LongRel, double &x, double &y)
+        {
+            const double tau = tan(Lat*DEG_TO_RAD);
+            const double lam = LongRel*DEG_TO_RAD;
+
+            // conformal latitude, as tan
+            const double tau1 = sqrt(1 + tau*tau);
+            const double sigma = sinh(e*atanh(e*tau/tau1));
+            const double taup = tau*sqrt(1 + sigma*sigma) - sigma*tau1;
+
+            const double cl = cos(lam);
+            double xi = atan2(taup, cl);
+            double eta = asinh(sin(lam)/sqrt(taup*taup + cl*cl));
+            Clenshaw(alpha, 1, xi, eta);
+
+            x = kA*eta;
+            y = kA*xi;
+        }
+
+        /// See TransverseMercator::Reverse()
+        static inline void Reverse(double x, double y, double &Lat, double &LongRel)
+        {
+            double xi = y/kA;
+            double eta = x/kA;
+            Clenshaw(beta, -1, xi, eta);
+
+            const double sh = sinh(eta);
+            const double cx = cos(xi);
+            const double r = sqrt(sh*sh + cx*cx);
+            const double taup = sin(xi)/r;
+
+            // tan of the geographic latitude from the conformal one (Newton)
+            const double e2m = 1 - e2;
+            double tau = taup/e2m;
+            for(int i = 0; i < 5; ++i) {
+                const double tau1 = sqrt(1 + tau*tau);
+                const double sigma = sinh(e*atanh(e*tau/tau1));
+                const double taupa = tau*sqrt(1 + sigma*sigma) - sigma*tau1;
+                const double dtau = (taup - taupa)*(1 + e2m*tau*tau)
+                        / (e2m*tau1*sqrt(1 + taupa*taupa));
+                tau += dtau;
+                if(fabs(dtau) < 1e-13*(fabs(tau) > 1 ? fabs(tau) : 1))
+                    break;
+            }
+
+            Lat = atan(tau)*RAD_TO_DEG;
+            LongRel = atan2(sh, cx)*RAD_TO_DEG;
+        }
+    };
+
+    /// Projection used by the conversions taking an Engine argument.
+    enum Engine {
+        ENGINE_FAST,        ///< USGS Bulletin 1532 series, standard zone width only
+        ENGINE_PRECISE,     ///< 6th order Krüger series, nanometre accuracy
+        ENGINE_TABLE        ///< ENGINE_FAST with tabulated latitude terms, 64 KB of tables
+    };
+
+    /**
+     * Convert lat/long to UTM coords.  Equations from USGS Bulletin 1532
+     * (ENGINE_FAST, or ENGINE_TABLE from lookup tables) or the Krüger
+     * series (ENGINE_PRECISE).
+     *
+     * East Longitudes are positive, West longitudes are negative.
+     * North latitudes are positive, South latitudes are negative
+     * Lat and Long are in fractional degrees
+     *
+     * Written by Chuck Gantz- chuck.gantz@globalstar.com
+     */
+    static inline void LLtoUTM(const double Lat, const double Long,
+                               double &UTMNorthing, double &UTMEasting,
+                               UtmZone &Zone, Engine engine = ENGINE_FAST)
+    {
+        if(engine == ENGINE_PRECISE)
+            KrugerTransverseMercator<WGS84>::LLtoUTM(Lat, Long, UTMNorthing, UTMEasting, Zone);
+        else if(engine == ENGINE_TABLE)
+            TabulatedTransverseMercator<WGS84>::LLtoUTM(Lat, Long, UTMNorthing, UTMEasting, Zone);
+        else
+            TransverseMercator<WGS84>::LLtoUTM(Lat, Long, UTMNorthing, UTMEasting, Zone);
+    }
+
+    /**
+     * LLtoUTM() returning the zone as text ("33U") in UTMZone, which
+     * needs room for 5 characters.
+     */
+    static inline void LLtoUTM(const double Lat, const double Long,
+                               double &UTMNorthing, double &UTMEasting,
+                               char* UTMZone, Engine engine = ENGINE_FAST)
+    {
+        UtmZone Zone;
+        LLtoUTM(Lat, Long, UTMNorthing, UTMEasting, Zone, engine);
+        *FormatUTMZone(UTMZone, Zone) = '\0';
+    }
+
+    /**
+     * Converts UTM coords to lat/long.  Equations from USGS Bulletin 1532
+     * (ENGINE_FAST, or ENGINE_TABLE from lookup tables) or the Krüger
+     * series (ENGINE_PRECISE).
+     *
+     * East Longitudes are positive, West longitudes are negative.
+     * North latitudes are positive, South latitudes are negative
+     * Lat and Long are in fractional degrees.
+     *
+     * Written by Chuck Gantz- chuck.gantz@globalstar.com
+     */
+    static inline void UTMtoLL(const double UTMNorthing, const double UTMEasting,
+                               UtmZone Zone, double &Lat, double &Long,
+                               Engine engine = ENGINE_FAST)
+    {
+        if(engine == ENGINE_PRECISE)
+            KrugerTransverseMercator<WGS84>::UTMtoLL(UTMNorthing, UTMEasting, Zone, Lat, Long);
+        else if(engine == ENGINE_TABLE)
+            TabulatedTransverseMercator<WGS84>::UTMtoLL(UTMNorthing, UTMEasting, Zone, Lat, Long);
+        else
+            TransverseMercator<WGS84>::UTMtoLL(UTMNorthing, UTMEasting, Zone, Lat, Long);
+    }
+
+    /**
+     * UTMtoLL() taking the zone as text ("33U").
+     */
+    static inline void UTMtoLL(const double UTMNorthing, const double UTMEasting,
+                               const char* UTMZone, double& Lat,  double& Long,
+                               Engine engine = ENGINE_FAST)
+    {
+        UTMtoLL(UTMNorthing, UTMEasting, ParseUTMZone(UTMZone), Lat, Long, engine);
+    }
+
+    namespace batch_detail
+    {
+        /// Points prepared per pass of the batch conversions (on the stack).
+        const std::size_t chunk_size = 256;
+
+        /// Projection constants used by the kernels.
+        typedef TransverseMercator<WGS84> Projection;
+
+        /// Plain double "vector", used as the portable fallback.
+        namespace scalar
+        {
+            struct V
+            {
+                typedef double D;
+                typedef bool M;
+                enum { width = 1 };
+
+                static inline D set1(double a) { return a; }
+                static inline D loadu(const double *p) { return *p; }
+                static inline void storeu(double *p, D a) { *p = a; }
+                static inline D add(D a, D b) { return a + b; }
+                static inline D sub(D a, D b) { return a - b; }
+                static inline D mul(D a, D b) { return a * b; }
+                static inline D div(D a, D b) { return a / b; }
+                static inline D sqrt(D a) { return std::sqrt(a); }
+                static inline D floor(D a) { return std::floor(a); }
+                static inline D abs(D a) { return std::fabs(a); }
+                static inline M lt(D a, D b) { return a < b; }
+                static inline M eq(D a, D b) { return a == b; }
+                static inline M or_(M a, M b) { return a || b; }
+                static inline M xor_(M a, M b) { return a != b; }
+                static inline D select(M m, D a, D b) { return m ? a : b; }
+                static inline bool none(M m) { return !m; }
+            };
+#include "utm_kernel.h"
+        } // end namespace scalar
+
+#ifdef UTM_HAVE_X86_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+        /// Two lanes of SSE4.1
+        namespace sse41
+        {
+            struct V
+            {
+                typedef __m128d D;
+                typedef __m128d M;
+                enum { width = 2 };
+
+                static inline D set1(double a) { return _mm_set1_pd(a); }
+                static inline D loadu(const double *p) { return _mm_loadu_pd(p); }
+                static inline void storeu(double *p, D a) { _mm_storeu_pd(p, a); }
+                static inline D add(D a, D b) { return _mm_add_pd(a, b); }
+                static inline D sub(D a, D b) { return _mm_sub_pd(a, b); }
+                static inline D mul(D a, D b) { return _mm_mul_pd(a, b); }
+                static inline D div(D a, D b) { return _mm_div_pd(a, b); }
+                static inline D sqrt(D a) { return _mm_sqrt_pd(a); }
+                static inline D floor(D a) { return _mm_floor_pd(a); }
+                static inline D abs(D a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+                static inline M lt(D a, D b) { return _mm_cmplt_pd(a, b); }
+                static inline M eq(D a, D b) { return _mm_cmpeq_pd(a, b); }
+                static inline M or_(M a, M b) { return _mm_or_pd(a, b); }
+                static inline M xor_(M a, M b) { return _mm_xor_pd(a, b); }
+                static inline D select(M m, D a, D b) { return _mm_blendv_pd(b, a, m); }
+                static inline bool none(M m) { return _mm_movemask_pd(m) == 0; }
+            };
+#include "utm_kernel.h"
+        } // end namespace sse41
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+        /// Four lanes of AVX2
+        namespace avx2
+        {
+            struct V
+            {
+                typedef __m256d D;
+                typedef __m256d M;
+                enum { width = 4 };
+
+                static inline D set1(double a) { return _mm256_set1_pd(a); }
+                static inline D loadu(const double *p) { return _mm256_loadu_pd(p); }
+                static inline void storeu(double *p, D a) { _mm256_storeu_pd(p, a); }
+                static inline D add(D a, D b) { return _mm256_add_pd(a, b); }
+                static inline D sub(D a, D b) { return _mm256_sub_pd(a, b); }
+                static inline D mul(D a, D b) { return _mm256_mul_pd(a, b); }
+                static inline D div(D a, D b) { return _mm256_div_pd(a, b); }
+                static inline D sqrt(D a) { return _mm256_sqrt_pd(a); }
+                static inline D floor(D a) { return _mm256_floor_pd(a); }
+                static inline D abs(D a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+                static inline M lt(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+                static inline M eq(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+                static inline M or_(M a, M b) { return _mm256_or_pd(a, b); }
+                static inline M xor_(M a, M b) { return _mm256_xor_pd(a, b); }
+                static inline D select(M m, D a, D b) { return _mm256_blendv_pd(b, a, m); }
+                static inline bool none(M m) { return _mm256_movemask_pd(m) == 0; }
+            };
+#include "utm_kernel.h"
+        } // end namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // UTM_HAVE_X86_DISPATCH
+    } // end namespace batch_detail
+
+    /// Instruction set used by the batch conversions.
+    enum SimdLevel {
+        SIMD_SCALAR,
+        SIMD_SSE41,
+        SIMD_AVX2
+    };
+
+    /**
+     * Best instruction set supported by the running CPU. Detected once.
+     */
+    static inline SimdLevel DetectSimdLevel()
+    {
+#ifdef UTM_HAVE_X86_DISPATCH
+        static const SimdLevel level =
+                __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? SIMD_AVX2 :
+                __builtin_cpu_supports("sse4.1") ? SIMD_SSE41 : SIMD_SCALAR;
+        return level;
+#else
+        return SIMD_SCALAR;
+#endif
+    }
+
+    namespace batch_detail
+    {
+        typedef TabulatedTransverseMercator<WGS84> Tabulated;
+
+        /**
+         * Chunked driver of the batch LLtoUTM(). Zones, and with table set
+         * the tabulated latitude terms, are worked out in plain scalar code,
+         * so the kernels never call out of their instruction set.
+         */
+        static inline void LLtoUTMChunks(const double *Lat, const double *Long, std::size_t count,
+                                         double *UTMNorthing, double *UTMEasting,
+                                         int *ZoneNumber, char *ZoneLetter,
+                                         bool table, SimdLevel level)
+        {
+            if(level > DetectSimdLevel())
+                level = DetectSimdLevel();
+
+            double LongRel[chunk_size];
+            double Terms[4][chunk_size];
+            for(std::size_t i = 0; i < count; i += chunk_size) {
+                const std::size_t m = (count - i < chunk_size) ? count - i : chunk_size;
+                for(std::size_t k = 0; k < m; ++k) {
+                    double LongTemp = NormalizeLongitude(Long[i+k]);
+                    int zone = UTMZoneNumber(Lat[i+k], LongTemp);
+                    ZoneNumber[i+k] = zone;
+                    ZoneLetter[i+k] = UTMLetterDesignator(Lat[i+k]);
+                    LongRel[k] = LongTemp - ((zone - 1)*6 - 180 + 3);
+                    if(table) {
+                        double terms[4];
+                        Tabulated::ForwardTerms(Lat[i+k]*DEG_TO_RAD, terms);
+                        for(int t = 0; t < 4; ++t)
+                            Terms[t][k] = terms[t];
+                    }
+                }
+
+                switch(level) {
+#ifdef UTM_HAVE_X86_DISPATCH
+                case SIMD_AVX2:
+                    if(table)
+                        avx2::LLtoUTMTermsChunk(Lat + i, LongRel, Terms, m,
+                                                UTMNorthing + i, UTMEasting + i);
+                    else
+                        avx2::LLtoUTMChunk(Lat + i, LongRel, m, UTMNorthing + i, UTMEasting + i);
+                    break;
+                case SIMD_SSE41:
+                    if(table)
+                        sse41::LLtoUTMTermsChunk(Lat + i, LongRel, Terms, m,
+                                                 UTMNorthing + i, UTMEasting + i);
+                    else
+                        sse41::LLtoUTMChunk(Lat + i, LongRel, m, UTMNorthing + i, UTMEasting + i);
+                    break;
+#endif
+                default:
+                    if(table)
+                        scalar::LLtoUTMTermsChunk(Lat + i, LongRel, Terms, m,
+                                                  UTMNorthing + i, UTMEasting + i);
+                    else
+                        scalar::LLtoUTMChunk(Lat + i, LongRel, m, UTMNorthing + i, UTMEasting + i);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Chunked driver of the batch UTMtoLL(), see LLtoUTMChunks().
+         */
+        static inline void UTMtoLLChunks(const double *UTMNorthing, const double *UTMEasting,
+                                         const int *ZoneNumber, const char *ZoneLetter,
+                                         std::size_t count, double *Lat, double *Long,
+                                         bool table, SimdLevel level)
+        {
+            if(level > DetectSimdLevel())
+                level = DetectSimdLevel();
+
+            double x[chunk_size];
+            double y[chunk_size];
+            double LongOrigin[chunk_size];
+            double Terms[4][chunk_size];
+            for(std::size_t i = 0; i < count; i += chunk_size) {
+                const std::size_t m = (count - i < chunk_size) ? count - i : chunk_size;
+                for(std::size_t k = 0; k < m; ++k) {
+                    //remove 500,000 meter offset for longitude
+                    x[k] = UTMEasting[i+k] - UTM_FE;
+                    y[k] = UTMNorthing[i+k];
+                    if((ZoneLetter[i+k] - 'N') < 0)
+                        y[k] -= UTM_FN_S;
+                    //+3 puts origin in middle of zone
+                    LongOrigin[k] = (ZoneNumber[i+k] - 1)*6 - 180 + 3;
+                    if(table) {
+                        double terms[4];
+                        Tabulated::ReverseTerms(y[k]/(UTM_K0*Projection::a*Projection::M0), terms);
+                        for(int t = 0; t < 4; ++t)
+                            Terms[t][k] = terms[t];
+                    }
+                }
+
+                switch(level) {
+#ifdef UTM_HAVE_X86_DISPATCH
+                case SIMD_AVX2:
+                    if(table)
+                        avx2::UTMtoLLTermsChunk(x, Terms, LongOrigin, m, Lat + i, Long + i);
+                    else
+                        avx2::UTMtoLLChunk(x, y, LongOrigin, m, Lat + i, Long + i);
+                    break;
+                case SIMD_SSE41:
+                    if(table)
+                        sse41::UTMtoLLTermsChunk(x, Terms, LongOrigin, m, Lat + i, Long + i);
+                    else
+                        sse41::UTMtoLLChunk(x, y, LongOrigin, m, Lat + i, Long + i);
+                    break;
+#endif
+                default:
+                    if(table)
+                        scalar::UTMtoLLTermsChunk(x, Terms, LongOrigin, m, Lat + i, Long + i);
+                    else
+                        scalar::UTMtoLLChunk(x, y, LongOrigin, m, Lat + i, Long + i);
+                    break;
+                }
+            }
+        }
+    } // end namespace batch_detail
+
+    /**
+     * Convert arrays of lat/long to UTM coords.
+     *
+     * Same equations as the single point LLtoUTM(), evaluated on
+     * structure-of-arrays input with SSE4.1/AVX2 kernels when the CPU has
+     * them. The zone is returned as a number and a letter per point instead
+     * of a formatted string. Results agree with the single point version
+     * to well below a millimetre.
+     *
+     * @param level  instruction set to use, defaults to the best available.
+     *               Asking for more than the CPU supports falls back to
+     *               DetectSimdLevel().
+     */
+    static inline void LLtoUTM(const double *Lat, const double *Long, std::size_t count,
+                               double *UTMNorthing, double *UTMEasting,
+                               int *ZoneNumber, char *ZoneLetter,
+                               SimdLevel level = DetectSimdLevel())
+    {
+        batch_detail::LLtoUTMChunks(Lat, Long, count, UTMNorthing, UTMEasting,
+                                    ZoneNumber, ZoneLetter, false, level);
+    }
+
+    /**
+     * Convert arrays of UTM coords to lat/long.
+     *
+     * Batch counterpart of UTMtoLL(), see LLtoUTM() above for details.
+     */
+    static inline void UTMtoLL(const double *UTMNorthing, const double *UTMEasting,
+                               const int *ZoneNumber, const char *ZoneLetter,
+                               std::size_t count, double *Lat, double *Long,
+                               SimdLevel level = DetectSimdLevel())
+    {
+        batch_detail::UTMtoLLChunks(UTMNorthing, UTMEasting, ZoneNumber, ZoneLetter,
+                                    count, Lat, Long, false, level);
+    }
+    /**
+     * Batch LLtoUTM() with a choice of projection. ENGINE_FAST is the
+     * vectorized path above, ENGINE_TABLE the same kernels with the
+     * latitude terms looked up instead of evaluated; ENGINE_PRECISE
+     * evaluates the Krüger series point by point.
+     */
+    static inline void LLtoUTM(const double *Lat, const double *Long, std::size_t count,
+                               double *UTMNorthing, double *UTMEasting,
+                               int *ZoneNumber, char *ZoneLetter,
+                               Engine engine, SimdLevel level = DetectSimdLevel())
+    {
+        if(engine != ENGINE_PRECISE) {
+            batch_detail::LLtoUTMChunks(Lat, Long, count, UTMNorthing, UTMEasting,
+                                        ZoneNumber, ZoneLetter, engine == ENGINE_TABLE, level);
+            return;
+        }
+        for(std::size_t i = 0; i < count; ++i) {
+            UtmZone Zone;
+            KrugerTransverseMercator<WGS84>::LLtoUTM(Lat[i], Long[i], UTMNorthing[i],
+                                                     UTMEasting[i], Zone);
+            ZoneNumber[i] = Zone.number;
+            ZoneLetter[i] = Zone.band;
+        }
+    }
+
+    /**
+     * Batch UTMtoLL() with a choice of projection, see above.
+     */
+    static inline void UTMtoLL(const double *UTMNorthing, const double *UTMEasting,
+                               const int *ZoneNumber, const char *ZoneLetter,
+                               std::size_t count, double *Lat, double *Long,
+                               Engine engine, SimdLevel level = DetectSimdLevel())
+    {
+        if(engine != ENGINE_PRECISE) {
+            batch_detail::UTMtoLLChunks(UTMNorthing, UTMEasting, ZoneNumber, ZoneLetter,
+                                        count, Lat, Long, engine == ENGINE_TABLE, level);
+            return;
+        }
+        for(std::size_t i = 0; i < count; ++i) {
+            const UtmZone Zone = { uint8_t(ZoneNumber[i]), ZoneLetter[i] };
+            KrugerTransverseMercator<WGS84>::UTMtoLL(UTMNorthing[i], UTMEasting[i], Zone,
+                                                     Lat[i], Long[i]);
+        }
+    }
+} // end namespace UTM
+
+#endif // _UTM_H
+
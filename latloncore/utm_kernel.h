@@ -0,0 +1,452 @@
+/* -*- mode: C++ -*-
+ *
+ *  Batch kernels for the Latitude/Longitude <-> UTM conversions.
+ *
+ *  License: Modified BSD Software License Agreement
+ */
+
+/**  @file
+ @brief Vector-width agnostic UTM batch kernels.
+
+ This file has no include guard on purpose. utm.h includes it once per
+ instruction set, inside a namespace that provides a vector type `V`
+ (see UTM::batch_detail), and under the matching compiler target options.
+ It must not be included from anywhere else.
+
+ The ellipsoid constants come from `Projection`, a TransverseMercator
+ instantiation declared next to `V`'s namespace.
+
+ `V` provides:
+   - `D` (vector of doubles), `M` (lane mask) and `width`
+   - set1, loadu, storeu, add, sub, mul, div, sqrt, floor, abs
+   - lt, eq, or_, xor_ (mask producing/combining) and select(mask, a, b)
+ */
+
+    /**
+     * Simultaneous sine and cosine using the Cephes polynomials.
+     *
+     * The argument is reduced to [-pi/4, pi/4] with a three part Cody-Waite
+     * reduction which is accurate to full double precision for the argument
+     * range used by the UTM series (|x| < 6*pi).
+     */
+    static inline void SinCos(V::D x, V::D &s, V::D &c)
+    {
+        const V::D zero = V::set1(0.0);
+        const V::D one  = V::set1(1.0);
+        const V::D two  = V::set1(2.0);
+        const V::D four = V::set1(4.0);
+        const V::D six  = V::set1(6.0);
+        const V::D eight = V::set1(8.0);
+
+        V::D ax = V::abs(x);
+
+        // octant, rounded to the next even value as in Cephes sin()/cos()
+        V::D y = V::floor(V::mul(ax, V::set1(1.27323954473516268615)));
+        V::D j = V::sub(y, V::mul(eight, V::floor(V::mul(y, V::set1(0.125)))));
+        V::M odd = V::eq(V::sub(j, V::mul(two, V::floor(V::mul(j, V::set1(0.5))))), one);
+        y = V::select(odd, V::add(y, one), y);
+        j = V::select(odd, V::add(j, one), j);
+        j = V::select(V::eq(j, eight), zero, j);
+
+        V::D z = V::sub(V::sub(V::sub(ax, V::mul(y, V::set1(7.85398125648498535156E-1))),
+                               V::mul(y, V::set1(3.77489470793079817668E-8))),
+                        V::mul(y, V::set1(2.69515142907905952645E-15)));
+        V::D zz = V::mul(z, z);
+
+        V::D ps = V::set1(1.58962301576546568060E-10);
+        ps = V::add(V::mul(ps, zz), V::set1(-2.50507477628578072866E-8));
+        ps = V::add(V::mul(ps, zz), V::set1(2.75573136213857245213E-6));
+        ps = V::add(V::mul(ps, zz), V::set1(-1.98412698295895385996E-4));
+        ps = V::add(V::mul(ps, zz), V::set1(8.33333333332211858878E-3));
+        ps = V::add(V::mul(ps, zz), V::set1(-1.66666666666666307295E-1));
+        ps = V::add(z, V::mul(V::mul(z, zz), ps));
+
+        V::D pc = V::set1(-1.13585365213876817300E-11);
+        pc = V::add(V::mul(pc, zz), V::set1(2.08757008419747316778E-9));
+        pc = V::add(V::mul(pc, zz), V::set1(-2.75573141792967388112E-7));
+        pc = V::add(V::mul(pc, zz), V::set1(2.48015872888517045348E-5));
+        pc = V::add(V::mul(pc, zz), V::set1(-1.38888888888730564116E-3));
+        pc = V::add(V::mul(pc, zz), V::set1(4.16666666666665929218E-2));
+        pc = V::add(V::sub(one, V::mul(V::set1(0.5), zz)), V::mul(V::mul(zz, zz), pc));
+
+        // octants 2 and 6 swap the sine and cosine polynomials
+        V::M swap = V::or_(V::eq(j, two), V::eq(j, six));
+        V::D sv = V::select(swap, pc, ps);
+        V::D cv = V::select(swap, ps, pc);
+
+        // sin is negative in octants 4 and 6 (mirrored for negative x),
+        // cos is negative in octants 2 and 4
+        V::M sinNeg = V::xor_(V::lt(V::set1(3.0), j), V::lt(x, zero));
+        V::M cosNeg = V::or_(V::eq(j, two), V::eq(j, four));
+
+        s = V::select(sinNeg, V::sub(zero, sv), sv);
+        c = V::select(cosNeg, V::sub(zero, cv), cv);
+    }
+
+    /**
+     * atan2() using the Cephes atan polynomial, full double precision.
+     * Returns +pi for y == -0, x < 0.
+     */
+    static inline V::D Atan2(V::D y, V::D x)
+    {
+        const V::D zero = V::set1(0.0);
+        const V::D one = V::set1(1.0);
+        const double moreBits = 6.123233995736765886130E-17;   // pi/2 - double(pi/2)
+
+        V::D ax = V::abs(x);
+        V::D ay = V::abs(y);
+
+        // atan of min/max in [0, 1]; both zero gives 0
+        V::M swap = V::lt(ax, ay);
+        V::D num = V::select(swap, ax, ay);
+        V::D den = V::select(swap, ay, ax);
+        den = V::select(V::eq(den, zero), one, den);
+        V::D t = V::div(num, den);
+
+        // above 0.66 use atan(t) = pi/4 + atan((t - 1) / (t + 1))
+        V::M big = V::lt(V::set1(0.66), t);
+        t = V::select(big, V::div(V::sub(t, one), V::add(t, one)), t);
+
+        V::D z = V::mul(t, t);
+        V::D p = V::set1(-8.750608600031904122785E-1);
+        p = V::add(V::mul(p, z), V::set1(-1.615753718733365076637E1));
+        p = V::add(V::mul(p, z), V::set1(-7.500855792314704667340E1));
+        p = V::add(V::mul(p, z), V::set1(-1.228866684490136173410E2));
+        p = V::add(V::mul(p, z), V::set1(-6.485021904942025371773E1));
+        V::D q = V::add(z, V::set1(2.485846490142306297962E1));
+        q = V::add(V::mul(q, z), V::set1(1.650270098316988542046E2));
+        q = V::add(V::mul(q, z), V::set1(4.328810604912902668951E2));
+        q = V::add(V::mul(q, z), V::set1(4.853903996359136964868E2));
+        q = V::add(V::mul(q, z), V::set1(1.945506571482613964425E2));
+
+        V::D r = V::add(V::mul(t, V::div(V::mul(z, p), q)), t);
+        r = V::select(big, V::add(V::set1(0.78539816339744830962),
+                                  V::add(r, V::set1(0.5*moreBits))), r);
+
+        // back to the octant, quadrant and sign of (x, y)
+        r = V::select(swap, V::add(V::sub(V::set1(1.57079632679489661923), r), V::set1(moreBits)), r);
+        r = V::select(V::lt(x, zero), V::add(V::sub(V::set1(3.14159265358979323846), r),
+                                             V::set1(2*moreBits)), r);
+        return V::select(V::lt(y, zero), V::sub(zero, r), r);
+    }
+
+    /**
+     * Transverse Mercator series of LLtoUTMBlock() from the latitude terms:
+     * meridian arc M, radius of curvature N and sin/cos of the latitude.
+     */
+    static inline void LLtoUTMSeries(V::D lat, V::D LongRel, V::D M, V::D N, V::D s, V::D c,
+                                     double *UTMNorthing, double *UTMEasting)
+    {
+        const double eccPrimeSquared = Projection::ep2;
+
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+        const V::D k0 = V::set1(UTM_K0);
+        const V::D ep2 = V::set1(eccPrimeSquared);
+
+        V::D t = V::div(s, c);
+        V::D T = V::mul(t, t);
+        V::D C = V::mul(ep2, V::mul(c, c));
+        V::D A = V::mul(c, V::mul(LongRel, V::set1(DEG_TO_RAD)));
+
+        V::D A2 = V::mul(A, A);
+        V::D A3 = V::mul(A2, A);
+        V::D A4 = V::mul(A2, A2);
+        V::D A5 = V::mul(A4, A);
+        V::D A6 = V::mul(A4, A2);
+        V::D T2 = V::mul(T, T);
+
+        // (1-T+C)*A^3/6 + (5-18T+T^2+72C-58e'^2)*A^5/120
+        V::D e = V::div(V::mul(V::add(V::sub(one, T), C), A3), V::set1(6.0));
+        V::D p = V::add(V::sub(V::set1(5 - 58*eccPrimeSquared), V::mul(V::set1(18.0), T)),
+                        V::add(T2, V::mul(V::set1(72.0), C)));
+        e = V::add(e, V::div(V::mul(p, A5), V::set1(120.0)));
+        V::D easting = V::add(V::mul(V::mul(k0, N), V::add(A, e)), V::set1(UTM_FE));
+
+        // A^2/2 + (5-T+9C+4C^2)*A^4/24 + (61-58T+T^2+600C-330e'^2)*A^6/720
+        V::D q = V::div(A2, two);
+        p = V::add(V::sub(V::set1(5.0), T),
+                   V::add(V::mul(V::set1(9.0), C), V::mul(V::set1(4.0), V::mul(C, C))));
+        q = V::add(q, V::div(V::mul(p, A4), V::set1(24.0)));
+        p = V::add(V::sub(V::set1(61 - 330*eccPrimeSquared), V::mul(V::set1(58.0), T)),
+                   V::add(T2, V::mul(V::set1(600.0), C)));
+        q = V::add(q, V::div(V::mul(p, A6), V::set1(720.0)));
+        V::D northing = V::mul(k0, V::add(M, V::mul(V::mul(N, t), q)));
+
+        //10000000 meter offset for southern hemisphere
+        northing = V::select(V::lt(lat, V::set1(0.0)),
+                             V::add(northing, V::set1(UTM_FN_S)), northing);
+
+        V::storeu(UTMNorthing, northing);
+        V::storeu(UTMEasting, easting);
+    }
+
+    /**
+     * Convert V::width points to UTM northing/easting.
+     *
+     * LongRel is the longitude relative to the zone's central meridian
+     * in degrees; the zone itself is worked out by the caller.
+     */
+    static inline void LLtoUTMBlock(const double *Lat, const double *LongRel,
+                                    double *UTMNorthing, double *UTMEasting)
+    {
+        const double eccSquared = Projection::e2;
+
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+        const V::D a = V::set1(Projection::a);
+
+        V::D lat = V::loadu(Lat);
+        V::D latRad = V::mul(lat, V::set1(DEG_TO_RAD));
+
+        V::D s, c;
+        SinCos(latRad, s, c);
+
+        V::D N = V::div(a, V::sqrt(V::sub(one, V::mul(V::set1(eccSquared), V::mul(s, s)))));
+
+        // multiple angles for the meridian arc
+        V::D sin2 = V::mul(two, V::mul(s, c));
+        V::D cos2 = V::sub(V::mul(c, c), V::mul(s, s));
+        V::D sin4 = V::mul(two, V::mul(sin2, cos2));
+        V::D cos4 = V::sub(one, V::mul(two, V::mul(sin2, sin2)));
+        V::D sin6 = V::add(V::mul(sin4, cos2), V::mul(cos4, sin2));
+
+        V::D M = V::mul(V::set1(Projection::M0), latRad);
+        M = V::sub(M, V::mul(V::set1(Projection::M2), sin2));
+        M = V::add(M, V::mul(V::set1(Projection::M4), sin4));
+        M = V::sub(M, V::mul(V::set1(Projection::M6), sin6));
+        M = V::mul(a, M);
+
+        LLtoUTMSeries(lat, V::loadu(LongRel), M, N, s, c, UTMNorthing, UTMEasting);
+    }
+
+    /**
+     * LLtoUTMBlock() with the latitude terms given, see LLtoUTMSeries().
+     */
+    static inline void LLtoUTMTermsBlock(const double *Lat, const double *LongRel,
+                                         const double *M, const double *N,
+                                         const double *S, const double *C,
+                                         double *UTMNorthing, double *UTMEasting)
+    {
+        LLtoUTMSeries(V::loadu(Lat), V::loadu(LongRel), V::loadu(M), V::loadu(N),
+                      V::loadu(S), V::loadu(C), UTMNorthing, UTMEasting);
+    }
+
+    /**
+     * Transverse Mercator series of UTMtoLLBlock() from the footpoint
+     * latitude phi1 and its terms: sin/cos and sw = sqrt(1-e^2 sin^2 phi1).
+     */
+    static inline void UTMtoLLSeries(V::D x, V::D phi1Rad, V::D s, V::D c, V::D sw,
+                                     V::D LongOrigin, double *Lat, double *Long)
+    {
+        const double eccSquared = Projection::e2;
+        const double eccPrimeSquared = Projection::ep2;
+
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+        const V::D a = V::set1(Projection::a);
+        const V::D k0 = V::set1(UTM_K0);
+
+        V::D w = V::mul(sw, sw);
+        V::D N1 = V::div(a, sw);
+        V::D t1 = V::div(s, c);
+        V::D T1 = V::mul(t1, t1);
+        V::D C1 = V::mul(V::set1(eccPrimeSquared), V::mul(c, c));
+        V::D R1 = V::div(V::set1(Projection::a*(1-eccSquared)), V::mul(w, sw));
+        V::D D = V::div(x, V::mul(N1, k0));
+
+        V::D D2 = V::mul(D, D);
+        V::D D3 = V::mul(D2, D);
+        V::D D4 = V::mul(D2, D2);
+        V::D D5 = V::mul(D4, D);
+        V::D D6 = V::mul(D4, D2);
+        V::D C12 = V::mul(C1, C1);
+
+        // D^2/2 - (5+3T1+10C1-4C1^2-9e'^2)*D^4/24
+        //       + (61+90T1+298C1+45T1^2-252e'^2-3C1^2)*D^6/720
+        V::D p = V::add(V::set1(5 - 9*eccPrimeSquared),
+                        V::add(V::mul(V::set1(3.0), T1), V::mul(V::set1(10.0), C1)));
+        p = V::sub(p, V::mul(V::set1(4.0), C12));
+        V::D q = V::sub(V::div(D2, two), V::div(V::mul(p, D4), V::set1(24.0)));
+        p = V::add(V::set1(61 - 252*eccPrimeSquared),
+                   V::add(V::mul(V::set1(90.0), T1), V::mul(V::set1(298.0), C1)));
+        p = V::sub(V::add(p, V::mul(V::set1(45.0), V::mul(T1, T1))), V::mul(V::set1(3.0), C12));
+        q = V::add(q, V::div(V::mul(p, D6), V::set1(720.0)));
+        V::D lat = V::sub(phi1Rad, V::mul(V::div(V::mul(N1, t1), R1), q));
+
+        // (D-(1+2T1+C1)*D^3/6 + (5-2C1+28T1-3C1^2+8e'^2+24T1^2)*D^5/120) / cos(phi1)
+        p = V::add(one, V::add(V::mul(two, T1), C1));
+        q = V::sub(D, V::div(V::mul(p, D3), V::set1(6.0)));
+        p = V::add(V::set1(5 + 8*eccPrimeSquared),
+                   V::sub(V::mul(V::set1(28.0), T1), V::mul(two, C1)));
+        p = V::add(V::sub(p, V::mul(V::set1(3.0), C12)), V::mul(V::set1(24.0), V::mul(T1, T1)));
+        q = V::add(q, V::div(V::mul(p, D5), V::set1(120.0)));
+        V::D lon = V::div(q, c);
+
+        V::storeu(Lat, V::mul(lat, V::set1(RAD_TO_DEG)));
+        V::storeu(Long, V::add(LongOrigin, V::mul(lon, V::set1(RAD_TO_DEG))));
+    }
+
+    /**
+     * Convert V::width UTM points back to lat/long.
+     *
+     * X and Y have the false easting and (southern) false northing already
+     * removed, LongOrigin is the zone's central meridian in degrees.
+     */
+    static inline void UTMtoLLBlock(const double *X, const double *Y,
+                                    const double *LongOrigin,
+                                    double *Lat, double *Long)
+    {
+        const double eccSquared = Projection::e2;
+
+        const V::D one = V::set1(1.0);
+        const V::D two = V::set1(2.0);
+
+        V::D mu = V::div(V::loadu(Y),
+                         V::set1(UTM_K0*Projection::a*Projection::M0));
+
+        V::D s, c;
+        SinCos(mu, s, c);
+        V::D sin2 = V::mul(two, V::mul(s, c));
+        V::D cos2 = V::sub(V::mul(c, c), V::mul(s, s));
+        V::D sin4 = V::mul(two, V::mul(sin2, cos2));
+        V::D cos4 = V::sub(one, V::mul(two, V::mul(sin2, sin2)));
+        V::D sin6 = V::add(V::mul(sin4, cos2), V::mul(cos4, sin2));
+
+        V::D phi1Rad = V::add(mu, V::mul(V::set1(Projection::P2), sin2));
+        phi1Rad = V::add(phi1Rad, V::mul(V::set1(Projection::P4), sin4));
+        phi1Rad = V::add(phi1Rad, V::mul(V::set1(Projection::P6), sin6));
+
+        SinCos(phi1Rad, s, c);
+        V::D sw = V::sqrt(V::sub(one, V::mul(V::set1(eccSquared), V::mul(s, s))));
+
+        UTMtoLLSeries(V::loadu(X), phi1Rad, s, c, sw, V::loadu(LongOrigin), Lat, Long);
+    }
+
+    /**
+     * UTMtoLLBlock() with the footpoint terms given, see UTMtoLLSeries().
+     */
+    static inline void UTMtoLLTermsBlock(const double *X, const double *Phi1,
+                                         const double *S, const double *C, const double *SW,
+                                         const double *LongOrigin, double *Lat, double *Long)
+    {
+        UTMtoLLSeries(V::loadu(X), V::loadu(Phi1), V::loadu(S), V::loadu(C), V::loadu(SW),
+                      V::loadu(LongOrigin), Lat, Long);
+    }
+
+    /**
+     * Run LLtoUTMBlock() over count points, padding the last partial block.
+     */
+    static inline void LLtoUTMChunk(const double *Lat, const double *LongRel, std::size_t count,
+                                    double *UTMNorthing, double *UTMEasting)
+    {
+        const std::size_t W = V::width;
+        std::size_t i = 0;
+        for(; i + W <= count; i += W)
+            LLtoUTMBlock(Lat + i, LongRel + i, UTMNorthing + i, UTMEasting + i);
+
+        if(i < count) {
+            double lat[V::width], rel[V::width], n[V::width], e[V::width];
+            for(std::size_t k = 0; k < W; ++k) {
+                // pad with a copy of the first remaining point
+                lat[k] = Lat[i + (i + k < count ? k : 0)];
+                rel[k] = LongRel[i + (i + k < count ? k : 0)];
+            }
+            LLtoUTMBlock(lat, rel, n, e);
+            for(std::size_t k = 0; i + k < count; ++k) {
+                UTMNorthing[i+k] = n[k];
+                UTMEasting[i+k] = e[k];
+            }
+        }
+    }
+
+    /**
+     * Run UTMtoLLBlock() over count points, padding the last partial block.
+     */
+    static inline void UTMtoLLChunk(const double *X, const double *Y, const double *LongOrigin,
+                                    std::size_t count, double *Lat, double *Long)
+    {
+        const std::size_t W = V::width;
+        std::size_t i = 0;
+        for(; i + W <= count; i += W)
+            UTMtoLLBlock(X + i, Y + i, LongOrigin + i, Lat + i, Long + i);
+
+        if(i < count) {
+            double x[V::width], y[V::width], origin[V::width], lat[V::width], lon[V::width];
+            for(std::size_t k = 0; k < W; ++k) {
+                const std::size_t src = i + (i + k < count ? k : 0);
+                x[k] = X[src];
+                y[k] = Y[src];
+                origin[k] = LongOrigin[src];
+            }
+            UTMtoLLBlock(x, y, origin, lat, lon);
+            for(std::size_t k = 0; i + k < count; ++k) {
+                Lat[i+k] = lat[k];
+                Long[i+k] = lon[k];
+            }
+        }
+    }
+
+    /**
+     * Run LLtoUTMTermsBlock() over count points, padding the last partial
+     * block. Terms holds M, N, sin and cos of the latitude per point.
+     */
+    static inline void LLtoUTMTermsChunk(const double *Lat, const double *LongRel,
+                                         const double (*Terms)[chunk_size], std::size_t count,
+                                         double *UTMNorthing, double *UTMEasting)
+    {
+        const std::size_t W = V::width;
+        std::size_t i = 0;
+        for(; i + W <= count; i += W)
+            LLtoUTMTermsBlock(Lat + i, LongRel + i, Terms[0] + i, Terms[1] + i,
+                              Terms[2] + i, Terms[3] + i, UTMNorthing + i, UTMEasting + i);
+
+        if(i < count) {
+            double lat[V::width], rel[V::width], terms[4][V::width], n[V::width], e[V::width];
+            for(std::size_t k = 0; k < W; ++k) {
+                // pad with a copy of the first remaining point
+                const std::size_t src = i + (i + k < count ? k : 0);
+                lat[k] = Lat[src];
+                rel[k] = LongRel[src];
+                for(int t = 0; t < 4; ++t)
+                    terms[t][k] = Terms[t][src];
+            }
+            LLtoUTMTermsBlock(lat, rel, terms[0], terms[1], terms[2], terms[3], n, e);
+            for(std::size_t k = 0; i + k < count; ++k) {
+                UTMNorthing[i+k] = n[k];
+                UTMEasting[i+k] = e[k];
+            }
+        }
+    }
+
+    /**
+     * Run UTMtoLLTermsBlock() over count points, padding the last partial
+     * block. Terms holds phi1, sin(phi1), cos(phi1) and
+     * sqrt(1-e^2 sin^2 phi1) per point.
+     */
+    static inline void UTMtoLLTermsChunk(const double *X, const double (*Terms)[chunk_size],
+                                         const double *LongOrigin, std::size_t count,
+                                         double *Lat, double *Long)
+    {
+        const std::size_t W = V::width;
+        std::size_t i = 0;
+        for(; i + W <= count; i += W)
+            UTMtoLLTermsBlock(X + i, Terms[0] + i, Terms[1] + i, Terms[2] + i, Terms[3] + i,
+                              LongOrigin + i, Lat + i, Long + i);
+
+        if(i < count) {
+            double x[V::width], terms[4][V::width], origin[V::width], lat[V::width], lon[V::width];
+            for(std::size_t k = 0; k < W; ++k) {
+                const std::size_t src = i + (i + k < count ? k : 0);
+                x[k] = X[src];
+                origin[k] = LongOrigin[src];
+                for(int t = 0; t < 4; ++t)
+                    terms[t][k] = Terms[t][src];
+            }
+            UTMtoLLTermsBlock(x, terms[0], terms[1], terms[2], terms[3], origin, lat, lon);
+            for(std::size_t k = 0; i + k < count; ++k) {
+                Lat[i+k] = lat[k];
+                Long[i+k] = lon[k];
+            }
+        }
+    }
@@ -0,0 +1,15 @@
+# Command line bulk exporter for positions (DD/DMS/UTM text).
+
+TEMPLATE = app
+CONFIG += c++17 console thread
+CONFIG -= qt app_bundle
+
+TARGET = latlon_export
+
+INCLUDEPATH += $$PWD/../latloncore
+DEPENDPATH += $$PWD/../latloncore
+LIBS += -L$$OUT_PWD/../latloncore -llatloncore
+PRE_TARGETDEPS += $$OUT_PWD/../latloncore/$${QMAKE_PREFIX_STATICLIB}latloncore.$${QMAKE_EXTENSION_STATICLIB}
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,175 @@
+#include "latlonexport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LATLON_HAVE_MMAP 1
+#endif
+
+namespace {
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "Usage: latlon_export [-f dd|dd-dir|dms|utm] [-e fast|precise|table] [-t threads]\n"
+                 "                     [-s separator] [-c chunk] <positions.bin> [output.txt]\n"
+                 "\n"
+                 "positions.bin holds (latitude, longitude) pairs of native doubles.\n"
+                 "Writes one line per position to output.txt, or to stdout.\n");
+}
+
+///
+/// \brief Read-only view of the input file, memory-mapped where possible.
+///
+class InputFile
+{
+public:
+    ~InputFile()
+    {
+#ifdef LATLON_HAVE_MMAP
+        if( m_map )
+            munmap(m_map, m_size);
+#endif
+    }
+
+    bool open(const char *path)
+    {
+#ifdef LATLON_HAVE_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if( fd < 0 )
+            return false;
+        struct stat st;
+        if( fstat(fd, &st) == 0 && st.st_size > 0 ) {
+            m_size = std::size_t(st.st_size);
+            void *map = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if( map != MAP_FAILED ) {
+                m_map = map;
+                madvise(m_map, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        if( m_map || m_size == 0 )
+            return true;
+#endif
+        // no mmap, read it into memory
+        FILE *f = std::fopen(path, "rb");
+        if( !f )
+            return false;
+        char buf[1 << 16];
+        std::size_t n;
+        while( (n = std::fread(buf, 1, sizeof(buf), f)) > 0 )
+            m_copy.insert(m_copy.end(), buf, buf + n);
+        std::fclose(f);
+        m_size = m_copy.size();
+        return true;
+    }
+
+    const void *data() const { return m_map ? m_map : static_cast<const void *>(m_copy.data()); }
+    std::size_t size() const { return m_size; }
+
+private:
+    void *m_map {};
+    std::size_t m_size {};
+    std::vector<char> m_copy;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    LatLonExport::Options options;
+    const char *input = nullptr;
+    const char *output = nullptr;
+
+    for( int i = 1; i < argc; ++i ) {
+        const char *arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if( std::strcmp(arg, "-f") == 0 && hasValue ) {
+            const char *f = argv[++i];
+            if( std::strcmp(f, "dd") == 0 ) {
+                options.format = LatLonFormat::eDECIMAL_DEG;
+            } else if( std::strcmp(f, "dd-dir") == 0 ) {
+                options.format = LatLonFormat::eDECIMAL_DEG;
+                options.notation = LatLonFormat::NotationType::eDIRECTION;
+            } else if( std::strcmp(f, "dms") == 0 ) {
+                options.format = LatLonFormat::eDMS;
+            } else if( std::strcmp(f, "utm") == 0 ) {
+                options.format = LatLonFormat::eUTM;
+            } else {
+                usage();
+                return 2;
+            }
+        } else if( std::strcmp(arg, "-e") == 0 && hasValue ) {
+            const char *e = argv[++i];
+            if( std::strcmp(e, "fast") == 0 ) {
+                options.engine = LatLonFormat::UTMEngineType::eFAST;
+            } else if( std::strcmp(e, "precise") == 0 ) {
+                options.engine = LatLonFormat::UTMEngineType::ePRECISE;
+            } else if( std::strcmp(e, "table") == 0 ) {
+                options.engine = LatLonFormat::UTMEngineType::eTABLE;
+            } else {
+                usage();
+                return 2;
+            }
+        } else if( std::strcmp(arg, "-t") == 0 && hasValue ) {
+            options.threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if( std::strcmp(arg, "-s") == 0 && hasValue ) {
+            options.separator = argv[++i][0];
+        } else if( std::strcmp(arg, "-c") == 0 && hasValue ) {
+            options.chunkSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if( !input ) {
+            input = arg;
+        } else if( !output ) {
+            output = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if( !input ) {
+        usage();
+        return 2;
+    }
+
+    InputFile in;
+    if( !in.open(input) ) {
+        std::fprintf(stderr, "latlon_export: cannot read %s\n", input);
+        return 1;
+    }
+    const std::size_t count = in.size() / sizeof(LatLonExport::Position);
+    const auto *positions = static_cast<const LatLonExport::Position *>(in.data());
+
+    FILE *out = output ? std::fopen(output, "wb") : stdout;
+    if( !out ) {
+        std::fprintf(stderr, "latlon_export: cannot write %s\n", output);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = LatLonExport::exportPositions(positions, count, options,
+                                            [out](const char *data, std::size_t size) {
+        return std::fwrite(data, 1, size, out) == size;
+    });
+    if( output )
+        ok = (std::fclose(out) == 0) && ok;
+    else
+        ok = (std::fflush(out) == 0) && ok;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if( !ok ) {
+        std::fprintf(stderr, "latlon_export: write failed\n");
+        return 1;
+    }
+    std::fprintf(stderr, "latlon_export: %zu positions in %.3f s (%.1f M/s)\n",
+                 count, seconds, seconds > 0 ? count / seconds / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include "latlonitemdelegate.h"
+#include "latlonwidget_p.h"
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QRegularExpressionValidator>
+#include <QStyle>
+
+#include "floattype.h"
+#include "latlonparser.h"
+
+using namespace LatLonDisplay;
+
+///
+/// \brief LatLonItemDelegate::LatLonItemDelegate
+/// \param type   axis shown by the delegate
+/// \param parent
+///
+LatLonItemDelegate::LatLonItemDelegate(LatLonWidget::ValueType type, QObject *parent) :
+    QStyledItemDelegate(parent),
+    m_type(type)
+{
+}
+
+void LatLonItemDelegate::setPositionFormat(int format)
+{
+    m_posFormat = static_cast<LatLonWidget::PositionFormatType>(format);
+}
+
+void LatLonItemDelegate::setNotation(LatLonWidget::NotationType notation)
+{
+    m_notation = notation;
+}
+
+void LatLonItemDelegate::setUTMEngine(LatLonWidget::UTMEngineType engine)
+{
+    m_utmEngine = engine;
+}
+
+void LatLonItemDelegate::setRoles(int latitudeRole, int longitudeRole)
+{
+    m_latitudeRole = latitudeRole;
+    m_longitudeRole = longitudeRole;
+}
+
+QString LatLonItemDelegate::text(const QModelIndex &index) const
+{
+    return text(index, m_type);
+}
+
+QString LatLonItemDelegate::text(const QModelIndex &index, LatLonWidget::ValueType type) const
+{
+    if( m_posFormat == LatLonWidget::eUTM ) {
+        // round through FloatType first, as LatLonWidget::setPosition does
+        const FloatType latitude(index.data(m_latitudeRole).toDouble());
+        const FloatType longitude(index.data(m_longitudeRole).toDouble());
+        QString northing, easting;
+        formatUTMText(latitude.getValue(), longitude.getValue(), m_utmEngine, northing, easting);
+        return (type == LatLonWidget::eLATITUDE) ? northing : easting;
+    }
+
+    const int role = (type == LatLonWidget::eLATITUDE) ? m_latitudeRole : m_longitudeRole;
+    return formatText(m_posFormat, type, m_notation, FloatType(index.data(role).toDouble()));
+}
+
+void LatLonItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                               const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.features |= QStyleOptionViewItem::HasDisplay;
+    opt.text = text(index);
+
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+}
+
+QSize LatLonItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const QVariant value = index.data(Qt::SizeHintRole);
+    if( value.isValid() )
+        return qvariant_cast<QSize>(value);
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.features |= QStyleOptionViewItem::HasDisplay;
+    opt.text = text(index);
+
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    return style->sizeFromContents(QStyle::CT_ItemViewItem, &opt, QSize(), widget);
+}
+
+QLineEdit *LatLonItemDelegate::newEditor(QWidget *parent) const
+{
+    QLineEdit *edit = new QLineEdit(parent);
+    edit->setProperty("Valid", true);
+    edit->setStyleSheet(formatTable().lineEditStyle);
+    new QRegularExpressionValidator(edit);
+
+    connect(edit, &QLineEdit::textChanged, this, [this, edit]() { updateValidity(edit); });
+    return edit;
+}
+
+QWidget *LatLonItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                                          const QModelIndex &index) const
+{
+    Q_UNUSED(option)
+    Q_UNUSED(index)
+
+    // A second view sharing the delegate may open an editor while the
+    // first one still has it; that one gets a throw-away editor.
+    if( m_editor && m_isEditorInUse )
+        return newEditor(parent);
+
+    if( !m_editor ) {
+        m_editor = newEditor(parent);
+    } else if( m_editor->parentWidget() != parent ) {
+        m_editor->setParent(parent);
+    }
+
+    m_isEditorInUse = true;
+    return m_editor;
+}
+
+void LatLonItemDelegate::destroyEditor(QWidget *editor, const QModelIndex &index) const
+{
+    if( editor != m_editor.data() ) {
+        QStyledItemDelegate::destroyEditor(editor, index);
+        return;
+    }
+
+    // The view has hidden it already, keep it for the next cell
+    m_isEditorInUse = false;
+}
+
+void LatLonItemDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    QLineEdit *edit = static_cast<QLineEdit *>(editor);
+
+    // the format may have changed since the editor was last used
+    applyDisplayFormat(edit, edit->findChild<QRegularExpressionValidator *>(),
+                       formatTable().get(m_posFormat, m_type, m_notation));
+
+    edit->setText(text(index));
+    updateValidity(edit);
+}
+
+void LatLonItemDelegate::setModelData(QWidget *editor, QAbstractItemModel *model,
+                                      const QModelIndex &index) const
+{
+    QLineEdit *edit = static_cast<QLineEdit *>(editor);
+    const QString displayed = edit->displayText();
+    const std::u16string_view text = textView(displayed);
+
+    if( m_posFormat == LatLonWidget::eUTM ) {
+        // the zone and northing are in the latitude column, the other
+        // half comes from the model as currently shown
+        const bool isLatitude = (m_type == LatLonWidget::eLATITUDE);
+        const QString otherDisplayed = this->text(index, isLatitude ? LatLonWidget::eLONGITUDE
+                                                                    : LatLonWidget::eLATITUDE);
+        const std::u16string_view other = textView(otherDisplayed);
+        double latitude, longitude;
+        if( !parseUTMText(isLatitude ? text : other, isLatitude ? other : text,
+                          m_utmEngine, latitude, longitude) )
+            return;
+
+        model->setData(index, latitude, m_latitudeRole);
+        model->setData(index, longitude, m_longitudeRole);
+        return;
+    }
+
+    LatLonParser::AngleResult r = (m_posFormat == LatLonWidget::eDECIMAL_DEG)
+            ? LatLonParser::parseDecimalDeg(text)
+            : LatLonParser::parseDMS(text);
+    if( !r.isValid() || !isInRange(m_type, r.whole, r.fraction) )
+        return;
+
+    const FloatType value(r.whole, r.fraction, r.negative);
+    model->setData(index, value.getValue(),
+                   m_type == LatLonWidget::eLATITUDE ? m_latitudeRole : m_longitudeRole);
+}
+
+void LatLonItemDelegate::updateValidity(QLineEdit *edit) const
+{
+    // same checks and restyling as LatLonWidget::validateAndUpdatePosition,
+    // UTM input is not range checked
+    bool isValid = true;
+    if( m_posFormat != LatLonWidget::eUTM ) {
+        const QString displayed = edit->displayText();
+        LatLonParser::AngleResult r = (m_posFormat == LatLonWidget::eDECIMAL_DEG)
+                ? LatLonParser::parseDecimalDeg(textView(displayed))
+                : LatLonParser::parseDMS(textView(displayed));
+        if( !r.isValid() )
+            return;
+        isValid = isInRange(m_type, r.whole, r.fraction);
+    }
+
+    if( isValid != edit->property("Valid").toBool() ) {
+        edit->setProperty("Valid", isValid);
+        edit->style()->unpolish(edit);
+        edit->style()->polish(edit);
+    }
+}
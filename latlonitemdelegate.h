@@ -0,0 +1,81 @@
+#ifndef LATLONITEMDELEGATE_H
+#define LATLONITEMDELEGATE_H
+
+#include <QPointer>
+#include <QStyledItemDelegate>
+
+#include "latlonwidget.h"
+
+class QLineEdit;
+
+///
+/// \brief Item delegate showing and editing positions in QTableView / QListView cells.
+///
+/// Meant for large tables, where a LatLonWidget per row would cost two line
+/// edits, two labels, a layout and two validators per row. The delegate paints the
+/// text straight from the model and keeps a single line edit, created on
+/// the first edit and reused for every cell after that.
+///
+/// Every row holds one position as two doubles in decimal degrees, under
+/// latitudeRole() and longitudeRole() of the cell. A delegate shows one
+/// axis: latitude (or UTM zone and northing) or longitude (or UTM easting),
+/// so a table typically uses one delegate per column:
+/// \code
+/// view->setItemDelegateForColumn(0, new LatLonItemDelegate(LatLonWidget::eLATITUDE, view));
+/// view->setItemDelegateForColumn(1, new LatLonItemDelegate(LatLonWidget::eLONGITUDE, view));
+/// \endcode
+///
+/// Text, input masks and validation are the ones of LatLonWidget.
+///
+class LatLonItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit LatLonItemDelegate(LatLonWidget::ValueType type, QObject *parent = nullptr);
+
+    // Display setup, as on LatLonWidget. The views are not repainted,
+    // update their viewports after a change.
+    void setPositionFormat(int format);
+    void setNotation(LatLonWidget::NotationType notation);
+    void setUTMEngine(LatLonWidget::UTMEngineType engine);
+
+    // Model roles of the position, Qt::UserRole and Qt::UserRole + 1 by default
+    void setRoles(int latitudeRole, int longitudeRole);
+    int latitudeRole() const { return m_latitudeRole; }
+    int longitudeRole() const { return m_longitudeRole; }
+
+    ///
+    /// \brief The text shown for the cell at index.
+    ///
+    QString text(const QModelIndex &index) const;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                          const QModelIndex &index) const override;
+    void destroyEditor(QWidget *editor, const QModelIndex &index) const override;
+    void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+    void setModelData(QWidget *editor, QAbstractItemModel *model,
+                      const QModelIndex &index) const override;
+
+private:
+    QString text(const QModelIndex &index, LatLonWidget::ValueType type) const;
+    QLineEdit *newEditor(QWidget *parent) const;
+    void updateValidity(QLineEdit *edit) const;
+
+    LatLonWidget::ValueType m_type;
+    LatLonWidget::PositionFormatType m_posFormat {LatLonWidget::eDECIMAL_DEG};
+    LatLonWidget::NotationType m_notation {LatLonWidget::NotationType::eSIGN};
+    LatLonWidget::UTMEngineType m_utmEngine {LatLonWidget::UTMEngineType::eFAST};
+
+    int m_latitudeRole {Qt::UserRole};
+    int m_longitudeRole {Qt::UserRole + 1};
+
+    // The one editor, reused across cells; owned by the view it was created for
+    mutable QPointer<QLineEdit> m_editor;
+    mutable bool m_isEditorInUse {};
+};
+
+#endif // LATLONITEMDELEGATE_H
@@ -0,0 +1,339 @@
+#include "latlonprofiler.h"
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+Q_LOGGING_CATEGORY(latlonProfile, "latlon.profile")
+
+std::atomic<bool> LatLonProfiler::s_enabled {false};
+
+namespace {
+
+#if defined(LATLONWIDGET_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+#define LATLON_HAVE_ALLOCATION_COUNT
+
+// Heap allocations of this thread. Counted by interposing malloc, which
+// also sees QString's and operator new's allocations in the Qt libraries.
+thread_local uint64_t t_allocations __attribute__((tls_model("initial-exec"))) = 0;
+
+inline uint64_t allocationCount()
+{
+    return t_allocations;
+}
+#else
+inline uint64_t allocationCount()
+{
+    return 0;
+}
+#endif
+
+struct Counters
+{
+    std::atomic<uint64_t> calls {};
+    std::atomic<uint64_t> totalNs {};
+    std::atomic<uint64_t> maxNs {};
+    std::atomic<uint64_t> allocations {};
+    std::atomic<uint64_t> histogram[LatLonProfiler::kBucketCount] {};
+};
+
+Counters counters[LatLonProfiler::ePROBE_COUNT];
+
+std::atomic<int64_t> slowCallNs {0};
+
+const char *const probeNames[LatLonProfiler::ePROBE_COUNT] = {
+    "textChanged",
+    "setPosition",
+    "setPositionFormat",
+    "formatUTM",
+    "format",
+    "validateAndUpdatePosition"
+};
+
+struct TraceEvent
+{
+    uint32_t probe;
+    uint32_t thread;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+struct Trace
+{
+    std::mutex mutex;
+    QString path;
+    std::vector<TraceEvent> events;
+    std::size_t maxEvents {};
+    int64_t originNs {};
+};
+
+Trace &trace()
+{
+    static Trace t;
+    return t;
+}
+
+std::atomic<bool> tracing {false};
+
+// small, stable thread ids for the trace
+std::atomic<uint32_t> nextThread {1};
+thread_local uint32_t t_thread = 0;
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int bucketOf(uint64_t ns)
+{
+    int bucket = 0;
+    while( bucket < LatLonProfiler::kBucketCount - 1 && ns >= (uint64_t(128) << bucket) )
+        ++bucket;
+    return bucket;
+}
+
+void finishAtExit()
+{
+    if( LatLonProfiler::isTracing() )
+        LatLonProfiler::stopTrace();
+    LatLonProfiler::logSummary();
+}
+
+} // namespace
+
+#ifdef LATLON_HAVE_ALLOCATION_COUNT
+// glibc's own entry points, the interposed ones below forward to them
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+
+void *malloc(std::size_t size) noexcept
+{
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept
+{
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, std::size_t size) noexcept
+{
+    ++t_allocations;
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+uint64_t LatLonProfiler::Stats::percentileNs(double p) const
+{
+    const double target = double(calls) * p / 100.0;
+    uint64_t seen = 0;
+    for( int i = 0; i < kBucketCount; ++i ) {
+        seen += histogram[std::size_t(i)];
+        if( seen > 0 && double(seen) >= target )
+            return uint64_t(128) << i;
+    }
+    return maxNs;
+}
+
+void LatLonProfiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool LatLonProfiler::countsAllocations()
+{
+#ifdef LATLON_HAVE_ALLOCATION_COUNT
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t LatLonProfiler::threadAllocations()
+{
+    return allocationCount();
+}
+
+LatLonProfiler::Stats LatLonProfiler::stats(Probe probe)
+{
+    const Counters &c = counters[probe];
+    Stats s;
+    s.calls = c.calls.load(std::memory_order_relaxed);
+    s.totalNs = c.totalNs.load(std::memory_order_relaxed);
+    s.maxNs = c.maxNs.load(std::memory_order_relaxed);
+    s.allocations = c.allocations.load(std::memory_order_relaxed);
+    for( int i = 0; i < kBucketCount; ++i )
+        s.histogram[std::size_t(i)] = c.histogram[i].load(std::memory_order_relaxed);
+    return s;
+}
+
+const char *LatLonProfiler::probeName(Probe probe)
+{
+    return probeNames[probe];
+}
+
+void LatLonProfiler::reset()
+{
+    for( Counters &c : counters ) {
+        c.calls.store(0, std::memory_order_relaxed);
+        c.totalNs.store(0, std::memory_order_relaxed);
+        c.maxNs.store(0, std::memory_order_relaxed);
+        c.allocations.store(0, std::memory_order_relaxed);
+        for( std::atomic<uint64_t> &bucket : c.histogram )
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatLonProfiler::logSummary()
+{
+    for( int i = 0; i < ePROBE_COUNT; ++i ) {
+        const Stats s = stats(Probe(i));
+        if( !s.calls )
+            continue;
+
+        if( countsAllocations() ) {
+            qCInfo(latlonProfile, "%s: %llu calls, mean %.0f ns, p99 < %llu ns, max %llu ns, %.2f allocations/call",
+                   probeName(Probe(i)), (unsigned long long)s.calls, s.meanNs(),
+                   (unsigned long long)s.percentileNs(99.0), (unsigned long long)s.maxNs,
+                   double(s.allocations) / double(s.calls));
+        } else {
+            qCInfo(latlonProfile, "%s: %llu calls, mean %.0f ns, p99 < %llu ns, max %llu ns",
+                   probeName(Probe(i)), (unsigned long long)s.calls, s.meanNs(),
+                   (unsigned long long)s.percentileNs(99.0), (unsigned long long)s.maxNs);
+        }
+    }
+}
+
+void LatLonProfiler::setSlowCallThreshold(std::chrono::nanoseconds threshold)
+{
+    slowCallNs.store(int64_t(threshold.count()), std::memory_order_relaxed);
+}
+
+bool LatLonProfiler::startTrace(const QString &path, std::size_t maxEvents)
+{
+    Trace &t = trace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if( tracing.load(std::memory_order_relaxed) )
+        return false;
+
+    t.path = path;
+    t.events.clear();
+    t.maxEvents = maxEvents;
+    t.originNs = nowNs();
+    tracing.store(true, std::memory_order_relaxed);
+    setEnabled(true);
+    return true;
+}
+
+bool LatLonProfiler::stopTrace()
+{
+    std::vector<TraceEvent> events;
+    QString path;
+    int64_t originNs;
+    {
+        Trace &t = trace();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if( !tracing.load(std::memory_order_relaxed) )
+            return false;
+        tracing.store(false, std::memory_order_relaxed);
+        events.swap(t.events);
+        path = t.path;
+        originNs = t.originNs;
+    }
+
+    // "X" (complete) events, times in microseconds
+    const QByteArray pid = QByteArray::number(qint64(QCoreApplication::applicationPid()));
+    QByteArray json;
+    json.reserve(int(events.size()) * 110 + 64);
+    json += "{\"traceEvents\":[";
+    for( std::size_t i = 0; i < events.size(); ++i ) {
+        const TraceEvent &e = events[i];
+        if( i )
+            json += ',';
+        json += "\n{\"name\":\"";
+        json += probeNames[e.probe];
+        json += "\",\"cat\":\"LatLonWidget\",\"ph\":\"X\",\"pid\":";
+        json += pid;
+        json += ",\"tid\":";
+        json += QByteArray::number(e.thread);
+        json += ",\"ts\":";
+        json += QByteArray::number(double(e.startNs - originNs) / 1000.0, 'f', 3);
+        json += ",\"dur\":";
+        json += QByteArray::number(double(e.durationNs) / 1000.0, 'f', 3);
+        json += '}';
+    }
+    json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    QFile file(path);
+    if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        qCWarning(latlonProfile) << "cannot write trace" << path << file.errorString();
+        return false;
+    }
+    return file.write(json) == json.size();
+}
+
+bool LatLonProfiler::isTracing()
+{
+    return tracing.load(std::memory_order_relaxed);
+}
+
+void LatLonProfiler::configureFromEnvironment()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
+        const QString tracePath = qEnvironmentVariable("LATLON_PROFILE_TRACE");
+        const bool enable = qEnvironmentVariableIntValue("LATLON_PROFILE") != 0;
+        if( !enable && tracePath.isEmpty() )
+            return;
+
+        setEnabled(true);
+        if( !tracePath.isEmpty() )
+            startTrace(tracePath);
+        qAddPostRoutine(finishAtExit);
+    });
+}
+
+void LatLonProfiler::Scope::begin()
+{
+    m_isActive = true;
+    m_allocations = allocationCount();
+    m_startNs = nowNs();
+}
+
+void LatLonProfiler::Scope::end()
+{
+    const int64_t endNs = nowNs();
+    const uint64_t ns = uint64_t(endNs - m_startNs);
+
+    Counters &c = counters[m_probe];
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    c.allocations.fetch_add(allocationCount() - m_allocations, std::memory_order_relaxed);
+    c.histogram[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = c.maxNs.load(std::memory_order_relaxed);
+    while( ns > max && !c.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed) ) {
+    }
+
+    const int64_t slow = slowCallNs.load(std::memory_order_relaxed);
+    if( slow > 0 && int64_t(ns) > slow )
+        qCWarning(latlonProfile, "%s took %.1f us", probeNames[m_probe], double(ns) / 1000.0);
+
+    if( tracing.load(std::memory_order_relaxed) ) {
+        if( !t_thread )
+            t_thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+
+        Trace &t = trace();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if( tracing.load(std::memory_order_relaxed) && t.events.size() < t.maxEvents )
+            t.events.push_back(TraceEvent{uint32_t(m_probe), t_thread, m_startNs, int64_t(ns)});
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef LATLONPROFILER_H
+#define LATLONPROFILER_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+Q_DECLARE_LOGGING_CATEGORY(latlonProfile)
+
+///
+/// \brief Optional instrumentation of LatLonWidget's hot paths.
+///
+/// Counts calls, latencies and heap allocations of the widget's text
+/// parsing, validation, formatting and position updates, to tell whether a
+/// stalled frame was spent in the widget. Everything is off by default; a
+/// probe then costs one relaxed atomic load and a branch. Building with
+/// LATLONWIDGET_NO_PROFILING removes the probes altogether.
+///
+/// Switched on in code with setEnabled(), or from the environment of the
+/// first LatLonWidget's process:
+/// - LATLON_PROFILE=1 counts calls; a summary goes to the "latlon.profile"
+///   category (info) when the application exits.
+/// - LATLON_PROFILE_TRACE=<file> also records a Chrome trace
+///   (chrome://tracing, Perfetto) and writes it to file on exit.
+///
+/// Latencies and allocations are inclusive: setPosition() contains the
+/// format() calls it makes. Allocations (malloc, calloc and realloc of the
+/// calling thread) are only counted in builds with
+/// LATLONWIDGET_COUNT_ALLOCATIONS on glibc, see countsAllocations().
+///
+class LatLonProfiler
+{
+public:
+    enum Probe {
+        eTEXT_CHANGED,
+        eSET_POSITION,
+        eSET_POSITION_FORMAT,
+        eFORMAT_UTM,
+        eFORMAT,
+        eVALIDATE,
+        ePROBE_COUNT
+    };
+
+    ///
+    /// \brief Latency histogram buckets.
+    ///
+    /// Bucket 0 holds calls under 128 ns, bucket i the calls from 64 << i
+    /// up to 128 << i ns, and the last bucket everything slower.
+    ///
+    static constexpr int kBucketCount = 24;
+
+    struct Stats
+    {
+        uint64_t calls {};
+        uint64_t totalNs {};
+        uint64_t maxNs {};
+        uint64_t allocations {};
+        std::array<uint64_t, kBucketCount> histogram {};
+
+        double meanNs() const { return calls ? double(totalNs) / double(calls) : 0.0; }
+
+        /// Upper bound of the bucket holding the p-th percentile (0 < p <= 100).
+        uint64_t percentileNs(double p) const;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /// True when the build counts allocations.
+    static bool countsAllocations();
+
+    /// Heap allocations the calling thread has made so far, 0 unless countsAllocations().
+    static uint64_t threadAllocations();
+
+    static Stats stats(Probe probe);
+    static const char *probeName(Probe probe);
+
+    /// Zero all statistics.
+    static void reset();
+
+    /// One line per called probe to latlonProfile, at info level.
+    static void logSummary();
+
+    ///
+    /// \brief Log calls slower than threshold as warnings to latlonProfile.
+    ///
+    /// Zero (the default) logs none.
+    ///
+    static void setSlowCallThreshold(std::chrono::nanoseconds threshold);
+
+    ///
+    /// \brief Record every probed call until stopTrace(), at most maxEvents.
+    ///
+    /// Enables the profiler. Returns false when a trace is already running.
+    ///
+    static bool startTrace(const QString &path, std::size_t maxEvents = 1000000);
+
+    ///
+    /// \brief Write the recorded calls as Chrome trace JSON to the path of startTrace().
+    ///
+    static bool stopTrace();
+
+    static bool isTracing();
+
+    ///
+    /// \brief Apply LATLON_PROFILE and LATLON_PROFILE_TRACE, once per process.
+    ///
+    static void configureFromEnvironment();
+
+    ///
+    /// \brief Measures one call, from construction to destruction.
+    ///
+    class Scope
+    {
+    public:
+        explicit Scope(Probe probe) :
+            m_probe(probe)
+        {
+            if( isEnabled() )
+                begin();
+        }
+        ~Scope()
+        {
+            if( m_isActive )
+                end();
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        void begin();
+        void end();
+
+        Probe m_probe;
+        bool m_isActive {};
+        int64_t m_startNs {};
+        uint64_t m_allocations {};
+    };
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#ifndef LATLONWIDGET_NO_PROFILING
+#define LATLON_PROFILE(probe) LatLonProfiler::Scope latlonProfileScope(LatLonProfiler::probe)
+#else
+#define LATLON_PROFILE(probe) do {} while( false )
+#endif
+
+#endif // LATLONPROFILER_H
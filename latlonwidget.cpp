@@ -1,4 +1,8 @@
 #include "latlonwidget.h"
+#include "latlonwidget_p.h"
+#include "latlonprofiler.h"
+#include "positionmodel.h"
+#include "positionslot.h"
 
 #include <QLineEdit>
 #include <QLabel>
@@ -8,70 +12,33 @@
 #include <QRegularExpressionValidator>
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QPaintEvent>
+#include <QPainter>
 #include <QStyle>
+#include <QTimer>
 
+#include "floattype.h"
+#include "latlonformat.h"
+#include "latlonparser.h"
 #include "utm.h"
 
-#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
 
-///
-/// \brief Structure to hold a floating point value as a whole and fraction part separately.
-///
-struct FloatType
-{
-    FloatType(double value) { setValue(value); }
-    FloatType(int32_t whole, int32_t fraction) { setValue(whole, fraction); }
-
-    void setValue(double value) {
-        // use 6 digit precision
-        QStringList f = QString::number(value, 'f', 6).split('.');
-        // break into whole and fraction part
-        m_whole    = f[0].toInt();
-        m_fraction = f[1].toInt();
-    }
-
-    void setValue(int32_t whole, int32_t fraction) {
-        QStringList lst = QString::number(fraction/1000000.0, 'f', 6).split('.');
-        bool found {};
-
-        // look for x33333, x66666, x99999 pattern
-        QStringList patterns {"\\d3{5}", "\\d6{5}", "\\d9{5}"};
-        QRegularExpression re;
-        QRegularExpressionMatch match;
-        foreach(auto s, patterns) {
-            re.setPattern(s);
-            match = re.match(lst[1]);
-            if(match.hasMatch()) {
-                found = true;
-                break;
-            }
-        }
+namespace {
 
-        if( found ) {
-            fraction += 1;
-        }
+// Size of a value field, the painted mode uses the same grid
+const int kValueWidth = 110;
+const int kRowHeight = 20;
+const int kSpacing = 2;
 
-        m_whole = whole;
-        m_fraction = fraction;
-    }
+// Text inset of the painted value, about where QLineEdit puts it
+const int kTextMargin = 3;
 
-    double getValue() const {
-        if( m_whole < 0 ) {
-            return (double(m_whole) - (m_fraction/1000000.0));
-        } else {
-            return (double(m_whole) + (m_fraction/1000000.0));
-        }
-    }
-
-    void getValue(int32_t &whole, int32_t &fraction) {
-        whole = m_whole;
-        fraction = m_fraction;
-    }
-
-private:
-    int32_t m_whole;
-    int32_t m_fraction;
-};
+} // namespace
 
 ///
 /// \brief Custom LineEdit class
@@ -84,9 +51,197 @@ public:
 
 QSize MyLineEdit::sizeHint() const
 {
-    return QSize(110, 20);
+    return QSize(kValueWidth, kRowHeight);
 }
 
+// The widget's enums are passed straight to the core library
+static_assert(int(LatLonWidget::eDECIMAL_DEG) == int(LatLonFormat::eDECIMAL_DEG) &&
+              int(LatLonWidget::eDMS) == int(LatLonFormat::eDMS) &&
+              int(LatLonWidget::eUTM) == int(LatLonFormat::eUTM), "format enums differ");
+static_assert(int(LatLonWidget::eLATITUDE) == int(LatLonFormat::eLATITUDE) &&
+              int(LatLonWidget::eLONGITUDE) == int(LatLonFormat::eLONGITUDE), "value enums differ");
+static_assert(int(LatLonWidget::NotationType::eSIGN) == int(LatLonFormat::NotationType::eSIGN) &&
+              int(LatLonWidget::NotationType::eDIRECTION) == int(LatLonFormat::NotationType::eDIRECTION),
+              "notation enums differ");
+static_assert(int(LatLonWidget::UTMEngineType::eFAST) == int(LatLonFormat::UTMEngineType::eFAST) &&
+              int(LatLonWidget::UTMEngineType::ePRECISE) == int(LatLonFormat::UTMEngineType::ePRECISE) &&
+              int(LatLonWidget::UTMEngineType::eTABLE) == int(LatLonFormat::UTMEngineType::eTABLE),
+              "UTM engine enums differ");
+
+namespace LatLonDisplay
+{
+
+FormatTable::FormatTable()
+{
+    const int sign = 0;
+    const int direction = 1;
+
+    // Latitude
+    set(LatLonWidget::eDECIMAL_DEG, LatLonWidget::eLATITUDE, sign,
+        QStringLiteral("#00.000000\u00B0;0"),
+        QStringLiteral("(-|\\+)\\d{1,2}\\.\\d{0,6}\u00B0"));
+    set(LatLonWidget::eDECIMAL_DEG, LatLonWidget::eLATITUDE, direction,
+        QStringLiteral("x 00.000000\u00B0;0"),
+        QStringLiteral("^(N|S|n|s) \\d{1,2}\\.\\d{0,6}\u00B0"));
+    set(LatLonWidget::eDMS, LatLonWidget::eLATITUDE, sign,
+        QStringLiteral("x 00\u00B0 00' 00.00\";0"),
+        QStringLiteral("^(N|S|n|s)\\s \\d{1,2}\u00B0\\s [0-5][0-9]'\\s [0-5][0-9].\\d{1,2}\""));
+    set(LatLonWidget::eUTM, LatLonWidget::eLATITUDE, sign,
+        QStringLiteral("99A 0000000 m;0"),
+        QStringLiteral("[0-9][0-9][C-Z] \\d{0,7} m"));
+
+    // Longitude
+    set(LatLonWidget::eDECIMAL_DEG, LatLonWidget::eLONGITUDE, sign,
+        QStringLiteral("#000.000000\u00B0;0"),
+        QStringLiteral("(-|\\+)[0-1]\\d{1,2}.\\d{0,6}\u00B0"));
+    set(LatLonWidget::eDECIMAL_DEG, LatLonWidget::eLONGITUDE, direction,
+        QStringLiteral("x 000.000000\u00B0;0"),
+        QStringLiteral("^(E|W|e|w) [0-1]\\d{1,2}.\\d{0,6}\u00B0"));
+    set(LatLonWidget::eDMS, LatLonWidget::eLONGITUDE, sign,
+        QStringLiteral("x 000\u00B0 00' 00.00\";0"),
+        QStringLiteral("^(E|W|e|w)\\s [0-1]\\d{1,2}\u00B0\\s [0-5][0-9]'\\s [0-5][0-9].\\d{1,2}\""));
+    set(LatLonWidget::eUTM, LatLonWidget::eLONGITUDE, sign,
+        QStringLiteral("000000 m;0"),
+        QStringLiteral("\\d{0,6} m"));
+
+    // DMS and UTM look the same in either notation
+    for( int type = LatLonWidget::eLATITUDE; type <= LatLonWidget::eLONGITUDE; ++type ) {
+        formats[LatLonWidget::eDMS][type][direction] = formats[LatLonWidget::eDMS][type][sign];
+        formats[LatLonWidget::eUTM][type][direction] = formats[LatLonWidget::eUTM][type][sign];
+    }
+
+    lineEditStyle = QStringLiteral(
+                "QLineEdit { background-color: black; border-style: solid; font-weight: bold; color: lime;"
+                " border-width: 1px; border-color: white; }"
+                "QLineEdit[Valid=\"false\"] { border-width: 2px; border-color: red; }");
+}
+
+const FormatTable &formatTable()
+{
+    static const FormatTable table;
+    return table;
+}
+
+QString formatText(LatLonWidget::PositionFormatType posFormat, LatLonWidget::ValueType type,
+                   LatLonWidget::NotationType notation, const FloatType &value)
+{
+    // UTF-16 for QString to copy as is, one allocation for the result
+    char16_t buffer[LatLonFormat::kMaxTextSize];
+    const char16_t *end = LatLonFormat::format(buffer, static_cast<LatLonFormat::PositionFormatType>(posFormat),
+                                               static_cast<LatLonFormat::ValueType>(type),
+                                               static_cast<LatLonFormat::NotationType>(notation),
+                                               value);
+    return QString(reinterpret_cast<const QChar *>(buffer), int(end - buffer));
+}
+
+void formatUTMText(double latitude, double longitude, LatLonWidget::UTMEngineType engine,
+                   QString &northing, QString &easting, Datum::DatumType datum)
+{
+    char northingText[LatLonFormat::kMaxTextSize];
+    char eastingText[LatLonFormat::kMaxTextSize];
+    LatLonFormat::UTMTextEnd end;
+    if( datum == Datum::DatumType::eWGS84 ) {
+        end = LatLonFormat::formatUTM(northingText, eastingText, latitude, longitude,
+                                      static_cast<LatLonFormat::UTMEngineType>(engine));
+    } else {
+        double n, e;
+        UTM::UtmZone zone;
+        Datum::LLtoUTM(datum, latitude, longitude, engine == LatLonWidget::UTMEngineType::ePRECISE,
+                       n, e, zone);
+        end = LatLonFormat::formatUTMGrid(northingText, eastingText, zone, n, e);
+    }
+    northing = QString::fromUtf8(northingText, int(end.northing - northingText));
+    easting = QString::fromUtf8(eastingText, int(end.easting - eastingText));
+}
+
+bool parseUTMText(std::u16string_view northingText, std::u16string_view eastingText,
+                  LatLonWidget::UTMEngineType engine, double &latitude, double &longitude,
+                  Datum::DatumType datum)
+{
+    LatLonParser::UTMResult northing = LatLonParser::parseUTMNorthing(northingText);
+    LatLonParser::UTMResult easting = LatLonParser::parseUTMEasting(eastingText);
+    if( !northing.isValid() || !easting.isValid() )
+        return false;
+
+    // within a zone: northings from the equator or the southern false
+    // origin, eastings at most 400 km from the central meridian
+    if( northing.zoneNumber < 1 || northing.zoneNumber > 60 ||
+        northing.value < 0.0 || northing.value > 10000000.0 ||
+        easting.value < 100000.0 || easting.value > 900000.0 )
+        return false;
+
+    const UTM::UtmZone zone = { uint8_t(northing.zoneNumber), northing.zoneLetter };
+    if( datum == Datum::DatumType::eWGS84 ) {
+        UTM::UTMtoLL(northing.value, easting.value, zone, latitude, longitude,
+                     static_cast<UTM::Engine>(engine));
+    } else {
+        Datum::UTMtoLL(datum, northing.value, easting.value, zone,
+                       engine == LatLonWidget::UTMEngineType::ePRECISE, latitude, longitude);
+    }
+    return true;
+}
+
+GlyphCache::GlyphCache(const QFont &font) :
+    m_font(font),
+    m_metrics(font),
+    m_height(m_metrics.height())
+{
+}
+
+const Glyph &GlyphCache::glyph(QChar c)
+{
+    auto it = m_glyphs.find(c.unicode());
+    if( it != m_glyphs.end() )
+        return *it;
+
+    Glyph &g = m_glyphs[c.unicode()];
+    g.text.setTextFormat(Qt::PlainText);
+    g.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    g.text.setText(QString(c));
+    g.text.prepare(QTransform(), m_font);
+    g.advance = m_metrics.horizontalAdvance(c);
+    return g;
+}
+
+qreal GlyphCache::advance(const QString &text, int begin, int end)
+{
+    qreal width = 0;
+    for( int i = begin; i < end; ++i )
+        width += glyph(text.at(i)).advance;
+    return width;
+}
+
+namespace {
+
+typedef std::map<QString, std::unique_ptr<GlyphCache>> GlyphCaches;
+GlyphCaches *glyphCaches = nullptr;
+
+// Fonts must not outlive the application, drop the caches with it
+void deleteGlyphCaches()
+{
+    delete glyphCaches;
+    glyphCaches = nullptr;
+}
+
+} // namespace
+
+GlyphCache *glyphCache(const QFont &font)
+{
+    if( !glyphCaches ) {
+        glyphCaches = new GlyphCaches;
+        qAddPostRoutine(deleteGlyphCaches);
+    }
+
+    std::unique_ptr<GlyphCache> &cache = (*glyphCaches)[font.key()];
+    if( !cache )
+        cache.reset(new GlyphCache(font));
+    return cache.get();
+}
+
+} // namespace LatLonDisplay
+
+using namespace LatLonDisplay;
+
 ///
 /// \brief LatLonWidget::LatLonWidget
 /// Main Class for creating LatLonWidget.
@@ -94,24 +249,48 @@ QSize MyLineEdit::sizeHint() const
 /// \param parent
 ///
 LatLonWidget::LatLonWidget(QWidget *parent) :
-    QWidget(parent)
+    LatLonWidget(DisplayMode::eEDITOR, parent)
+{
+}
+
+///
+/// \brief LatLonWidget::LatLonWidget
+/// Create the widget directly in the given display mode; a painted widget
+/// never creates the line edits.
+///
+/// \param mode
+/// \param parent
+///
+LatLonWidget::LatLonWidget(DisplayMode mode, QWidget *parent) :
+    QWidget(parent),
+    m_displayMode(mode)
 {
-    m_latValidator = new QRegularExpressionValidator();
-    m_lonValidator = new QRegularExpressionValidator();
+    LatLonProfiler::configureFromEnvironment();
 
+    if( m_displayMode == DisplayMode::eEDITOR ) {
+        createEditors();
+    } else {
+        setLabels("LAT: ", "LON: ");
+        updateDisplay();
+    }
+}
+
+LatLonWidget::~LatLonWidget() = default;
+
+void LatLonWidget::createEditors()
+{
     m_label1 = new QLabel;
     m_label2 = new QLabel;
 
     m_latLineEdit = new MyLineEdit();
     m_latLineEdit->setObjectName("Latitude");
-    m_latLineEdit->setStyleSheet(lineEditStyle + validStyle);
+    m_latLineEdit->setProperty("Valid", true);
+    m_latLineEdit->setStyleSheet(formatTable().lineEditStyle);
 
     m_lonLineEdit = new MyLineEdit();
     m_lonLineEdit->setObjectName("Longitude");
-    m_lonLineEdit->setStyleSheet(lineEditStyle + validStyle);
-
-    m_latitude = new FloatType(0, 0);
-    m_longitude = new FloatType(0, 0);
+    m_lonLineEdit->setProperty("Valid", true);
+    m_lonLineEdit->setStyleSheet(formatTable().lineEditStyle);
 
     // Depending on the position format setup the display
     if( m_posFormat == PositionFormatType::eDECIMAL_DEG) {
@@ -141,164 +320,125 @@ LatLonWidget::LatLonWidget(QWidget *parent) :
 
     connect(m_latLineEdit, &QLineEdit::textChanged, this, &LatLonWidget::textChanged);
     connect(m_lonLineEdit, &QLineEdit::textChanged, this, &LatLonWidget::textChanged);
+
+    setReadOnly(m_isReadOnly);
+}
+
+void LatLonWidget::destroyEditors()
+{
+    // the layout does not own the widgets, they are children of this
+    delete m_layout;
+    delete m_label1;
+    delete m_label2;
+    delete m_latLineEdit;     // and the validators they own
+    delete m_lonLineEdit;
+
+    m_layout = nullptr;
+    m_label1 = m_label2 = nullptr;
+    m_latLineEdit = m_lonLineEdit = nullptr;
+    m_latValidator = m_lonValidator = nullptr;
+    m_isLatValid = m_isLonValid = true;
 }
 
 void LatLonWidget::setLabels(const QString &label1, const QString &label2)
 {
+    m_labels[eLATITUDE] = label1;
+    m_labels[eLONGITUDE] = label2;
+
+    if( m_displayMode == DisplayMode::ePAINTED ) {
+        updateGlyphs();
+        return;
+    }
+
     m_label1->setText(label1);
     m_label2->setText(label2);
 }
 
 QString LatLonWidget::format(PositionFormatType posFormat, LatLonWidget::ValueType type, FloatType *value)
 {
-    QString result = "";
-    int32_t whole, fraction;
-    int32_t prec {7};
-    value->getValue(whole, fraction);
-
-    if (posFormat == PositionFormatType::eDECIMAL_DEG) {
-        int32_t degWidth = 3;
-        prec = 6;
-        QString tmp;
-
-        if( type == eLATITUDE) {
-            degWidth = 2;
-
-            if( m_decimalDegNotation == NotationType::eSIGN ) {
-                tmp = "+";
-            } else {
-                tmp = "N ";
-            }
-
-            if( whole < 0 ) {
-                if( m_decimalDegNotation == NotationType::eSIGN ) {
-                    tmp = "-";
-                } else {
-                    tmp = "S ";
-                }
-            }
-        } else {
-            if( m_decimalDegNotation == NotationType::eSIGN ) {
-                tmp = "+";
-            } else {
-                tmp = "E ";
-            }
-
-            if( whole < 0 ) {
-                if( m_decimalDegNotation == NotationType::eSIGN ) {
-                    tmp = "-";
-                } else {
-                    tmp = "W ";
-                }
-            }
-        }
-
-        QStringList f = QString::number(value->getValue(), 'f', prec).split('.');
-        result = QString("%1%2.%3\u00B0").arg(tmp).
-                arg(abs(f[0].toInt()), degWidth, 10, QChar('0')).
-                arg(f[1].toInt(), 6, 10, QChar('0'));
-
-    } else if (posFormat == PositionFormatType::eDMS) {
-        int32_t degFieldWidth = 3;
-        QString direction = "N";
-
-        if( type == eLATITUDE) {
-            degFieldWidth = 2;
-            if( whole < 0 )
-                direction = "S";
-        } else {
-            degFieldWidth = 3;
-            if( whole < 0 ) {
-                direction = "W";
-            } else {
-                direction = "E";
-            }
-        }
-
-        int32_t deg = whole;
-        int32_t min = (fraction * 6) / 100000;
-        double sec = ((fraction / 1000000.0) - (min/60.0)) * 3600;
-
-        result = QString("%1 %2\u00B0 %3' %4\"").arg(direction).
-                arg(abs(deg), degFieldWidth, 10, QChar('0')).
-                arg(min, 2, 10, QChar('0')).
-                arg(sec, 5, 'f', 2, QChar('0'));
-    }
-    return result;
+    LATLON_PROFILE(eFORMAT);
+    return formatText(posFormat, type, m_decimalDegNotation, *value);
 }
 
 void LatLonWidget::formatUTM()
 {
-    double latitude = m_latitude->getValue();
-    double longitude = m_longitude->getValue();
-
-    double northing, easting;
-    char zone[5];
-    UTM::LLtoUTM(latitude, longitude, northing, easting, &zone[0]);
-    QString z(zone);
-    m_latLineEdit->setText(QString("%1 %2 m").arg(z).arg(northing, 6, 'f', 0, QChar('0')));
-    m_lonLineEdit->setText(QString("%1 m").arg(easting, 6, 'f', 0, QChar('0')));
+    LATLON_PROFILE(eFORMAT_UTM);
+    QString northing, easting;
+    formatUTMText(m_latitude.getValue(), m_longitude.getValue(), m_utmEngine, northing, easting, m_datum);
+    setDisplayText(eLATITUDE, northing);
+    setDisplayText(eLONGITUDE, easting);
 }
 
 void LatLonWidget::setNotation(NotationType notation)
 {
     m_decimalDegNotation = notation;
+    if( m_displayMode == DisplayMode::ePAINTED ) {
+        updateDisplay();
+        return;
+    }
     setupDegDisplay();
 }
 
+void LatLonWidget::setUTMEngine(UTMEngineType engine)
+{
+    m_utmEngine = engine;
+    if( m_posFormat == PositionFormatType::eUTM )
+        formatUTM();
+}
+
 void LatLonWidget::setupDegDisplay()
 {
-    if( m_decimalDegNotation == NotationType::eSIGN ) {
-        // Latitude (degree format)
-        m_latLineEdit->setInputMask(latDegInputMask);
-        m_latValidator->setRegularExpression(QRegularExpression(latDegRegExp));
-        m_latLineEdit->setValidator(m_latValidator);
-        m_latLineEdit->setText(format(eDECIMAL_DEG, eLATITUDE, m_latitude));
+    // nothing to set up without line edits
+    if( !m_latLineEdit )
+        return;
 
-        // Longitude (degree format)
-        m_lonLineEdit->setInputMask(lonDegInputMask);
-        m_lonValidator->setRegularExpression(QRegularExpression(lonDegRegExp));
-        m_lonLineEdit->setValidator(m_lonValidator);
-        m_lonLineEdit->setText(format(eDECIMAL_DEG, eLONGITUDE, m_longitude));
+    const FormatTable &table = formatTable();
 
-    } else {
-        m_latLineEdit->setInputMask(latDecimalDegMask);
-        m_latValidator->setRegularExpression(QRegularExpression(latDecimalDegRegExp));
-        m_latLineEdit->setValidator(m_latValidator);
-        m_latLineEdit->setText(format(eDECIMAL_DEG, eLATITUDE, m_latitude));
+    // Latitude (degree format)
+    applyDisplayFormat(m_latLineEdit, m_latValidator,
+                       table.get(eDECIMAL_DEG, eLATITUDE, m_decimalDegNotation));
+    m_latLineEdit->setText(format(eDECIMAL_DEG, eLATITUDE, &m_latitude));
 
-        m_lonLineEdit->setInputMask(lonDecimalDegMask);
-        m_lonValidator->setRegularExpression(QRegularExpression(lonDecimalDegRegExp));
-        m_lonLineEdit->setValidator(m_lonValidator);
-        m_lonLineEdit->setText(format(eDECIMAL_DEG, eLONGITUDE, m_longitude));
-    }
+    // Longitude (degree format)
+    applyDisplayFormat(m_lonLineEdit, m_lonValidator,
+                       table.get(eDECIMAL_DEG, eLONGITUDE, m_decimalDegNotation));
+    m_lonLineEdit->setText(format(eDECIMAL_DEG, eLONGITUDE, &m_longitude));
 }
 
 void LatLonWidget::setupDMSDisplay()
 {
+    // nothing to set up without line edits
+    if( !m_latLineEdit )
+        return;
+
+    const FormatTable &table = formatTable();
+
     // Latitude (DMS format)
-    m_latLineEdit->setInputMask(latDMSInputMask);
-    m_latValidator->setRegularExpression(QRegularExpression(latDMSRegExp));
-    m_latLineEdit->setValidator(m_latValidator);
-    m_latLineEdit->setText(format(eDMS, eLATITUDE, m_latitude));
+    applyDisplayFormat(m_latLineEdit, m_latValidator,
+                       table.get(eDMS, eLATITUDE, m_decimalDegNotation));
+    m_latLineEdit->setText(format(eDMS, eLATITUDE, &m_latitude));
 
     // Longitude (DMS format)
-    m_lonLineEdit->setInputMask(lonDMSInputMask);
-    m_lonValidator->setRegularExpression(QRegularExpression(lonDMSRegExp));
-    m_lonLineEdit->setValidator(m_lonValidator);
-    m_lonLineEdit->setText(format(eDMS, eLONGITUDE, m_longitude));
+    applyDisplayFormat(m_lonLineEdit, m_lonValidator,
+                       table.get(eDMS, eLONGITUDE, m_decimalDegNotation));
+    m_lonLineEdit->setText(format(eDMS, eLONGITUDE, &m_longitude));
 }
 
 void LatLonWidget::setupUTMDisplay()
 {
+    // nothing to set up without line edits
+    if( !m_latLineEdit )
+        return;
+
+    const FormatTable &table = formatTable();
+
     // Northing (UTM)
-    m_latLineEdit->setInputMask(latUTMInputMask);
-    m_latValidator->setRegularExpression(QRegularExpression(latUTMRegExp));
-    m_latLineEdit->setValidator(m_latValidator);
+    applyDisplayFormat(m_latLineEdit, m_latValidator,
+                       table.get(eUTM, eLATITUDE, m_decimalDegNotation));
 
-    m_lonLineEdit->setInputMask(lonUTMInputMask);
-    m_lonValidator->setRegularExpression(QRegularExpression(lonUTMRegExp));
-    m_lonLineEdit->setValidator(m_lonValidator);
+    // Easting (UTM)
+    applyDisplayFormat(m_lonLineEdit, m_lonValidator,
+                       table.get(eUTM, eLONGITUDE, m_decimalDegNotation));
 
     formatUTM();
 }
@@ -306,121 +446,454 @@ void LatLonWidget::setupUTMDisplay()
 
 void LatLonWidget::textChanged()
 {
+    LATLON_PROFILE(eTEXT_CHANGED);
     QLineEdit *lineEdit = reinterpret_cast<QLineEdit *>(sender());
 
     if( !lineEdit->hasFocus())
         return;
 
-    // get current displayed text
-    QString tmp = lineEdit->displayText();
-
-    if( m_posFormat == PositionFormatType::eDECIMAL_DEG) {
-        tmp.chop(1); // get rid of degree sign
-        QStringList f = tmp.split('.');
+    bool isLatitude = (lineEdit == m_latLineEdit);
 
-        int32_t frac = f[1].toInt();
-        int32_t whole;
-        if( m_decimalDegNotation == NotationType::eSIGN ) {
-            whole = f[0].toInt();
-        } else {
-            QStringList p = f[0].split(' ');
-            whole = p[1].toInt();
-            if( p[0] == "S" || p[0] == "s" || p[0] == "W" || p[0] == "w" )
-                whole *= -1;
-        }
-        if( lineEdit->objectName() == "Latitude" ) {
-            validateAndUpdatePosition(eLATITUDE, whole, frac, m_latitude, lineEdit);
-        }
-        else {
-            validateAndUpdatePosition(eLONGITUDE, whole, frac, m_longitude, lineEdit);
-        }
-    } else if(m_posFormat == PositionFormatType::eDMS) {
-        QStringList f = tmp.split(" ");
-        f[1].chop(1);
-        f[2].chop(1);
-        f[3].chop(1);
-
-        int32_t whole = f[1].toInt();
-        // convert minutes and seconds
-        int32_t fraction = static_cast<int32_t>(((f[2].toDouble() / 60.0) + (f[3].toDouble() / 3600.0)) * 1000000);
-
-        if( lineEdit->objectName() == "Latitude" ) {
-            if(f[0] == 'S' || f[0] == 's')
-                whole *= -1;
-            validateAndUpdatePosition(eLATITUDE, whole, fraction, m_latitude, lineEdit);
+    // get current displayed text
+    const QString displayed = lineEdit->displayText();
+    const std::u16string_view text = textView(displayed);
+
+    if( m_posFormat == PositionFormatType::eDECIMAL_DEG ||
+        m_posFormat == PositionFormatType::eDMS ) {
+        LatLonParser::AngleResult r = (m_posFormat == PositionFormatType::eDECIMAL_DEG)
+                ? LatLonParser::parseDecimalDeg(text)
+                : LatLonParser::parseDMS(text);
+        if( !r.isValid() )
+            return;
+
+        if( isLatitude ) {
+            validateAndUpdatePosition(eLATITUDE, r.whole, r.fraction, r.negative, &m_latitude, lineEdit);
         } else {
-            if(f[0] == 'W' || f[0] == 'w')
-                whole *= -1;
-            validateAndUpdatePosition(eLONGITUDE, whole, fraction, m_longitude, lineEdit);
+            validateAndUpdatePosition(eLONGITUDE, r.whole, r.fraction, r.negative, &m_longitude, lineEdit);
         }
     } else {
 
-        // UTM
-        double northing, easting;
+        // UTM, the zone and northing are in the latitude field
+        const QString otherDisplayed = isLatitude ? m_lonLineEdit->displayText()
+                                                  : m_latLineEdit->displayText();
+        const std::u16string_view other = textView(otherDisplayed);
         double latitude, longitude;
-        QByteArray zone;
-
-        // Northing
-        if( lineEdit->objectName() == "Latitude" ) {
-            // get zone and northing
-            QStringList f = tmp.split(' ');
-            northing = f[1].toDouble();
-            zone  = QByteArray::fromRawData(f[0].toUtf8(), f[0].length());
-
-            QString s = m_lonLineEdit->displayText();
-            QStringList f2 = s.split(' ');
-            easting = f2[0].toDouble();
-        } else { // Easting
-            QStringList f = tmp.split(' ');
-            easting = f[0].toDouble();
-
-            QString s = m_latLineEdit->displayText();
-            QStringList f2 = s.split(' ');
-            northing = f2[1].toDouble();
-            zone = QByteArray::fromRawData(f2[0].toUtf8(), f2[0].length());
-        }
-        // TODO: Validate northing and easting
-        UTM::UTMtoLL(northing, easting, zone.constData(), latitude, longitude);
-        m_latitude->setValue(latitude);
-        m_longitude->setValue(longitude);
+        if( !parseUTMText(isLatitude ? text : other, isLatitude ? other : text,
+                          m_utmEngine, latitude, longitude, m_datum) )
+            return;
+        m_latitude.setValue(latitude);
+        m_longitude.setValue(longitude);
     }
 
-    if( lineEdit->objectName() == "Latitude" ) {
-        emit latitudeChanged(m_latitude->getValue());
+    // the edit replaces the model's position until the model changes
+    m_followsModel = false;
+
+    if( isLatitude ) {
+        emit latitudeChanged(m_latitude.getValue());
     } else {
-        emit longitudeChanged(m_longitude->getValue());
+        emit longitudeChanged(m_longitude.getValue());
     }
 }
 
 void LatLonWidget::setPosition(const double &latitude, const double &longitude)
 {
-    m_latitude->setValue(latitude);
-    m_longitude->setValue(longitude);
+    LATLON_PROFILE(eSET_POSITION);
+    setShownPosition(latitude, longitude);
+    m_followsModel = false;
+
+    if( m_updateMode == UpdateMode::eCOALESCED ) {
+        // keep only the latest value, the timer shows it
+        if( !m_updateTimer->isActive() )
+            m_updateTimer->start();
+        return;
+    }
+
+    updateDisplay();
+}
+
+void LatLonWidget::setPositionModel(PositionModel *model)
+{
+    if( model == m_model )
+        return;
+
+    if( m_model )
+        disconnect(m_model.data(), &PositionModel::positionChanged, this, &LatLonWidget::positionModelChanged);
+
+    m_model = model;
+    m_followsModel = false;
+    if( m_model ) {
+        connect(m_model.data(), &PositionModel::positionChanged, this, &LatLonWidget::positionModelChanged);
+        positionModelChanged();
+    }
+}
+
+PositionModel *LatLonWidget::positionModel() const
+{
+    return m_model;
+}
+
+void LatLonWidget::positionModelChanged()
+{
+    m_followsModel = true;
+    if( showsModelText() ) {
+        m_latitude = m_model->latitude();
+        m_longitude = m_model->longitude();
+    } else {
+        double latitude, longitude;
+        m_model->getPosition(latitude, longitude);
+        setShownPosition(latitude, longitude);
+    }
+
+    if( m_updateMode == UpdateMode::eCOALESCED ) {
+        if( !m_updateTimer->isActive() )
+            m_updateTimer->start();
+        return;
+    }
+
+    updateDisplay();
+}
+
+PositionSlot *LatLonWidget::positionSlot()
+{
+    if( !m_slot ) {
+        m_slot.reset(new PositionSlot);
+        // called on the producer thread, once per take()
+        m_slot->setNotifier([this] {
+            QMetaObject::invokeMethod(this, "positionSlotReady", Qt::QueuedConnection);
+        });
+    }
+    return m_slot.get();
+}
+
+void LatLonWidget::positionSlotReady()
+{
+    if( m_updateMode == UpdateMode::eCOALESCED ) {
+        // taken when the frame is due, with whatever came in meanwhile
+        if( !m_updateTimer->isActive() )
+            m_updateTimer->start();
+        return;
+    }
+
+    if( takeSlotPosition() )
+        updateDisplay();
+}
+
+void LatLonWidget::updateTimerExpired()
+{
+    takeSlotPosition();
+    updateDisplay();
+}
+
+bool LatLonWidget::takeSlotPosition()
+{
+    double latitude, longitude;
+    if( !m_slot || !m_slot->take(latitude, longitude) )
+        return false;
+
+    LATLON_PROFILE(eSET_POSITION);
+    setShownPosition(latitude, longitude);
+    m_followsModel = false;
+    return true;
+}
+
+void LatLonWidget::setUpdateMode(UpdateMode mode, int intervalMs)
+{
+    m_updateMode = mode;
+
+    if( m_updateMode == UpdateMode::eCOALESCED ) {
+        if( !m_updateTimer ) {
+            m_updateTimer = new QTimer(this);
+            m_updateTimer->setSingleShot(true);
+            connect(m_updateTimer, &QTimer::timeout, this, &LatLonWidget::updateTimerExpired);
+        }
+        m_updateTimer->setInterval(intervalMs);
+    } else if( m_updateTimer && m_updateTimer->isActive() ) {
+        // show the pending value right away
+        m_updateTimer->stop();
+        updateTimerExpired();
+    }
+}
+
+void LatLonWidget::updateDisplay()
+{
+    if( showsModelText() ) {
+        // formatted once by the model for every widget using this format
+        setDisplayText(eLATITUDE, m_model->text(m_posFormat, eLATITUDE, m_decimalDegNotation, m_utmEngine));
+        setDisplayText(eLONGITUDE, m_model->text(m_posFormat, eLONGITUDE, m_decimalDegNotation, m_utmEngine));
+        return;
+    }
 
     if( m_posFormat == PositionFormatType::eDECIMAL_DEG) {
-        m_latLineEdit->setText(format(eDECIMAL_DEG, eLATITUDE, m_latitude));
-        m_lonLineEdit->setText(format(eDECIMAL_DEG, eLONGITUDE, m_longitude));
+        setDisplayText(eLATITUDE, format(eDECIMAL_DEG, eLATITUDE, &m_latitude));
+        setDisplayText(eLONGITUDE, format(eDECIMAL_DEG, eLONGITUDE, &m_longitude));
     }
     else if( m_posFormat == PositionFormatType::eDMS) {
-        m_latLineEdit->setText(format(eDMS, eLATITUDE, m_latitude));
-        m_lonLineEdit->setText(format(eDMS, eLONGITUDE, m_longitude));
+        setDisplayText(eLATITUDE, format(eDMS, eLATITUDE, &m_latitude));
+        setDisplayText(eLONGITUDE, format(eDMS, eLONGITUDE, &m_longitude));
     } else {
         formatUTM();
     }
 }
 
+void LatLonWidget::setDisplayText(ValueType type, const QString &text)
+{
+    if( m_displayMode == DisplayMode::ePAINTED ) {
+        QString &shown = m_paintedText[type];
+        if( shown == text )
+            return;
+
+        // Repaint from the first to the last changed character. When the
+        // characters in between changed width, everything after moves too.
+        const QRect box = valueRect(type);
+        const int common = std::min(shown.size(), text.size());
+        int first = 0;
+        while( first < common && shown.at(first) == text.at(first) )
+            ++first;
+
+        const qreal left = box.left() + kTextMargin + m_glyphs->advance(text, 0, first);
+        qreal right = box.right();
+        if( shown.size() == text.size() ) {
+            int last = common - 1;
+            while( last > first && shown.at(last) == text.at(last) )
+                --last;
+            const qreal oldWidth = m_glyphs->advance(shown, first, last + 1);
+            const qreal newWidth = m_glyphs->advance(text, first, last + 1);
+            if( oldWidth == newWidth )
+                right = left + newWidth;
+        }
+
+        shown = text;
+        update(QRect(QPoint(int(std::floor(left)), box.top() + 1),
+                     QPoint(int(std::ceil(right)), box.bottom() - 1)));
+        return;
+    }
+
+    QLineEdit *edit = (type == eLATITUDE) ? m_latLineEdit : m_lonLineEdit;
+
+    // setText re-runs the input mask and validator and repaints, skip it
+    // when the visible digits did not change
+    if( m_updateMode == UpdateMode::eCOALESCED && edit->displayText() == text )
+        return;
+
+    edit->setText(text);
+}
+
+void LatLonWidget::setDisplayMode(DisplayMode mode)
+{
+    if( mode == m_displayMode )
+        return;
+
+    m_displayMode = mode;
+    if( m_displayMode == DisplayMode::ePAINTED ) {
+        destroyEditors();
+        setLabels(m_labels[eLATITUDE], m_labels[eLONGITUDE]);
+        updateDisplay();
+    } else {
+        m_paintedText[eLATITUDE].clear();
+        m_paintedText[eLONGITUDE].clear();
+        m_glyphs = nullptr;
+        createEditors();
+    }
+
+    updateGeometry();
+    update();
+}
+
+void LatLonWidget::reset()
+{
+    emit aboutToReset();
+    setPositionModel(nullptr);
+    setUpdateMode(UpdateMode::eIMMEDIATE);
+    // a notification still queued finds no slot to take from
+    m_slot.reset();
+    m_datum = Datum::DatumType::eWGS84;
+    m_utmEngine = UTMEngineType::eFAST;
+    m_decimalDegNotation = NotationType::eSIGN;
+    m_latitude.setValue(0, 0);
+    m_longitude.setValue(0, 0);
+
+    // drop the invalid input style
+    m_isLatValid = m_isLonValid = true;
+    for( QLineEdit *edit : { static_cast<QLineEdit *>(m_latLineEdit), static_cast<QLineEdit *>(m_lonLineEdit) } ) {
+        if( edit && !edit->property("Valid").toBool() ) {
+            edit->setProperty("Valid", true);
+            edit->style()->unpolish(edit);
+            edit->style()->polish(edit);
+        }
+    }
+
+    setReadOnly(false);
+
+    // rebuilds the display and the labels
+    setPositionFormat(eDECIMAL_DEG);
+}
+
+void LatLonWidget::updateGlyphs()
+{
+    // values use the line edits' bold font
+    QFont valueFont = font();
+    valueFont.setBold(true);
+    m_glyphs = glyphCache(valueFont);
+
+    m_labelWidth = 0;
+    for( int type = eLATITUDE; type <= eLONGITUDE; ++type ) {
+        m_paintedLabels[type].setTextFormat(Qt::PlainText);
+        m_paintedLabels[type].setText(m_labels[type]);
+        m_paintedLabels[type].prepare(QTransform(), font());
+        m_labelWidth = std::max(m_labelWidth, int(std::ceil(m_paintedLabels[type].size().width())));
+    }
+
+    updateGeometry();
+    update();
+}
+
+QRect LatLonWidget::valueRect(ValueType type) const
+{
+    // the grid of the editor mode: label, spacing, value; one row per axis
+    const int rowHeight = std::max(kRowHeight, int(std::ceil(m_glyphs->height())) + 4);
+    const int left = m_labelWidth + kSpacing;
+    return QRect(left, type * (rowHeight + kSpacing), std::max(width() - left, kValueWidth), rowHeight);
+}
+
+QSize LatLonWidget::sizeHint() const
+{
+    if( m_displayMode != DisplayMode::ePAINTED )
+        return QWidget::sizeHint();
+
+    // wide enough for the longest text of the format
+    qreal textWidth = 0;
+    for( int type = eLATITUDE; type <= eLONGITUDE; ++type )
+        textWidth = std::max(textWidth, m_glyphs->advance(m_paintedText[type], 0, m_paintedText[type].size()));
+    const QRect latitude = valueRect(eLATITUDE);
+    const QRect longitude = valueRect(eLONGITUDE);
+    return QSize(latitude.left() + std::max(kValueWidth, int(std::ceil(textWidth)) + 2 * kTextMargin),
+                 longitude.bottom() + 1);
+}
+
+void LatLonWidget::paintEvent(QPaintEvent *event)
+{
+    if( m_displayMode != DisplayMode::ePAINTED ) {
+        QWidget::paintEvent(event);
+        return;
+    }
+
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    const qreal glyphTop = (valueRect(eLATITUDE).height() - m_glyphs->height()) / 2.0;
+
+    for( int type = eLATITUDE; type <= eLONGITUDE; ++type ) {
+        const QRect box = valueRect(ValueType(type));
+
+        const QRect label(0, box.top(), m_labelWidth, box.height());
+        if( dirty.intersects(label) ) {
+            painter.setPen(palette().color(QPalette::WindowText));
+            painter.setFont(font());
+            painter.drawStaticText(QPointF(0, box.top() + (box.height() - m_paintedLabels[type].size().height()) / 2.0),
+                                   m_paintedLabels[type]);
+        }
+
+        if( !dirty.intersects(box) )
+            continue;
+
+        // same look as the line edits' style sheet
+        painter.fillRect(box, Qt::black);
+        painter.setPen(Qt::white);
+        painter.drawRect(box.adjusted(0, 0, -1, -1));
+
+        // the glyphs overlapping the dirty area, usually just the changed digits
+        painter.setPen(QColor(0, 255, 0));
+        painter.setFont(m_glyphs->font());
+        const QString &text = m_paintedText[type];
+        qreal x = box.left() + kTextMargin;
+        for( int i = 0; i < text.size() && x <= dirty.right() + 1; ++i ) {
+            const Glyph &glyph = m_glyphs->glyph(text.at(i));
+            if( x + glyph.advance >= dirty.left() )
+                painter.drawStaticText(QPointF(x, box.top() + glyphTop), glyph.text);
+            x += glyph.advance;
+        }
+    }
+}
+
+void LatLonWidget::changeEvent(QEvent *event)
+{
+    if( event->type() == QEvent::FontChange && m_displayMode == DisplayMode::ePAINTED )
+        updateGlyphs();
+    QWidget::changeEvent(event);
+}
+
 void LatLonWidget::getPosition(double &latitude, double &longitude)
 {
-    latitude = m_latitude->getValue();
-    longitude = m_longitude->getValue();
+    latitude = m_latitude.getValue();
+    longitude = m_longitude.getValue();
+    if( m_datum != Datum::DatumType::eWGS84 )
+        Datum::transform(m_datum, Datum::DatumType::eWGS84).apply(latitude, longitude, latitude, longitude);
+}
+
+void LatLonWidget::setDatum(Datum::DatumType datum)
+{
+    if( datum == m_datum )
+        return;
+
+    double latitude, longitude;
+    getPosition(latitude, longitude);
+    m_datum = datum;
+
+    if( m_model && m_followsModel ) {
+        // the model's position on the new datum, or its text again on WGS84
+        positionModelChanged();
+        return;
+    }
+    setShownPosition(latitude, longitude);
+    updateDisplay();
+}
+
+///
+/// \brief Whether the display is the model's text, formatted once for all
+/// widgets following it. The model's text is WGS84's.
+///
+bool LatLonWidget::showsModelText() const
+{
+    return m_model && m_followsModel && m_datum == Datum::DatumType::eWGS84;
+}
+
+///
+/// \brief Set the position shown from a WGS84 one, in the widget's datum.
+///
+void LatLonWidget::setShownPosition(double latitude, double longitude)
+{
+    if( m_datum != Datum::DatumType::eWGS84 )
+        Datum::transform(Datum::DatumType::eWGS84, m_datum).apply(latitude, longitude, latitude, longitude);
+    m_latitude.setValue(latitude);
+    m_longitude.setValue(longitude);
 }
 
 void LatLonWidget::setReadOnly(bool flag)
 {
     m_isReadOnly = flag;
+    if( !m_latLineEdit )
+        return;
+
     m_latLineEdit->setReadOnly(m_isReadOnly);
     m_lonLineEdit->setReadOnly(m_isReadOnly);
 
+    // Validators only exist while the position can be edited, the line
+    // edits own them
+    if( !m_isReadOnly && !m_latValidator ) {
+        const FormatTable &table = formatTable();
+        m_latValidator = new QRegularExpressionValidator(m_latLineEdit);
+        m_lonValidator = new QRegularExpressionValidator(m_lonLineEdit);
+        m_latValidator->setRegularExpression(table.get(m_posFormat, eLATITUDE, m_decimalDegNotation).regExp);
+        m_lonValidator->setRegularExpression(table.get(m_posFormat, eLONGITUDE, m_decimalDegNotation).regExp);
+        m_latLineEdit->setValidator(m_latValidator);
+        m_lonLineEdit->setValidator(m_lonValidator);
+    } else if( m_isReadOnly && m_latValidator ) {
+        m_latLineEdit->setValidator(nullptr);
+        m_lonLineEdit->setValidator(nullptr);
+        delete m_latValidator;
+        delete m_lonValidator;
+        m_latValidator = m_lonValidator = nullptr;
+    }
+
     if(!m_isReadOnly) {
         if( m_isLatValid ) {
             m_latLineEdit->setProperty("Valid", true);
@@ -437,46 +910,35 @@ void LatLonWidget::setReadOnly(bool flag)
 }
 
 
-bool LatLonWidget::isLatitudeValid(int32_t whole, int32_t frac)
-{
-    bool valid {true};
-    if((whole > 90) || (whole < -90) || ( (whole == 90 || whole == -90) && (frac > 0)))
-        valid = false;
-    return valid;
-}
-
-bool LatLonWidget::isLongitudeValid(int32_t whole, int32_t frac)
-{
-    bool valid {true};
-    if((whole > 180) || (whole < -180) || ( (whole == 180 || whole == -180) && (frac > 0)))
-        valid = false;
-    return valid;
-}
-
-void LatLonWidget::validateAndUpdatePosition(ValueType type, int32_t whole,
-                                             int32_t frac, FloatType *value, QLineEdit *edit)
+void LatLonWidget::validateAndUpdatePosition(ValueType type, int32_t whole, int32_t frac,
+                                             bool negative, FloatType *value, QLineEdit *edit)
 {
-    bool isValid = true;
-    if( type == eLATITUDE ) {
-        isValid = isLatitudeValid(whole, frac);
-    } else {
-        isValid = isLongitudeValid(whole, frac);
-    }
-
-    value->setValue(whole, frac);
-    if( isValid ) {
-        edit->setStyleSheet(lineEditStyle + validStyle);
-
-    } else {
-        edit->setStyleSheet(lineEditStyle + invalidStyle);
+    LATLON_PROFILE(eVALIDATE);
+    const bool isValid = isInRange(type, whole, frac);
+
+    value->setValue(whole, frac, negative);
+
+    // Only restyle on valid <-> invalid transitions. The style sheet is
+    // already parsed, re-polishing picks the rule matching the property.
+    bool &wasValid = (type == eLATITUDE) ? m_isLatValid : m_isLonValid;
+    if( isValid != wasValid ) {
+        wasValid = isValid;
+        edit->setProperty("Valid", isValid);
+        edit->style()->unpolish(edit);
+        edit->style()->polish(edit);
+        emit isPositionValid(m_isLatValid && m_isLonValid);
     }
 }
 
 void LatLonWidget::setPositionFormat(int format)
 {
+    LATLON_PROFILE(eSET_POSITION_FORMAT);
     m_posFormat = static_cast<PositionFormatType>(format);
 
-    if( m_posFormat == PositionFormatType::eDECIMAL_DEG) {
+    if( m_displayMode == DisplayMode::ePAINTED ) {
+        updateDisplay();
+        updateGeometry();
+    } else if( m_posFormat == PositionFormatType::eDECIMAL_DEG) {
         setupDegDisplay();
     } else if( m_posFormat == PositionFormatType::eDMS) {
         setupDMSDisplay();
@@ -1,14 +1,25 @@
 #ifndef LATLONWIDGET_H
 #define LATLONWIDGET_H
 
+#include <QPointer>
+#include <QStaticText>
 #include <QWidget>
 
+#include "floattype.h"
+
+#include <memory>
+
 class QLabel;
 class QLineEdit;
 class QGridLayout;
 class QRegularExpressionValidator;
-struct FloatType;
+class QTimer;
 class MyLineEdit;
+class PositionModel;
+class PositionSlot;
+
+namespace LatLonDisplay { class GlyphCache; }
+namespace Datum { enum class DatumType; }
 
 class LatLonWidget : public QWidget
 {
@@ -31,33 +42,28 @@ public:
         eDIRECTION
     };
 
-    // String Constants
-    QString latDegInputMask = QStringLiteral("#00.000000\u00B0;0");
-    QString latDecimalDegMask = QStringLiteral("x 00.000000\u00B0;0");
-    QString latDMSInputMask = QStringLiteral("x 00\u00B0 00' 00.00\";0");
-    QString latUTMInputMask = QStringLiteral("99A 0000000 m;0");
-
-    QString latDegRegExp = QStringLiteral("(-|\\+)\\d{1,2}\\.\\d{0,6}\u00B0");
-    QString latDecimalDegRegExp = QStringLiteral("^(N|S|n|s) \\d{1,2}\\.\\d{0,6}\u00B0");
-    QString latDMSRegExp = QStringLiteral("^(N|S|n|s)\\s \\d{1,2}\u00B0\\s [0-5][0-9]'\\s [0-5][0-9].\\d{1,2}\"");
-    QString latUTMRegExp = QStringLiteral("[0-9][0-9][C-Z] \\d{0,7} m");
-
-    QString lonDegInputMask = QStringLiteral("#000.000000\u00B0;0");
-    QString lonDecimalDegMask = QStringLiteral("x 000.000000\u00B0;0");
-    QString lonDMSInputMask = QStringLiteral("x 000\u00B0 00' 00.00\";0");
-    QString lonUTMInputMask = QStringLiteral("000000 m;0");
-
-    QString lonDegRegExp = QStringLiteral("(-|\\+)[0-1]\\d{1,2}.\\d{0,6}\u00B0");
-    QString lonDecimalDegRegExp = QStringLiteral("^(E|W|e|w) [0-1]\\d{1,2}.\\d{0,6}\u00B0");
-    QString lonDMSRegExp = QStringLiteral("^(E|W|e|w)\\s [0-1]\\d{1,2}\u00B0\\s [0-5][0-9]'\\s [0-5][0-9].\\d{1,2}\"");
-    QString lonUTMRegExp = QStringLiteral("\\d{0,6} m");
+    // Transverse Mercator series for the UTM display and input
+    enum class UTMEngineType {
+        eFAST,          // USGS Bulletin 1532, about 1 mm within the zone
+        ePRECISE,       // 6th order Krueger, nanometres up to 3900 km off the meridian
+        eTABLE          // eFAST with tabulated latitude terms, within 0.005 mm of it
+    };
 
-    QString validStyle = QStringLiteral("border-width: 1px; border-color: white;");
-    QString invalidStyle = QStringLiteral("border-width: 2px; border-color: red;");
-    QString lineEditStyle = QStringLiteral("background-color: black; border-style: solid; font-weight: bold; color: lime;");
+    // How setPosition() updates the display
+    enum class UpdateMode {
+        eIMMEDIATE,     // reformat and set the text on every call
+        eCOALESCED      // keep the latest value, show it at most once per interval
+    };
 
+    // How the position is shown
+    enum class DisplayMode {
+        eEDITOR,        // line edits with input masks and validation
+        ePAINTED        // read-only text painted by the widget, no child widgets
+    };
 
     explicit LatLonWidget(QWidget *parent = nullptr);
+    explicit LatLonWidget(DisplayMode mode, QWidget *parent = nullptr);
+    ~LatLonWidget() override;
 
     // Setup methods
     void setupDegDisplay();
@@ -69,46 +75,134 @@ public:
     void formatUTM();
 
     void setNotation(NotationType notation);
+    void setUTMEngine(UTMEngineType engine);
+
+    // Opt-in rate limiting for high frequency setPosition() callers.
+    // The default interval is one 60 Hz display frame.
+    void setUpdateMode(UpdateMode mode, int intervalMs = 16);
+
+    // Lightweight read-only display for screens showing many positions.
+    // Painted mode drops the line edits, labels and validators and only
+    // repaints the characters that changed. setPosition() and
+    // setPositionFormat() work the same in both modes; editing needs eEDITOR.
+    void setDisplayMode(DisplayMode mode);
+    DisplayMode displayMode() const { return m_displayMode; }
+
+    // Show the position of a model shared with other widgets, formatted
+    // once per format for all of them; nullptr unbinds. See PositionModel.
+    void setPositionModel(PositionModel *model);
+    PositionModel *positionModel() const;
+
+    // Lock-free input for positions produced on other threads: publish
+    // into the slot from any thread, the widget takes the latest value on
+    // its own thread, once per frame in eCOALESCED mode. Created on the
+    // first call, which must be on the widget's thread; stop the producers
+    // before deleting the widget. See PositionSlot.
+    PositionSlot *positionSlot();
+
+    // Show and accept positions on another datum, for charts in ED50,
+    // NAD27 or OSGB36. setPosition() and getPosition() stay in WGS84 and
+    // transform once per call; the text, what is typed and the
+    // latitudeChanged()/longitudeChanged() values are on the datum, UTM on
+    // its ellipsoid, so typing costs the same on any datum. See Datum.
+    void setDatum(Datum::DatumType datum);
+    Datum::DatumType datum() const { return m_datum; }
+
+    QSize sizeHint() const override;
+
+    // Back to the state of a new widget (keeping the display mode). Drops
+    // the model and the positionSlot(), whose producers must be stopped
+    // first; emits aboutToReset() for other inputs to let go.
+    void reset();
 
 public slots:
     void textChanged();
     void setPositionFormat(int format);
     void setPosition(const double &latitude, const double &longitude);
     void getPosition(double &latitude, double &longitude);
+    void updateDisplay();
 
 public:
     void setReadOnly(bool flag);
 
 
-private:    
-    inline bool isLatitudeValid(int32_t whole, int32_t frac);
-    inline bool isLongitudeValid(int32_t whole, int32_t frac);
-    void validateAndUpdatePosition(ValueType type, int32_t whole,
-                                   int32_t frac, FloatType *value, QLineEdit *edit);
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private slots:
+    void positionModelChanged();
+    void positionSlotReady();
+    void updateTimerExpired();
+
+private:
+    void createEditors();
+    void destroyEditors();
+    void validateAndUpdatePosition(ValueType type, int32_t whole, int32_t frac,
+                                   bool negative, FloatType *value, QLineEdit *edit);
+    void setDisplayText(ValueType type, const QString &text);
+    bool takeSlotPosition();
+    void setShownPosition(double latitude, double longitude);
+    bool showsModelText() const;
+
+    // Painted mode
+    void updateGlyphs();
+    QRect valueRect(ValueType type) const;
 
 signals:
+    // Typed text crossed between in and out of range: true when both the
+    // latitude and the longitude are valid again. Not emitted for
+    // keystrokes that keep the state, nor by reset(), which drops the
+    // invalid state silently
     void isPositionValid(bool);
     void latitudeChanged(double);
     void longitudeChanged(double);
 
+    // From reset(), before anything is reset: disconnect what feeds the
+    // widget, e.g. position sources, so a pooled widget comes back unbound
+    void aboutToReset();
+
 private:
     PositionFormatType m_posFormat = PositionFormatType::eDECIMAL_DEG;
 
     // Ui elements
     MyLineEdit *m_latLineEdit{};
     MyLineEdit *m_lonLineEdit{};
-    QLabel *m_label1;
-    QLabel *m_label2;
+    QLabel *m_label1{};
+    QLabel *m_label2{};
     QGridLayout *m_layout{};
 
-    // RegEx validators
+    // RegEx validators, only while editable; owned by the line edits
     QRegularExpressionValidator *m_latValidator{};
     QRegularExpressionValidator *m_lonValidator{};
 
-    FloatType *m_latitude{};
-    FloatType *m_longitude{};
+    FloatType m_latitude {0, 0};
+    FloatType m_longitude {0, 0};
 
     NotationType m_decimalDegNotation {NotationType::eSIGN};
+    UTMEngineType m_utmEngine {UTMEngineType::eFAST};
+
+    UpdateMode m_updateMode {UpdateMode::eIMMEDIATE};
+    QTimer *m_updateTimer {};
+
+    // Bound model; m_followsModel until an edit, setPosition() or slot
+    // input replaces its position, see showsModelText()
+    QPointer<PositionModel> m_model;
+    bool m_followsModel {};
+
+    std::unique_ptr<PositionSlot> m_slot;
+
+    Datum::DatumType m_datum {};    // eWGS84
+
+    DisplayMode m_displayMode {DisplayMode::eEDITOR};
+    QString m_labels[2];
+
+    // Painted mode: the text shown, the labels laid out once and the glyphs
+    // of the value font
+    QString m_paintedText[2];
+    QStaticText m_paintedLabels[2];
+    LatLonDisplay::GlyphCache *m_glyphs {};
+    int m_labelWidth {};
 
     bool m_isReadOnly {};
     bool m_isLatValid {true};
@@ -0,0 +1,165 @@
+#ifndef LATLONWIDGET_P_H
+#define LATLONWIDGET_P_H
+
+//
+// Not part of the public API. Formatting and validation shared by
+// LatLonWidget and LatLonItemDelegate, so a position looks and edits the
+// same in a form and in an item view.
+//
+
+#include "latlonwidget.h"
+#include "datum.h"
+
+#include <QFont>
+#include <QFontMetricsF>
+#include <QHash>
+#include <QLineEdit>
+#include <QRegularExpression>
+#include <QRegularExpressionValidator>
+#include <QStaticText>
+#include <QString>
+
+#include <cstdint>
+#include <string_view>
+
+struct FloatType;
+
+namespace LatLonDisplay
+{
+
+///
+/// \brief Input mask and validator expression for one line edit.
+///
+struct DisplayFormat
+{
+    QString inputMask;
+    QRegularExpression regExp;
+};
+
+///
+/// \brief Immutable masks, expressions and styles shared by all LatLonWidget instances.
+///
+/// Built on first use. The expressions are compiled once here, every widget
+/// then holds an implicitly shared copy.
+///
+struct FormatTable
+{
+    FormatTable();
+
+    const DisplayFormat &get(LatLonWidget::PositionFormatType posFormat,
+                             LatLonWidget::ValueType type,
+                             LatLonWidget::NotationType notation) const
+    {
+        return formats[posFormat][type][notation == LatLonWidget::NotationType::eSIGN ? 0 : 1];
+    }
+
+    // [format][value type][notation], DMS and UTM ignore the notation
+    DisplayFormat formats[3][2][2];
+
+    // One sheet for both states, selected by the "Valid" property
+    QString lineEditStyle;
+
+private:
+    void set(LatLonWidget::PositionFormatType posFormat, LatLonWidget::ValueType type,
+             int notation, const QString &inputMask, const QString &regExp)
+    {
+        DisplayFormat &f = formats[posFormat][type][notation];
+        f.inputMask = inputMask;
+        f.regExp.setPattern(regExp);
+        f.regExp.optimize();
+    }
+};
+
+const FormatTable &formatTable();
+
+// The core library works on plain UTF-16, view a QString's data as such
+inline std::u16string_view textView(const QString &text)
+{
+    return std::u16string_view(reinterpret_cast<const char16_t *>(text.utf16()),
+                               std::size_t(text.size()));
+}
+
+inline void applyDisplayFormat(QLineEdit *edit, QRegularExpressionValidator *validator,
+                               const DisplayFormat &format)
+{
+    edit->setInputMask(format.inputMask);
+    // read-only line edits have no validator
+    if( validator )
+        validator->setRegularExpression(format.regExp);
+    edit->setValidator(validator);
+}
+
+///
+/// \brief One character laid out once, drawn with QPainter::drawStaticText().
+///
+struct Glyph
+{
+    QStaticText text;
+    qreal advance {};
+};
+
+///
+/// \brief Laid out characters of one font, shared by the painted widgets using it.
+///
+/// Only a few dozen characters ever occur in a position, so each is laid out
+/// the first time it is drawn and kept for the lifetime of the program.
+///
+class GlyphCache
+{
+public:
+    explicit GlyphCache(const QFont &font);
+
+    const QFont &font() const { return m_font; }
+    qreal height() const { return m_height; }
+
+    const Glyph &glyph(QChar c);
+
+    /// Width of text[begin, end) drawn glyph by glyph.
+    qreal advance(const QString &text, int begin, int end);
+
+private:
+    QFont m_font;
+    QFontMetricsF m_metrics;
+    qreal m_height;
+    QHash<char16_t, Glyph> m_glyphs;
+};
+
+///
+/// \brief The cache for a font, created on first use. GUI thread only.
+///
+GlyphCache *glyphCache(const QFont &font);
+
+///
+/// \brief Decimal degree or DMS text of one axis, as shown in the line edits.
+///
+QString formatText(LatLonWidget::PositionFormatType posFormat, LatLonWidget::ValueType type,
+                   LatLonWidget::NotationType notation, const FloatType &value);
+
+///
+/// \brief UTM northing (with zone) and easting text of a position, projected
+/// on the ellipsoid of its datum.
+///
+void formatUTMText(double latitude, double longitude, LatLonWidget::UTMEngineType engine,
+                   QString &northing, QString &easting,
+                   Datum::DatumType datum = Datum::DatumType::eWGS84);
+
+///
+/// \brief Position of UTM northing (with zone) and easting text, false if either does not
+/// parse or lies outside a UTM zone (zone 1..60, northing 0..10000 km, easting 100..900 km).
+///
+bool parseUTMText(std::u16string_view northing, std::u16string_view easting,
+                  LatLonWidget::UTMEngineType engine, double &latitude, double &longitude,
+                  Datum::DatumType datum = Datum::DatumType::eWGS84);
+
+///
+/// \brief Range check of parsed input, +-90 for latitudes and +-180 for longitudes.
+///
+inline bool isInRange(LatLonWidget::ValueType type, int32_t whole, int32_t frac)
+{
+    const int32_t limit = (type == LatLonWidget::eLATITUDE) ? 90 : 180;
+    return !((whole > limit) || (whole < -limit) || ((whole == limit || whole == -limit) && (frac > 0)));
+}
+
+} // namespace LatLonDisplay
+
+#endif // LATLONWIDGET_P_H
@@ -0,0 +1,68 @@
+#include "latlonwidgetpool.h"
+
+///
+/// \brief LatLonWidgetPool::LatLonWidgetPool
+/// \param capacity   idle widgets kept, per pool
+///
+LatLonWidgetPool::LatLonWidgetPool(std::size_t capacity) :
+    m_capacity(capacity)
+{
+}
+
+LatLonWidgetPool::~LatLonWidgetPool()
+{
+    clear();
+}
+
+LatLonWidget *LatLonWidgetPool::acquire(QWidget *parent, LatLonWidget::DisplayMode mode)
+{
+    std::vector<LatLonWidget *> &idle = m_idle[int(mode)];
+    if( idle.empty() )
+        return new LatLonWidget(mode, parent);
+
+    LatLonWidget *widget = idle.back();
+    idle.pop_back();
+    widget->setParent(parent);
+    // reparenting hides it; a new child is shown with its form
+    if( parent )
+        widget->show();
+    return widget;
+}
+
+void LatLonWidgetPool::release(LatLonWidget *widget)
+{
+    if( !widget )
+        return;
+
+    std::vector<LatLonWidget *> &idle = m_idle[int(widget->displayMode())];
+    if( idleCount() >= m_capacity ) {
+        delete widget;
+        return;
+    }
+
+    // out of the form (and its layout) and as new; setParent() hides it
+    // without marking it hidden, so acquire() can show it again
+    widget->setParent(nullptr);
+    widget->reset();
+    QObject::disconnect(widget, &LatLonWidget::isPositionValid, nullptr, nullptr);
+    QObject::disconnect(widget, &LatLonWidget::latitudeChanged, nullptr, nullptr);
+    QObject::disconnect(widget, &LatLonWidget::longitudeChanged, nullptr, nullptr);
+    QObject::disconnect(widget, &LatLonWidget::aboutToReset, nullptr, nullptr);
+    idle.push_back(widget);
+}
+
+void LatLonWidgetPool::reserve(std::size_t count, LatLonWidget::DisplayMode mode)
+{
+    std::vector<LatLonWidget *> &idle = m_idle[int(mode)];
+    while( idle.size() < count && idleCount() < m_capacity )
+        idle.push_back(new LatLonWidget(mode));
+}
+
+void LatLonWidgetPool::clear()
+{
+    for( std::vector<LatLonWidget *> &idle : m_idle ) {
+        for( LatLonWidget *widget : idle )
+            delete widget;
+        idle.clear();
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef LATLONWIDGETPOOL_H
+#define LATLONWIDGETPOOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "latlonwidget.h"
+
+///
+/// \brief Recycles LatLonWidget instances for forms, list and scroll views
+/// that create and drop them constantly.
+///
+/// acquire() hands out an idle widget of the requested display mode, reset
+/// to the state of a new one, or creates one. release() takes it back
+/// instead of deleting it; the pool keeps up to capacity() idle widgets
+/// and deletes the rest. Widgets still in use when the pool goes away are
+/// not affected, idle ones are deleted.
+///
+/// The widget's own signals are disconnected on release. Qt has no way to
+/// drop the connections made to its slots from any sender: remove them
+/// when LatLonWidget::aboutToReset() is emitted, as NmeaPositionSource
+/// does, or before release(). Producers writing to its positionSlot()
+/// must be stopped before release(), the slot goes with the reset.
+///
+class LatLonWidgetPool
+{
+public:
+    explicit LatLonWidgetPool(std::size_t capacity = 64);
+    ~LatLonWidgetPool();
+
+    LatLonWidgetPool(const LatLonWidgetPool &) = delete;
+    LatLonWidgetPool &operator=(const LatLonWidgetPool &) = delete;
+
+    LatLonWidget *acquire(QWidget *parent = nullptr,
+                          LatLonWidget::DisplayMode mode = LatLonWidget::DisplayMode::eEDITOR);
+    void release(LatLonWidget *widget);
+
+    ///
+    /// \brief Create idle widgets up front, e.g. before a form is opened.
+    ///
+    void reserve(std::size_t count, LatLonWidget::DisplayMode mode = LatLonWidget::DisplayMode::eEDITOR);
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t idleCount() const { return m_idle[0].size() + m_idle[1].size(); }
+
+    /// Delete all idle widgets.
+    void clear();
+
+private:
+    std::size_t m_capacity;
+
+    // idle widgets by display mode; switching modes would rebuild the editors
+    std::vector<LatLonWidget *> m_idle[2];
+};
+
+#endif // LATLONWIDGETPOOL_H
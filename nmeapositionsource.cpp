@@ -0,0 +1,274 @@
+#include "nmeapositionsource.h"
+#include "latlonwidget.h"
+
+#include <QIODevice>
+
+#include <cstring>
+
+namespace {
+
+// Buffer fills handled per event loop pass, so that reading a large file
+// does not hold up the GUI
+const int kReadsPerPass = 16;
+
+const qint64 kDayMs = 24 * 60 * 60 * 1000;
+
+} // namespace
+
+///
+/// \brief NmeaPositionSource::NmeaPositionSource
+/// \param parent
+///
+NmeaPositionSource::NmeaPositionSource(QObject *parent) :
+    QObject(parent)
+{
+    m_replayTimer.setSingleShot(true);
+    connect(&m_replayTimer, &QTimer::timeout, this, &NmeaPositionSource::replayNext);
+}
+
+void NmeaPositionSource::setDevice(QIODevice *device)
+{
+    if( m_device == device )
+        return;
+
+    stop();
+    if( m_device )
+        disconnect(m_device, nullptr, this, nullptr);
+
+    m_device = device;
+    m_begin = m_end = 0;
+    m_isDiscarding = false;
+    m_isDeviceFinished = false;
+    if( m_device ) {
+        connect(m_device, &QIODevice::readyRead, this, &NmeaPositionSource::readAvailable);
+        connect(m_device, &QIODevice::readChannelFinished, this, &NmeaPositionSource::readChannelFinished);
+    }
+}
+
+QIODevice *NmeaPositionSource::device() const
+{
+    return m_device;
+}
+
+void NmeaPositionSource::setReplaySpeed(double speed)
+{
+    m_replaySpeed = (speed > 0) ? speed : 0;
+
+    // pace from the next fix on
+    m_replayOriginMs = -1;
+    if( m_hasPending && m_replayTimer.isActive() ) {
+        m_replayTimer.stop();
+        replayNext();
+    }
+}
+
+void NmeaPositionSource::addWidget(LatLonWidget *widget)
+{
+    if( !connect(this, &NmeaPositionSource::positionUpdated, widget, &LatLonWidget::setPosition,
+                 Qt::UniqueConnection) )
+        return;
+
+    // a widget going back to a LatLonWidgetPool stops following the source
+    connect(widget, &LatLonWidget::aboutToReset, this, [this, widget] {
+        removeWidget(widget);
+    });
+}
+
+void NmeaPositionSource::removeWidget(LatLonWidget *widget)
+{
+    disconnect(this, &NmeaPositionSource::positionUpdated, widget, &LatLonWidget::setPosition);
+    disconnect(widget, &LatLonWidget::aboutToReset, this, nullptr);
+}
+
+///
+/// \brief Start reading; data already waiting in the device is read on
+/// the next event loop pass.
+///
+void NmeaPositionSource::start()
+{
+    if( m_isActive || !m_device )
+        return;
+
+    m_isActive = true;
+    m_replayOriginMs = -1;
+    m_lastTimeMs = -1;
+    m_dayOffsetMs = 0;
+    QTimer::singleShot(0, this, &NmeaPositionSource::readAvailable);
+}
+
+///
+/// \brief Stop reading. Unread data stays in the device; a fix waiting
+/// for its replay time is dropped.
+///
+void NmeaPositionSource::stop()
+{
+    m_isActive = false;
+    m_hasPending = false;
+    m_replayTimer.stop();
+}
+
+void NmeaPositionSource::readAvailable()
+{
+    if( !m_isActive || !m_device || m_hasPending )
+        return;
+
+    for( int i = 0; i < kReadsPerPass; ++i ) {
+        if( m_begin > 0 ) {
+            std::memmove(m_buffer, m_buffer + m_begin, std::size_t(m_end - m_begin));
+            m_end -= m_begin;
+            m_begin = 0;
+        }
+        if( m_end == eBUFFER_SIZE ) {
+            // no line end in a full buffer: not NMEA, drop up to the next one
+            ++m_statistics.invalid;
+            m_end = 0;
+            m_isDiscarding = true;
+        }
+
+        const qint64 n = m_device->read(m_buffer + m_end, eBUFFER_SIZE - m_end);
+        if( n < 0 ) {
+            m_isDeviceFinished = true;
+            break;
+        }
+        if( n == 0 )
+            break;
+        m_end += int(n);
+        if( !processLines() )
+            return;     // waiting for the replay time of a fix
+    }
+
+    if( m_device->bytesAvailable() > 0 ) {
+        QTimer::singleShot(0, this, &NmeaPositionSource::readAvailable);
+        return;
+    }
+    if( m_isDeviceFinished || (!m_device->isSequential() && m_device->atEnd()) )
+        finish();
+}
+
+void NmeaPositionSource::readChannelFinished()
+{
+    m_isDeviceFinished = true;
+    readAvailable();
+}
+
+void NmeaPositionSource::replayNext()
+{
+    if( !m_hasPending )
+        return;
+
+    m_hasPending = false;
+    emitFix(m_pending);
+    if( processLines() )
+        readAvailable();
+}
+
+///
+/// \brief Handle the complete lines in the buffer.
+/// \return false while a fix waits for its replay time
+///
+bool NmeaPositionSource::processLines()
+{
+    while( !m_hasPending ) {
+        const char *begin = m_buffer + m_begin;
+        const char *newline = static_cast<const char *>(std::memchr(begin, '\n', std::size_t(m_end - m_begin)));
+        if( !newline )
+            return true;
+
+        const int length = int(newline - begin) + 1;
+        m_begin += length;
+        if( m_isDiscarding ) {
+            m_isDiscarding = false;
+            continue;
+        }
+        if( !processLine(std::string_view(begin, std::size_t(length))) )
+            return false;
+    }
+    return false;
+}
+
+bool NmeaPositionSource::processLine(std::string_view line)
+{
+    // blank lines between sentences
+    if( line.find_first_not_of("\r\n") == std::string_view::npos )
+        return true;
+
+    ++m_statistics.sentences;
+    const NmeaParser::Fix fix = NmeaParser::parseSentence(line);
+    switch( fix.error ) {
+    case NmeaParser::eNO_ERROR:
+        if( !fix.hasPosition )
+            return true;
+        ++m_statistics.fixes;
+        return deliver(fix);
+    case NmeaParser::eMISSING_CHECKSUM:
+    case NmeaParser::eBAD_CHECKSUM:
+        ++m_statistics.checksumErrors;
+        return true;
+    case NmeaParser::eUNSUPPORTED_SENTENCE:
+        ++m_statistics.ignored;
+        return true;
+    default:
+        ++m_statistics.invalid;
+        return true;
+    }
+}
+
+///
+/// \brief Emit the fix now, or hold it back until its replay time.
+/// \return false when held back
+///
+bool NmeaPositionSource::deliver(const NmeaParser::Fix &fix)
+{
+    if( m_replaySpeed > 0 && fix.timeMs >= 0 ) {
+        qint64 timeMs = fix.timeMs + m_dayOffsetMs;
+        if( m_lastTimeMs >= 0 && timeMs + kDayMs / 2 < m_lastTimeMs ) {
+            // past midnight
+            m_dayOffsetMs += kDayMs;
+            timeMs += kDayMs;
+        }
+        m_lastTimeMs = timeMs;
+
+        if( m_replayOriginMs < 0 ) {
+            m_replayOriginMs = timeMs;
+            m_replayClock.start();
+        }
+        const qint64 waitMs = qint64(double(timeMs - m_replayOriginMs) / m_replaySpeed)
+                - m_replayClock.elapsed();
+        if( waitMs > 0 ) {
+            m_pending = fix;
+            m_hasPending = true;
+            m_replayTimer.start(int(waitMs));
+            return false;
+        }
+    }
+
+    emitFix(fix);
+    return true;
+}
+
+void NmeaPositionSource::emitFix(const NmeaParser::Fix &fix)
+{
+    // GGA and RMC of one epoch carry the same position
+    if( m_hasLast && fix.latitude == m_lastLatitude && fix.longitude == m_lastLongitude )
+        return;
+
+    m_lastLatitude = fix.latitude;
+    m_lastLongitude = fix.longitude;
+    m_hasLast = true;
+    emit positionUpdated(fix.latitude, fix.longitude);
+}
+
+void NmeaPositionSource::finish()
+{
+    // a last sentence without line end
+    if( m_end > m_begin && !m_isDiscarding ) {
+        const std::string_view rest(m_buffer + m_begin, std::size_t(m_end - m_begin));
+        m_begin = m_end;
+        if( !processLine(rest) )
+            return;     // finished after the replay of that fix
+    }
+
+    m_begin = m_end = 0;
+    m_isActive = false;
+    emit finished();
+}
@@ -0,0 +1,131 @@
+#ifndef NMEAPOSITIONSOURCE_H
+#define NMEAPOSITIONSOURCE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include <string_view>
+
+#include "nmeaparser.h"
+
+class QIODevice;
+class LatLonWidget;
+
+///
+/// \brief Positions from a stream of NMEA 0183 GGA and RMC sentences.
+///
+/// Reads any QIODevice: a serial port or socket as the data arrives, a
+/// file or pipe to the end. Each fix is emitted as positionUpdated() and
+/// set on the widgets added with addWidget(); to show it in many widgets,
+/// connect positionUpdated() to a PositionModel instead.
+/// \code
+/// QSerialPort *port = ...;
+/// NmeaPositionSource *gps = new NmeaPositionSource(this);
+/// gps->setDevice(port);
+/// gps->addWidget(ownshipWidget);
+/// gps->start();
+/// \endcode
+///
+/// Sentences are read into a fixed buffer and parsed in place (see
+/// NmeaParser); nothing is allocated per sentence. Sentences with a bad
+/// checksum or fields are counted in statistics() and dropped, as are
+/// other sentence types. A fix repeating the previous position (GGA and
+/// RMC of the same epoch) is not emitted again.
+///
+/// With a replay speed set, recorded data is paced by the time of day in
+/// the sentences instead of being read as fast as possible: at 1 in real
+/// time, at 10 ten times as fast.
+///
+class NmeaPositionSource : public QObject
+{
+    Q_OBJECT
+public:
+    struct Statistics
+    {
+        quint64 sentences {};       ///< lines read
+        quint64 fixes {};           ///< GGA and RMC with a position
+        quint64 checksumErrors {};  ///< bad or missing checksum
+        quint64 invalid {};         ///< unparsable GGA or RMC, or too long
+        quint64 ignored {};         ///< other sentence types
+    };
+
+    explicit NmeaPositionSource(QObject *parent = nullptr);
+
+    ///
+    /// \brief Read from device, which must be open for reading by start().
+    ///
+    /// Not owned. Stops reading the previous device.
+    ///
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    ///
+    /// \brief Pace recorded data at speed times the rate it was recorded at.
+    ///
+    /// 0 (the default) reads as fast as the device delivers, for live
+    /// receivers and throughput tests.
+    ///
+    void setReplaySpeed(double speed);
+    double replaySpeed() const { return m_replaySpeed; }
+
+    /// Set each fix on widget; the connection goes when either is deleted
+    /// or the widget is reset(), e.g. on its way back to a LatLonWidgetPool.
+    void addWidget(LatLonWidget *widget);
+    void removeWidget(LatLonWidget *widget);
+
+    const Statistics &statistics() const { return m_statistics; }
+
+    void start();
+    void stop();
+    bool isActive() const { return m_isActive; }
+
+signals:
+    void positionUpdated(double latitude, double longitude);
+
+    /// The device has no more data (end of file, pipe or socket closed).
+    void finished();
+
+private slots:
+    void readAvailable();
+    void readChannelFinished();
+    void replayNext();
+
+private:
+    bool processLines();
+    bool processLine(std::string_view line);
+    bool deliver(const NmeaParser::Fix &fix);
+    void emitFix(const NmeaParser::Fix &fix);
+    void finish();
+
+    // Many sentences per read; a line that does not fit is dropped
+    enum { eBUFFER_SIZE = 4096 };
+
+    QPointer<QIODevice> m_device;
+    char m_buffer[eBUFFER_SIZE];
+    int m_begin {};
+    int m_end {};
+    bool m_isDiscarding {};     // rest of an overlong line
+    bool m_isActive {};
+    bool m_isDeviceFinished {};
+
+    double m_lastLatitude {};
+    double m_lastLongitude {};
+    bool m_hasLast {};
+
+    Statistics m_statistics;
+
+    // Replay: sentence time and wall clock at the first fix, the fix
+    // waiting for its time and the days passed in the recording
+    double m_replaySpeed {};
+    QTimer m_replayTimer;
+    QElapsedTimer m_replayClock;
+    qint64 m_replayOriginMs {-1};
+    qint64 m_lastTimeMs {-1};
+    qint64 m_dayOffsetMs {};
+    NmeaParser::Fix m_pending;
+    bool m_hasPending {};
+};
+
+#endif // NMEAPOSITIONSOURCE_H
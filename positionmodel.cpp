@@ -0,0 +1,81 @@
+#include "positionmodel.h"
+#include "latlonwidget_p.h"
+#include "positionslot.h"
+
+using namespace LatLonDisplay;
+
+///
+/// \brief PositionModel::PositionModel
+/// The position starts at 0, 0 like a new LatLonWidget.
+///
+/// \param parent
+///
+PositionModel::PositionModel(QObject *parent) :
+    QObject(parent)
+{
+}
+
+PositionModel::~PositionModel() = default;
+
+void PositionModel::getPosition(double &latitude, double &longitude) const
+{
+    latitude = m_latitude.getValue();
+    longitude = m_longitude.getValue();
+}
+
+QString PositionModel::text(LatLonWidget::PositionFormatType posFormat, LatLonWidget::ValueType type,
+                            LatLonWidget::NotationType notation, LatLonWidget::UTMEngineType engine) const
+{
+    const int slot = (posFormat == LatLonWidget::eUTM)
+            ? 4 + int(engine)
+            : 2 * int(posFormat) + int(notation);
+    Text &cached = m_texts[slot];
+
+    if( !cached.isValid ) {
+        if( posFormat == LatLonWidget::eUTM ) {
+            formatUTMText(m_latitude.getValue(), m_longitude.getValue(), engine,
+                          cached.text[LatLonWidget::eLATITUDE], cached.text[LatLonWidget::eLONGITUDE]);
+        } else {
+            cached.text[LatLonWidget::eLATITUDE] =
+                    formatText(posFormat, LatLonWidget::eLATITUDE, notation, m_latitude);
+            cached.text[LatLonWidget::eLONGITUDE] =
+                    formatText(posFormat, LatLonWidget::eLONGITUDE, notation, m_longitude);
+        }
+        cached.isValid = true;
+    }
+    return cached.text[type];
+}
+
+void PositionModel::setPosition(const double &latitude, const double &longitude)
+{
+    const FloatType newLatitude(latitude);
+    const FloatType newLongitude(longitude);
+    if( newLatitude.getValue() == m_latitude.getValue() &&
+        newLongitude.getValue() == m_longitude.getValue() )
+        return;
+
+    m_latitude = newLatitude;
+    m_longitude = newLongitude;
+    for( Text &cached : m_texts )
+        cached.isValid = false;
+
+    emit positionChanged(m_latitude.getValue(), m_longitude.getValue());
+}
+
+PositionSlot *PositionModel::positionSlot()
+{
+    if( !m_slot ) {
+        m_slot.reset(new PositionSlot);
+        m_slot->setNotifier([this] {
+            QMetaObject::invokeMethod(this, "positionSlotReady", Qt::QueuedConnection);
+        });
+    }
+    return m_slot.get();
+}
+
+void PositionModel::positionSlotReady()
+{
+    double latitude, longitude;
+    if( m_slot->take(latitude, longitude) )
+        setPosition(latitude, longitude);
+}
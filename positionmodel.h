@@ -0,0 +1,100 @@
+#ifndef POSITIONMODEL_H
+#define POSITIONMODEL_H
+
+#include <QObject>
+#include <QString>
+
+#include "floattype.h"
+#include "latlonwidget.h"
+
+#include <memory>
+
+class PositionSlot;
+
+///
+/// \brief One position shared by many LatLonWidgets.
+///
+/// Instead of calling setPosition() on every widget, bind them to a model
+/// with LatLonWidget::setPositionModel() and set the position once:
+/// \code
+/// PositionModel *ownship = new PositionModel(this);
+/// for( LatLonWidget *w : widgets )
+///     w->setPositionModel(ownship);
+/// ownship->setPosition(lat, lon);
+/// \endcode
+///
+/// The position is rounded to FloatType once, and its text formatted once
+/// per distinct format, notation and UTM engine in use, the first time a
+/// widget asks for it. The other widgets showing the same format get the
+/// cached (implicitly shared) strings, so the formatting cost of an update
+/// does not grow with the number of widgets.
+///
+/// Positions produced on other threads go through positionSlot(): every
+/// bound widget then updates from one lock-free read on the model's thread.
+///
+/// Binding is one-way: edits typed into a bound widget stay in that widget
+/// until the model changes again.
+///
+class PositionModel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PositionModel(QObject *parent = nullptr);
+    ~PositionModel() override;
+
+    const FloatType &latitude() const { return m_latitude; }
+    const FloatType &longitude() const { return m_longitude; }
+    void getPosition(double &latitude, double &longitude) const;
+
+    ///
+    /// \brief The text of one axis of the position, as LatLonWidget shows it.
+    ///
+    /// For eUTM, eLATITUDE is the zone and northing and eLONGITUDE the
+    /// easting; the notation is ignored. Formatted on the first call after
+    /// a change, cached after that.
+    ///
+    QString text(LatLonWidget::PositionFormatType posFormat, LatLonWidget::ValueType type,
+                 LatLonWidget::NotationType notation = LatLonWidget::NotationType::eSIGN,
+                 LatLonWidget::UTMEngineType engine = LatLonWidget::UTMEngineType::eFAST) const;
+
+public slots:
+    ///
+    /// \brief Set the position; emits positionChanged() if it differs in
+    /// the micro-degrees shown.
+    ///
+    void setPosition(const double &latitude, const double &longitude);
+
+public:
+    ///
+    /// \brief Lock-free input for positions from other threads.
+    ///
+    /// The latest position published into the slot is set on the model's
+    /// thread. Created on the first call, which must be on that thread;
+    /// stop the producers before deleting the model.
+    ///
+    PositionSlot *positionSlot();
+
+signals:
+    void positionChanged(double latitude, double longitude);
+
+private slots:
+    void positionSlotReady();
+
+private:
+    // DD and DMS in either notation, UTM with either engine
+    enum { eTEXT_COUNT = 6 };
+
+    struct Text
+    {
+        bool isValid {};
+        QString text[2];
+    };
+
+    FloatType m_latitude {0, 0};
+    FloatType m_longitude {0, 0};
+    mutable Text m_texts[eTEXT_COUNT];
+
+    std::unique_ptr<PositionSlot> m_slot;
+};
+
+#endif // POSITIONMODEL_H